@@ -0,0 +1,258 @@
+/*
+ * CFG: functions to build and walk a control-flow graph
+ *
+ * This file provides the definitions of a set of functions for
+ * splitting a decoded program into basic blocks, connecting them, and
+ * finding the ones that can run.  See CFG.h.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include "assembler.h"
+
+/* The blocks marked so far, for markLabel. */
+typedef struct
+{
+    CFG *cfg;
+    Program *prog;
+    LabelTable *table;
+    int *stack; /* blocks marked but not yet followed */
+    int top;
+    int depth;  /* nbr of constants being followed */
+} Marking;
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+
+/* internal functions (visible to this file only)*/
+static void addSuccessor(BasicBlock *block, int succ);
+static int blockOfLabel(CFG *cfg, Program *prog, LabelTable *table, char *label);
+static void markBlock(Marking *marking, int b);
+static void markLabel(void *arg, const char *name);
+
+int buildCFG(CFG *cfg, Program *prog, LabelTable *table)
+/* Postcondition: cfg holds the basic blocks of prog (whose addresses
+   *      must match table) and the edges between them.  No block is
+   *      marked reachable yet.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    int pending = -1; /* branch or jump whose delay slot comes next */
+    int closed = 1;   /* the last block has ended */
+    int hasInstr = 0; /* the last block has an instruction in it */
+    int b, i, k;
+
+    cfg->nbrBlocks = 0;
+    cfg->blocks = memAlloc(MEM_OPTIMIZER, (prog->nbrInstrs + 1) * sizeof(BasicBlock));
+    cfg->blockOf = memAlloc(MEM_OPTIMIZER, (prog->nbrInstrs + 1) * sizeof(int));
+    if (cfg->blocks == NULL || cfg->blockOf == NULL)
+    {
+        cfgFree(cfg);
+        printError("%s", ERROR0);
+        return 0; /* fatal error: couldn't allocate memory */
+    }
+
+    /* Split the program into blocks.  Labels that follow each other
+     * (before any instruction) start only one block.
+     */
+    for (i = 0; i < prog->nbrInstrs; i++)
+    {
+        Instruction *instr = &prog->instrs[i];
+        BasicBlock *block;
+
+        if (closed || ((instr->label != NULL || instr->align > 0) && hasInstr))
+        {
+            block = &cfg->blocks[cfg->nbrBlocks++];
+            block->first = i;
+            block->branch = -1;
+            block->nbrSuccs = 0;
+            block->reachable = 0;
+            closed = hasInstr = 0;
+        }
+        block = &cfg->blocks[cfg->nbrBlocks - 1];
+        block->last = i;
+        cfg->blockOf[i] = cfg->nbrBlocks - 1;
+
+        if (instr->name == NULL)
+            continue;
+        hasInstr = 1;
+
+        /* A block ends after the delay slot of its branch or jump (a
+         * labeled slot is a block of its own, which the branch's block
+         * runs on into).  In reorder mode the slot is filled later.
+         */
+        if (pending != -1)
+        {
+            block->branch = pending;
+            pending = -1;
+            closed = 1;
+        }
+        else if (isControlTransfer(instr))
+        {
+            if (instr->reorder)
+            {
+                block->branch = i;
+                closed = 1;
+            }
+            else
+                pending = i;
+        }
+    }
+    if (pending != -1)
+        cfg->blocks[cfg->nbrBlocks - 1].branch = pending; /* no delay slot */
+
+    /* Connect each block to the blocks that can run after it. */
+    for (b = 0; b < cfg->nbrBlocks; b++)
+    {
+        BasicBlock *block = &cfg->blocks[b];
+        int runsOn = 1; /* control can go on to the next block */
+
+        if (block->branch != -1)
+        {
+            Instruction *br = &prog->instrs[block->branch];
+
+            if (*br->f.opType == 'J')
+                runsOn = br->f.code == 3; /* a jal returns after it */
+            else if (*br->f.opType == 'R')
+                runsOn = 0; /* jr */
+            else
+                runsOn = br->f.code != 4 || br->rs != br->rt;
+
+            if (br->target != NULL && (k = blockOfLabel(cfg, prog, table, br->target)) != -1)
+                addSuccessor(block, k);
+        }
+        if (runsOn && b + 1 < cfg->nbrBlocks)
+            addSuccessor(block, b + 1);
+    }
+
+    return 1;
+}
+
+int markReachable(CFG *cfg, Program *prog, LabelTable *table)
+/* Postcondition: every block that can run has been marked reachable:
+   *      the ones that can be reached from the entry (the label main
+   *      if it is defined, and the first statement otherwise), and
+   *      from every label whose address is taken, since a jr may go
+   *      there.
+   * Returns the nbr of blocks that can't run; -1 if memory allocation
+   *      error.
+   */
+{
+    Marking marking;
+    int unreachable = 0;
+    int b, i, k;
+
+    if (cfg->nbrBlocks == 0)
+        return 0;
+    if ((marking.stack = memAlloc(MEM_OPTIMIZER, cfg->nbrBlocks * sizeof(int))) == NULL)
+    {
+        printError("%s", ERROR0);
+        return -1; /* fatal error: couldn't allocate memory */
+    }
+    marking.cfg = cfg;
+    marking.prog = prog;
+    marking.table = table;
+    marking.top = 0;
+    marking.depth = 0;
+
+    /* Mark the entry and the blocks whose address is taken (by name,
+     * or in an expression).  Each block goes on the stack when it is
+     * marked, so only once.
+     */
+    if ((b = blockOfLabel(cfg, prog, table, ENTRY_LABEL)) == -1)
+        b = 0;
+    markBlock(&marking, b);
+    for (i = 0; i < prog->nbrInstrs; i++)
+    {
+        Instruction *instr = &prog->instrs[i];
+
+        if (instr->target != NULL && !isControlTransfer(instr))
+            markLabel(&marking, instr->target);
+        if (instr->expr != NULL)
+            scanSymbols(instr->expr, markLabel, &marking);
+    }
+    for (i = 0; i < prog->data.nbrFixups; i++)
+        scanSymbols(prog->data.fixups[i].expr, markLabel, &marking);
+
+    /* Follow the edges from every marked block. */
+    while (marking.top > 0)
+    {
+        BasicBlock *block = &cfg->blocks[marking.stack[--marking.top]];
+
+        for (k = 0; k < block->nbrSuccs; k++)
+            markBlock(&marking, block->succs[k]);
+    }
+    memFree(marking.stack);
+
+    for (b = 0; b < cfg->nbrBlocks; b++)
+        unreachable += !cfg->blocks[b].reachable;
+    return unreachable;
+}
+
+void cfgFree(CFG *cfg)
+/* Postcondition: all the memory used by cfg has been freed, and
+   *      cfg is empty.
+   */
+{
+    memFree(cfg->blocks);
+    memFree(cfg->blockOf);
+    cfg->blocks = NULL;
+    cfg->blockOf = NULL;
+    cfg->nbrBlocks = 0;
+}
+
+static void addSuccessor(BasicBlock *block, int succ)
+/* Postcondition: succ is one of the successors of block (once). */
+{
+    if (block->nbrSuccs == 0 || block->succs[0] != succ)
+        block->succs[block->nbrSuccs++] = succ;
+}
+
+static int blockOfLabel(CFG *cfg, Program *prog, LabelTable *table, char *label)
+/* Returns the index of the block of the instruction marked by label;
+   * -1 if the label is not in the table or does not mark an
+   * instruction.
+   */
+{
+    int index = findInstruction(prog, table, label);
+
+    return index == -1 ? -1 : cfg->blockOf[index];
+}
+
+static void markBlock(Marking *marking, int b)
+/* Postcondition: block b is marked reachable, and is on the stack to
+   *      be followed if it wasn't marked before.
+   */
+{
+    if (!marking->cfg->blocks[b].reachable)
+    {
+        marking->cfg->blocks[b].reachable = 1;
+        marking->stack[marking->top++] = b;
+    }
+}
+
+static void markLabel(void *arg, const char *name)
+/* Marks the block of the instruction marked by the label name, or
+   * the blocks of the labels in the expression of the constant name,
+   * given the Marking arg (for scanSymbols).
+   */
+{
+    Marking *marking = arg;
+    Equate *equate = findEquate(marking->prog, name);
+    int k;
+
+    if (equate != NULL)
+    {
+        if (marking->depth < MAX_EQUATE_DEPTH)
+        {
+            marking->depth++;
+            scanSymbols(equate->expr, markLabel, marking);
+            marking->depth--;
+        }
+    }
+    else if ((k = blockOfLabel(marking->cfg, marking->prog, marking->table, (char *)name)) != -1)
+        markBlock(marking, k);
+}
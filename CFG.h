@@ -0,0 +1,83 @@
+/*
+ * CFG: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for a group
+ * of associated functions that split a decoded program into basic
+ * blocks and connect them into a control-flow graph, for the passes
+ * that need to know which instructions can run after which.
+ *
+ * A basic block is a run of statements that is only entered at its
+ * first statement and only left after its last.  A block starts at
+ * the first statement, at every label (or .align), and after every
+ * branch or jump (beq, bne, j, jal, jr).  Outside of .set reorder mode
+ * the instruction after a branch or jump (its delay slot) runs before
+ * control goes elsewhere, so it ends the block instead of the branch.
+ *
+ * The edges of a block go to the block after it, unless it ends in a
+ * j, a jr, or a beq that compares a register with itself, and to the
+ * block that its branch or jump goes to.  A jal also goes on to the
+ * block after it, where the function returns to, so a jr has no edges.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef CFG_H
+#define CFG_H
+
+/* The label execution starts at, if the program defines it (otherwise
+ * it starts at the first instruction).
+ */
+#define ENTRY_LABEL "main"
+
+/* THE DATA STRUCTURES */
+
+typedef struct
+{
+	int first;	/* index of the first statement in the block */
+	int last;	/* index of the last statement in the block */
+	int branch;	/* index of the branch or jump that ends the
+			   block (before its delay slot), or -1 if the
+			   block runs on into the next one */
+	int nbrSuccs;	/* nbr of blocks control can go to next */
+	int succs[2];	/* their indices */
+	int reachable;	/* 1 if it can run, starting at the entry */
+} BasicBlock;
+
+typedef struct
+{
+	int nbrBlocks;		/* nbr of blocks */
+	BasicBlock *blocks;	/* the blocks, in program order */
+	int *blockOf;		/* index of the block of each statement */
+} CFG;
+
+/* THE FUNCTIONS */
+
+int buildCFG(CFG *cfg, Program *prog, LabelTable *table);
+/* Postcondition: cfg holds the basic blocks of prog (whose addresses
+         *      must match table) and the edges between them.  No block
+         *      is marked reachable yet.
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+int markReachable(CFG *cfg, Program *prog, LabelTable *table);
+/* Postcondition: every block that can run has been marked reachable:
+         *      the ones that can be reached from the entry (the label
+         *      main if it is defined, and the first statement
+         *      otherwise), and from every label whose address is
+         *      taken (as the operand of an instruction that is not a
+         *      branch or jump, such as lui and ori, by a .word in the
+         *      data segment, or in an expression), since a jr may go
+         *      there.
+         * Returns the nbr of blocks that can't run; -1 if memory
+         *      allocation error.
+         */
+
+void cfgFree(CFG *cfg);
+/* Postcondition: all the memory used by cfg has been freed, and
+         *      cfg is empty.
+         */
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * Instruction Cache: functions to remember decoded statements
+ *
+ * This file provides the definitions of a set of functions for
+ * keeping the decoded instructions of the statements read so far, so
+ * that pass1 can reuse them for a statement that comes again.  See
+ * InstrCache.h.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include "assembler.h"
+#include "InstrCache.h"
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+
+/* internal functions (visible to this file only)*/
+static int growCache(InstrCache *cache);
+static uint32_t hashKey(const char *key);
+static int isTokenChar(int c);
+
+int cacheInit(InstrCache *cache)
+/* Postcondition: cache is initialized to indicate that there are no
+   *      statements in it (no memory is allocated yet).
+   * Returns 1.
+   */
+{
+    cache->size = 0;
+    cache->nbrStored = 0;
+    cache->entries = NULL;
+    return 1;
+}
+
+int cacheKey(char *key, char *name, char *rest)
+/* Postcondition: key (which has room for CACHE_KEY_SIZE characters)
+   *      holds the key of the statement whose instruction name is name
+   *      and whose operands are rest.
+   * Returns 1 if the key fits; 0 if the statement is too long to be
+   *      cached.
+   */
+{
+    char *end = key + CACHE_KEY_SIZE - 1; /* room for the null byte */
+    char *next = key;
+    int space = 1; /* whitespace came before *rest */
+
+    for (; *name != '\0'; name++)
+    {
+        if (next == end)
+            return 0;
+        *next++ = *name;
+    }
+
+    /* Keep a space only where it separates two tokens */
+    for (; *rest != '\0'; rest++)
+    {
+        if (isspace((unsigned char)*rest))
+        {
+            space = 1;
+            continue;
+        }
+
+        if (next + (space ? 1 : 0) >= end)
+            return 0;
+        if (space && isTokenChar((unsigned char)next[-1]) && isTokenChar((unsigned char)*rest))
+            *next++ = ' ';
+        *next++ = *rest;
+        space = 0;
+    }
+
+    *next = '\0';
+    return 1;
+}
+
+int cacheLookup(InstrCache *cache, char *key, Instruction *instr)
+/* Postcondition: if the statement key is in cache, instr holds how it
+   *      was decoded (its name is NULL).
+   * Returns 1 if the statement is in the cache; 0 otherwise.
+   */
+{
+    uint32_t hash = hashKey(key);
+    CacheEntry *entry;
+
+    if (cache->size < 0)
+        return 0;
+
+    STATS.cacheLookups++;
+    if (cache->size == 0)
+        return 0;
+    entry = &cache->entries[hash & (cache->size - 1)];
+    if (entry->hash != hash || strcmp(entry->key, key) != SAME)
+        return 0; /* an unused entry's key is "", which matches no statement */
+
+    STATS.cacheHits++;
+    *instr = entry->instr;
+    return 1;
+}
+
+void cacheStore(InstrCache *cache, char *key, Instruction *instr)
+/* Postcondition: the statement key, decoded into instr, is in cache,
+   *      unless instr uses a label or an expression that is not known
+   *      yet.  The cache has grown if it had as many statements stored
+   *      as entries (if there is memory for it; otherwise it stays
+   *      empty from then on).
+   */
+{
+    uint32_t hash = hashKey(key);
+    CacheEntry *entry;
+
+    if (cache->size < 0 || instr->target != NULL || instr->expr != NULL)
+        return;
+    if (cache->nbrStored >= cache->size && cache->size < CACHE_SIZE && !growCache(cache))
+        return; /* error message already printed */
+
+    /* replace whatever statement was in its entry */
+    cache->nbrStored++;
+    entry = &cache->entries[hash & (cache->size - 1)];
+    entry->hash = hash;
+    strcpy(entry->key, key);
+    entry->instr = *instr;
+    entry->instr.name = NULL;
+    entry->instr.label = NULL;
+}
+
+void cacheFree(InstrCache *cache)
+/* Postcondition: all the memory used by cache has been freed. */
+{
+    memFree(cache->entries);
+    cache->size = 0;
+    cache->nbrStored = 0;
+    cache->entries = NULL;
+}
+
+static int growCache(InstrCache *cache)
+/* Postcondition: cache has twice as many entries (CACHE_MIN_SIZE if it
+   *      had none), with the statements in it moved to their entries
+   *      in the new size.
+   * Returns 1 if everything went OK; 0 if memory allocation error (the
+   *      cache is then emptied for good).
+   */
+{
+    int newSize = cache->size == 0 ? CACHE_MIN_SIZE : cache->size * 2;
+    CacheEntry *newEntries;
+    int i;
+
+    /* every key starts out as "" */
+    if ((newEntries = memCalloc(MEM_CACHE, newSize, sizeof(CacheEntry))) == NULL)
+    {
+        printError("%s", ERROR0);
+        cacheFree(cache);
+        cache->size = -1;
+        return 0; /* fatal error: couldn't allocate memory */
+    }
+
+    for (i = 0; i < cache->size; i++)
+        if (cache->entries[i].key[0] != '\0')
+            newEntries[cache->entries[i].hash & (newSize - 1)] = cache->entries[i];
+
+    memFree(cache->entries);
+    cache->entries = newEntries;
+    cache->size = newSize;
+    return 1;
+}
+
+static uint32_t hashKey(const char *key)
+/* Returns the 32-bit FNV-1a hash of key. */
+{
+    uint32_t hash = 2166136261u;
+
+    for (; *key != '\0'; key++)
+        hash = (hash ^ (unsigned char)*key) * 16777619u;
+
+    return hash;
+}
+
+static int isTokenChar(int c)
+/* Returns 1 if c can be part of a register, number, or name (so that
+   * whitespace between two of them separates tokens); 0 otherwise.
+   */
+{
+    return isalnum(c) || c == '$' || c == '_' || c == '.';
+}
@@ -0,0 +1,94 @@
+/*
+ * Instruction Cache: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for a group
+ * of associated functions that remember how each statement was decoded,
+ * so that a statement that comes again (generated code repeats lines
+ * such as "add $t0, $t0, $t1" or "lw $t5, 12($fp)" thousands of times)
+ * is not tokenized and decoded again.
+ *
+ * The cache is keyed by the text of the statement, with the whitespace
+ * that doesn't separate two tokens left out (so "lw $t5,12($fp)" and
+ * "lw $t5, 12( $fp )" are the same statement).  Only statements that
+ * decode into one instruction whose operands are all known in pass1
+ * are kept: not branches and jumps, which use labels, nor instructions
+ * with a label or an expression that uses one.  Their decoded operands
+ * (and so their machine code, which pass2 makes from the operands after
+ * the optimizer has had its say) don't depend on where they are.
+ *
+ * Each statement can only go in one entry of the cache (picked by a
+ * hash of its key), replacing the one there.  The cache starts out
+ * with no entries, and grows with the nbr of statements stored in it,
+ * to a power of 2 up to CACHE_SIZE entries, so that a short program
+ * doesn't pay for a cache sized for a long one.  Its lookups and hits
+ * are counted in STATS (--stats).
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef INSTR_CACHE_H
+#define INSTR_CACHE_H
+
+/* The most and the fewest entries in the cache (powers of 2), and the
+ * room for a key (longer statements are not cached).
+ */
+#define CACHE_SIZE 1024
+#define CACHE_MIN_SIZE 16
+#define CACHE_KEY_SIZE 64
+
+/* THE DATA STRUCTURES */
+
+typedef struct
+{
+	uint32_t hash;			/* hash of key */
+	char key[CACHE_KEY_SIZE];	/* the statement, or "" if unused */
+	Instruction instr;		/* how it was decoded (without its
+					   name, line, or address) */
+} CacheEntry;
+
+typedef struct
+{
+	int size;		/* nbr of entries (0 until the first
+				   statement is stored; -1 if they
+				   couldn't be allocated) */
+	int nbrStored;		/* nbr of statements stored so far */
+	CacheEntry *entries;
+} InstrCache;
+
+/* THE FUNCTIONS */
+
+int cacheInit(InstrCache *cache);
+/* Postcondition: cache is initialized to indicate that there are no
+         *      statements in it (no memory is allocated yet).
+         * Returns 1.
+         */
+
+int cacheKey(char *key, char *name, char *rest);
+/* Postcondition: key (which has room for CACHE_KEY_SIZE characters)
+         *      holds the key of the statement whose instruction name is
+         *      name and whose operands are rest.
+         * Returns 1 if the key fits; 0 if the statement is too long to
+         *      be cached.
+         */
+
+int cacheLookup(InstrCache *cache, char *key, Instruction *instr);
+/* Postcondition: if the statement key is in cache, instr holds how it
+         *      was decoded (its name is NULL).
+         * Returns 1 if the statement is in the cache; 0 otherwise.
+         */
+
+void cacheStore(InstrCache *cache, char *key, Instruction *instr);
+/* Postcondition: the statement key, decoded into instr, is in cache,
+         *      unless instr uses a label or an expression that is not
+         *      known yet.  The cache has grown if it had as many
+         *      statements stored as entries (if there is memory for
+         *      it; otherwise it stays empty from then on).
+         */
+
+void cacheFree(InstrCache *cache);
+/* Postcondition: all the memory used by cache has been freed. */
+
+#endif
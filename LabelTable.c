@@ -12,6 +12,8 @@
  *   Modified:  4/19/2013    Modernized call to fprintf for errors.
  *   Modified:  5/25/2015    Updated to use printError function.
  *   Modified:  4/23/2019    Updated to add code for tableInit, printLabels, findLabel, and addLabel functions.
+ *   Modified:  10/19/2026   Added tableFree so that a table can be rebuilt.
+ *   Modified:  10/19/2026   Added tableSortedCopy and findSortedLabel for lookups in bulk.
  *
  */
 
@@ -24,6 +26,7 @@ static const char *ERROR2 = "Error: cannot allocate space in memory.\n";
 
 /* internal function (visible to this file only)*/
 static int verifyTableExists(LabelTable *table);
+static int compareNames(const void *a, const void *b);
 
 void tableInit(LabelTable *table)
 /* Postcondition: table is initialized to indicate that there
@@ -75,10 +78,67 @@ int findLabel(LabelTable *table, char *label)
         return 0; /* fatal error: table doesn't exist */
 
     int i;
+    STATS.findLabelCalls++;
     for (i = 0; i < table->nbrLabels; i++)
     {
         if (strcmp(table->entries[i].label, label) == SAME) /* check if the label exists in the table */
-            return table->entries[i].address;               /* return the address of label */
+        {
+            STATS.findLabelProbes += i + 1;
+            return table->entries[i].address; /* return the address of label */
+        }
+    }
+
+    STATS.findLabelProbes += table->nbrLabels;
+    return -1; /* return -1 if label not found */
+}
+
+int tableSortedCopy(LabelTable *sorted, LabelTable *table)
+/* Postcondition: sorted holds a copy of the entries of table, sorted
+   *      by name, which share its label names (so it is freed with
+   *      memFree(sorted->entries), not tableFree).
+   * Returns 1 if everything went OK; 0 if memory allocation error
+   *      or table doesn't exist.
+   */
+{
+    /* verify that table exists */
+    if (!verifyTableExists(table))
+        return 0; /* fatal error: table doesn't exist */
+
+    if ((sorted->entries = memAlloc(MEM_LABELS, (table->nbrLabels + 1) * sizeof(LabelEntry))) == NULL)
+    {
+        printError("%s", ERROR2);
+        return 0; /* fatal error: couldn't allocate memory */
+    }
+    memcpy(sorted->entries, table->entries, table->nbrLabels * sizeof(LabelEntry));
+    qsort(sorted->entries, table->nbrLabels, sizeof(LabelEntry), compareNames);
+    sorted->capacity = table->nbrLabels + 1;
+    sorted->nbrLabels = table->nbrLabels;
+    return 1;
+}
+
+int findSortedLabel(LabelTable *sorted, char *label)
+/* Returns the address associated with the label in a table made by
+   *      tableSortedCopy, which is searched by halves; -1 if label is
+   *      not in the table or table doesn't exist
+   */
+{
+    if (!verifyTableExists(sorted))
+        return 0; /* fatal error: table doesn't exist */
+
+    int low = 0, high = sorted->nbrLabels - 1;
+    STATS.findLabelCalls++;
+    while (low <= high)
+    {
+        int middle = low + (high - low) / 2;
+        int order = strcmp(label, sorted->entries[middle].label);
+
+        STATS.findLabelProbes++;
+        if (order == SAME)
+            return sorted->entries[middle].address;
+        if (order < 0)
+            high = middle - 1;
+        else
+            low = middle + 1;
     }
 
     return -1; /* return -1 if label not found */
@@ -111,7 +171,7 @@ int addLabel(LabelTable *table, char *label, int PC)
     char *labelDuplicate;
 
     /* Create a dynamically allocated version of label that will persist. */
-    if ((labelDuplicate = strdup(label)) == NULL)
+    if ((labelDuplicate = memStrdup(MEM_LABELS, label)) == NULL)
     {
         printError("%s", ERROR2);
         return 0; /* fatal error: couldn't allocate memory */
@@ -154,7 +214,7 @@ int tableResize(LabelTable *table, int newSize)
         return 0; /* fatal error: table doesn't exist */
 
     /* create a new internal table of the specified size */
-    if ((newEntryList = malloc(newSize * sizeof(LabelEntry))) == NULL)
+    if ((newEntryList = memAlloc(MEM_LABELS, newSize * sizeof(LabelEntry))) == NULL)
     {
         printError("%s", ERROR2);
         return 0; /* fatal error: couldn't allocate memory */
@@ -168,7 +228,7 @@ int tableResize(LabelTable *table, int newSize)
                      smaller * sizeof(LabelEntry));
 
         /* free the space taken up by the old internal table */
-        free(table->entries);
+        memFree(table->entries);
         table->nbrLabels = smaller;
     }
 
@@ -177,6 +237,25 @@ int tableResize(LabelTable *table, int newSize)
     return 1;
 }
 
+void tableFree(LabelTable *table)
+/* Postcondition: all the memory used by the table, including the
+   *      label names, has been freed, and the table is empty.
+   */
+{
+    /* verify that table exists */
+    if (!verifyTableExists(table))
+        return; /* fatal error: table doesn't exist */
+
+    int i;
+    for (i = 0; i < table->nbrLabels; i++)
+        memFree(table->entries[i].label);
+
+    memFree(table->entries);
+    table->capacity = 0;
+    table->nbrLabels = 0;
+    table->entries = NULL;
+}
+
 static int verifyTableExists(LabelTable *table)
 /* Returns true (1) if table exists (pointer is non-null); prints an error
   * and returns false (0) otherwise.
@@ -191,3 +270,9 @@ static int verifyTableExists(LabelTable *table)
 
     return 1;
 }
+
+static int compareNames(const void *a, const void *b)
+/* Compares two label entries by name, for qsort. */
+{
+    return strcmp(((const LabelEntry *)a)->label, ((const LabelEntry *)b)->label);
+}
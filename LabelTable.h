@@ -65,6 +65,25 @@ int findLabel(LabelTable *table, char *label);
          *       not in the table or if table doesn't exist.
          */
 
+int tableSortedCopy(LabelTable *sorted, LabelTable *table);
+/* Postcondition: sorted holds a copy of the entries of table, sorted
+         *      by name, which share its label names (so it is freed with
+         *      memFree(sorted->entries), not tableFree).
+         * Returns 1 if everything went OK; 0 if memory allocation error
+         *      or table doesn't exist.
+         */
+
+int findSortedLabel(LabelTable *sorted, char *label);
+/* Returns the address associated with the label in a table made by
+         *       tableSortedCopy, which is searched by halves; -1 if label
+         *       is not in the table or if table doesn't exist.
+         */
+
+void tableFree(LabelTable *table);
+/* Postcondition: all the memory used by the table, including the
+         *      label names, has been freed, and the table is empty.
+         */
+
 void printLabels(LabelTable *table);
 /* Postcondition: all the labels in the table, with their
          *      associated addresses, have been printed to the standard
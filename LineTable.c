@@ -0,0 +1,269 @@
+/*
+ * Line Table: functions to build, write, and search a line table
+ *
+ * This file provides the definitions of a set of functions for
+ * building the table that maps addresses to source lines, writing it
+ * in its compact form, and looking up an address in a table in that
+ * form.  See LineTable.h for the layout.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include "assembler.h"
+#include "LineTable.h"
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+
+/* The most bytes that an unsigned LEB128 number of 32 bits takes. */
+#define MAX_LEB128 5
+
+/* internal functions (visible to this file only)*/
+static int appendRow(LineRows *rows, uint32_t address, uint32_t line);
+static int putLEB128(unsigned char *bytes, uint32_t value);
+static uint32_t getLEB128(const unsigned char **next, const unsigned char *end);
+
+void linesInit(LineRows *rows)
+/* Postcondition: rows is initialized to indicate that there
+   *       are no rows in it.
+   */
+{
+    rows->capacity = rows->nbrRows = 0;
+    rows->addresses = rows->lines = NULL;
+    rows->endAddress = 0;
+}
+
+int addLineRow(LineRows *rows, int address, int lineNum)
+/* Postcondition: the instruction at address, from source line
+   *      lineNum (greater than 0), has been added to the end of rows:
+   *      as part of the last row if it comes right after the
+   *      instruction before and is on the same line, and as a new row
+   *      otherwise (after an end-of-sequence row, if there is a gap
+   *      before it).  Addresses must be added in increasing order.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    int contiguous = rows->nbrRows > 0 && rows->endAddress == (uint32_t)address;
+
+    if (contiguous && rows->lines[rows->nbrRows - 1] == (uint32_t)lineNum)
+    {
+        rows->endAddress += 4;
+        return 1;
+    }
+    if (rows->nbrRows > 0 && !contiguous && !appendRow(rows, rows->endAddress, 0))
+        return 0; /* error message already printed */
+
+    rows->endAddress = (uint32_t)address + 4;
+    return appendRow(rows, (uint32_t)address, (uint32_t)lineNum);
+}
+
+static int appendRow(LineRows *rows, uint32_t address, uint32_t line)
+/* Postcondition: a row for line, starting at address, has been added
+   *      to the end of rows.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    uint32_t *newAddresses, *newLines;
+
+    if (rows->nbrRows >= rows->capacity)
+    {
+        int newSize = rows->capacity == 0 ? 256 : rows->capacity * 2;
+        if ((newAddresses = memRealloc(MEM_OUTPUT, rows->addresses, newSize * sizeof(uint32_t))) == NULL)
+        {
+            printError("%s", ERROR0);
+            return 0; /* fatal error: couldn't allocate memory */
+        }
+        rows->addresses = newAddresses;
+        if ((newLines = memRealloc(MEM_OUTPUT, rows->lines, newSize * sizeof(uint32_t))) == NULL)
+        {
+            printError("%s", ERROR0);
+            return 0; /* fatal error: couldn't allocate memory */
+        }
+        rows->lines = newLines;
+        rows->capacity = newSize;
+    }
+
+    rows->addresses[rows->nbrRows] = address;
+    rows->lines[rows->nbrRows++] = line;
+    return 1;
+}
+
+int lineTableWrite(LineRows *rows, FILE *fp)
+/* Postcondition: the line table of rows, with an end-of-sequence row
+   *      after the last instruction, has been written to fp.
+   * Returns the nbr of bytes written; 0 if it can't be written.
+   */
+{
+    LineTableHeader header;
+    LineCheckpoint *checkpoints;
+    unsigned char *deltas;
+    size_t length = 0;
+    int nbrRows = rows->nbrRows;
+    int i, written;
+
+    /* the end-of-sequence row after the last instruction */
+    if (nbrRows > 0 && !appendRow(rows, rows->endAddress, 0))
+        return 0; /* error message already printed */
+
+    memcpy(header.magic, LINE_TABLE_MAGIC, 4);
+    header.nbrRows = rows->nbrRows;
+    header.nbrCheckpoints = (rows->nbrRows + LINE_TABLE_INTERVAL - 1) / LINE_TABLE_INTERVAL;
+    header.interval = LINE_TABLE_INTERVAL;
+
+    checkpoints = memAlloc(MEM_OUTPUT, (header.nbrCheckpoints + 1) * sizeof(LineCheckpoint));
+    deltas = memAlloc(MEM_OUTPUT, (size_t)rows->nbrRows * 2 * MAX_LEB128 + 1);
+    if (checkpoints == NULL || deltas == NULL)
+    {
+        memFree(checkpoints);
+        memFree(deltas);
+        rows->nbrRows = nbrRows;
+        printError("%s", ERROR0);
+        return 0;
+    }
+
+    for (i = 0; i < rows->nbrRows; i++)
+    {
+        if (i % LINE_TABLE_INTERVAL == 0)
+        {
+            /* a row in full; the deltas of the next row follow */
+            checkpoints[i / LINE_TABLE_INTERVAL].address = rows->addresses[i];
+            checkpoints[i / LINE_TABLE_INTERVAL].line = rows->lines[i];
+            checkpoints[i / LINE_TABLE_INTERVAL].offset = (uint32_t)length;
+        }
+        if (i + 1 < rows->nbrRows)
+        {
+            int32_t lineDelta = (int32_t)(rows->lines[i + 1] - rows->lines[i]);
+
+            length += putLEB128(deltas + length, (rows->addresses[i + 1] - rows->addresses[i]) / 4);
+            length += putLEB128(deltas + length,
+                                ((uint32_t)lineDelta << 1) ^ (uint32_t)(lineDelta >> 31));
+        }
+    }
+    header.deltaBytes = (uint32_t)length;
+    rows->nbrRows = nbrRows; /* more instructions may still be added */
+
+    written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(checkpoints, sizeof(LineCheckpoint), header.nbrCheckpoints, fp) ==
+                  header.nbrCheckpoints &&
+              fwrite(deltas, 1, length, fp) == length;
+    memFree(checkpoints);
+    memFree(deltas);
+
+    return written ? (int)(sizeof(header) + header.nbrCheckpoints * sizeof(LineCheckpoint) + length) : 0;
+}
+
+int lineTableLookup(const void *table, size_t size, uint32_t address)
+/* Takes a line table of size bytes (e.g., a file mapped with mmap)
+   *      and an address.
+   * Returns the source line of the instruction at address; -1 if no
+   *      instruction is there (it is before the first one, in a gap, or
+   *      after the last one), or the table is not valid.
+   */
+{
+    const LineTableHeader *header = table;
+    const LineCheckpoint *checkpoints;
+    const unsigned char *next, *end;
+    uint32_t row, line;
+    int low, high;
+
+    /* check that the parts of the table fit in it */
+    if (size < sizeof(LineTableHeader) || memcmp(header->magic, LINE_TABLE_MAGIC, 4) != SAME ||
+        header->nbrRows == 0 || header->interval == 0 ||
+        header->nbrCheckpoints != (header->nbrRows + header->interval - 1) / header->interval ||
+        (size - sizeof(LineTableHeader)) / sizeof(LineCheckpoint) < header->nbrCheckpoints ||
+        size - sizeof(LineTableHeader) - header->nbrCheckpoints * sizeof(LineCheckpoint) <
+            header->deltaBytes)
+        return -1;
+    checkpoints = (const LineCheckpoint *)(header + 1);
+    next = (const unsigned char *)(checkpoints + header->nbrCheckpoints);
+    end = next + header->deltaBytes;
+
+    if (address < checkpoints[0].address)
+        return -1;
+
+    /* the last checkpoint at or before address */
+    low = 0;
+    high = (int)header->nbrCheckpoints - 1;
+    while (low < high)
+    {
+        int middle = (low + high + 1) / 2;
+
+        if (checkpoints[middle].address <= address)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+
+    /* then the last row at or before address */
+    row = (uint32_t)low * header->interval;
+    line = checkpoints[low].line;
+    next += checkpoints[low].offset;
+    for (address -= checkpoints[low].address; ++row < header->nbrRows && next < end;)
+    {
+        uint32_t words = getLEB128(&next, end);
+        uint32_t zigzag = getLEB128(&next, end);
+
+        if (words * 4 > address)
+            break;
+        address -= words * 4;
+        line += (zigzag >> 1) ^ (0u - (zigzag & 1));
+    }
+
+    /* an end-of-sequence row covers the addresses up to the next row */
+    return line == 0 ? -1 : (int)line;
+}
+
+void linesFree(LineRows *rows)
+/* Postcondition: all the memory used by rows has been freed, and
+   *      rows is empty.
+   */
+{
+    memFree(rows->addresses);
+    memFree(rows->lines);
+    linesInit(rows);
+}
+
+static int putLEB128(unsigned char *bytes, uint32_t value)
+/* Postcondition: value has been stored at bytes as an unsigned LEB128
+   *      number.
+   * Returns the nbr of bytes stored.
+   */
+{
+    int length = 0;
+
+    do
+    {
+        bytes[length] = value & 0x7F;
+        value >>= 7;
+        if (value != 0)
+            bytes[length] |= 0x80;
+        length++;
+    } while (value != 0);
+
+    return length;
+}
+
+static uint32_t getLEB128(const unsigned char **next, const unsigned char *end)
+/* Returns the unsigned LEB128 number at *next (not reading past end),
+   * and moves *next past it.
+   */
+{
+    uint32_t value = 0;
+    int shift = 0;
+
+    while (*next < end)
+    {
+        unsigned char byte = *(*next)++;
+
+        if (shift < 32)
+            value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+        if ((byte & 0x80) == 0)
+            break;
+    }
+
+    return value;
+}
@@ -0,0 +1,122 @@
+/*
+ * Line Table: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for a group
+ * of associated functions that map the addresses of the machine code
+ * back to the source lines they came from, so that a simulator,
+ * profiler, or debugger can tell which line a PC is on.
+ *
+ * The table is written to a file (--emit=lines:path) in a compact
+ * form that can be used where it is, once the file is mapped into
+ * memory with mmap, without being read or decoded first.  The file
+ * holds, in the byte order of the machine that wrote it:
+ *      a LineTableHeader
+ *      nbrCheckpoints LineCheckpoints
+ *      deltaBytes bytes of deltas
+ * Each row of the table is a run of instructions from the same line,
+ * starting at an address; it runs up to the address of the next row.
+ * A row whose line is 0 is an end-of-sequence row, which marks the end
+ * of a run of addresses that have instructions: one follows the last
+ * instruction, and one marks each gap in the addresses (so that an
+ * address in a gap, or after the end, is on no line).  The rows are
+ * in order of address, and each
+ * is stored as the difference from the one before: the nbr of words
+ * between their addresses, then the difference between their lines
+ * (zigzag-encoded, so small negative numbers stay small), each as an
+ * unsigned LEB128 number (7 bits a byte, low bits first, high bit set
+ * on all but the last byte).  Every interval'th row is also stored in
+ * full as a checkpoint, with the offset of the deltas of the row after
+ * it, so a lookup searches the checkpoints and then decodes at most
+ * interval - 1 rows.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef LINE_TABLE_H
+#define LINE_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* The first bytes of a line table file, and the nbr of rows from one
+ * checkpoint to the next.
+ */
+#define LINE_TABLE_MAGIC "MLT2"
+#define LINE_TABLE_INTERVAL 64
+
+/* THE DATA STRUCTURES */
+
+/* The layout of a line table file. */
+
+typedef struct
+{
+	char magic[4];		/* LINE_TABLE_MAGIC */
+	uint32_t nbrRows;	/* nbr of rows (with the end-of-sequence
+				   rows) */
+	uint32_t nbrCheckpoints;	/* nbr of rows stored in full */
+	uint32_t interval;	/* nbr of rows from one checkpoint to the next */
+	uint32_t deltaBytes;	/* nbr of bytes of deltas */
+} LineTableHeader;
+
+typedef struct
+{
+	uint32_t address;	/* address of the row */
+	uint32_t line;		/* its source line (0: end of sequence) */
+	uint32_t offset;	/* offset of the deltas of the next row */
+} LineCheckpoint;
+
+/* The struct LineRows holds the rows of a table as it is built. */
+
+typedef struct
+{
+	int capacity;		/* capacity of addresses and lines */
+	int nbrRows;		/* actual nbr of rows (without the
+				   end-of-sequence row after the last) */
+	uint32_t *addresses;	/* address of each row */
+	uint32_t *lines;	/* source line of each row (0: end of
+				   sequence) */
+	uint32_t endAddress;	/* address after the last instruction added */
+} LineRows;
+
+/* THE FUNCTIONS */
+
+void linesInit(LineRows *rows);
+/* Postcondition: rows is initialized to indicate that there
+         *       are no rows in it.
+         */
+
+int addLineRow(LineRows *rows, int address, int lineNum);
+/* Postcondition: the instruction at address, from source line
+         *      lineNum (greater than 0), has been added to the end of
+         *      rows: as part of the last row if it comes right after
+         *      the instruction before and is on the same line, and as a
+         *      new row otherwise (after an end-of-sequence row, if
+         *      there is a gap before it).  Addresses must be added in
+         *      increasing order.
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+int lineTableWrite(LineRows *rows, FILE *fp);
+/* Postcondition: the line table of rows, with an end-of-sequence
+         *      row after the last instruction, has been written to fp.
+         * Returns the nbr of bytes written; 0 if it can't be written.
+         */
+
+int lineTableLookup(const void *table, size_t size, uint32_t address);
+/* Takes a line table of size bytes (e.g., a file mapped with mmap)
+         *      and an address.
+         * Returns the source line of the instruction at address; -1 if
+         *      no instruction is there (it is before the first one, in a
+         *      gap, or after the last one), or the table is not valid.
+         */
+
+void linesFree(LineRows *rows);
+/* Postcondition: all the memory used by rows has been freed, and
+         *      rows is empty.
+         */
+
+#endif
@@ -0,0 +1,689 @@
+/*
+ * Program: functions to access and manipulate a program
+ *
+ * This file provides the definitions of a set of functions for
+ * creating, maintaining, and laying out the list of decoded
+ * instructions read from an assembly source file, and for building
+ * its data segment.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *   Modified:  10/19/2026   Added the data segment and .align statements.
+ *   Modified:  10/19/2026   Added the machine code (MachineCode).
+ *   Modified:  10/19/2026   Update the label table in place when the
+ *                           program is laid out again.
+ *   Modified:  10/19/2026   Added truncateData.
+ *
+ */
+
+#include "assembler.h"
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+
+/* internal functions (visible to this file only)*/
+static void freeStrings(Instruction *instr);
+static int resizeData(DataSegment *data, int newSize);
+static int updateLabels(Program *prog, LabelTable *table);
+static int compareEntries(const void *a, const void *b);
+static int compareMarks(const void *a, const void *b);
+
+void programInit(Program *prog)
+/* Postcondition: prog is initialized to indicate that there
+   *       are no statements in it.
+   */
+{
+    prog->capacity = 0;
+    prog->nbrInstrs = 0;
+    prog->instrs = NULL;
+
+    prog->data.capacity = 0;
+    prog->data.size = 0;
+    prog->data.bytes = NULL;
+    prog->data.fixupCapacity = 0;
+    prog->data.nbrFixups = 0;
+    prog->data.fixups = NULL;
+    tableInit(&prog->data.labels);
+
+    prog->equateCapacity = 0;
+    prog->nbrEquates = 0;
+    prog->equates = NULL;
+}
+
+int programResize(Program *prog, int newSize)
+/* Postcondition: prog now has the capacity to hold newSize
+   *      statements.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    Instruction *newList;
+
+    /* create a new internal list of the specified size */
+    if ((newList = memRealloc(MEM_PROGRAM, prog->instrs, newSize * sizeof(Instruction))) == NULL)
+    {
+        printError("%s", ERROR0);
+        return 0; /* fatal error: couldn't allocate memory */
+    }
+
+    prog->instrs = newList;
+    prog->capacity = newSize;
+    if (prog->nbrInstrs > newSize)
+        prog->nbrInstrs = newSize;
+    return 1;
+}
+
+int addInstruction(Program *prog, Instruction *instr)
+/* Postcondition: a copy of instr has been added to the end of the
+   *      program, which has been resized if necessary.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    /* Resize the list if necessary to add the new statement */
+    if (prog->nbrInstrs >= prog->capacity)
+    {
+        if (!programResize(prog, prog->capacity == 0 ? 16 : prog->capacity * 2))
+            return 0; /* error message already printed */
+    }
+
+    prog->instrs[prog->nbrInstrs++] = *instr;
+    return 1;
+}
+
+void deleteInstruction(Program *prog, int index)
+/* Postcondition: the instruction at index has been deleted.  Its
+   *      label (if any) is left behind so that it now marks the
+   *      following instruction.
+   */
+{
+    Instruction *instr = &prog->instrs[index];
+
+    /* Keep the label; forget everything else.  layoutProgram removes
+     * statements that have neither a label nor a name.
+     */
+    memFree(instr->name);
+    memFree(instr->target);
+    memFree(instr->expr);
+    instr->name = NULL;
+    instr->target = NULL;
+    instr->expr = NULL;
+}
+
+int layoutProgram(Program *prog, LabelTable *table)
+/* Postcondition: deleted statements have been removed, every
+   *      instruction has been given an address, and the labels in
+   *      table have been given the addresses of the statements they
+   *      mark.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    int PC = 0; /* the program counter */
+    int i, j;
+
+    for (i = 0, j = 0; i < prog->nbrInstrs; i++)
+    {
+        Instruction *instr = &prog->instrs[i];
+
+        /* drop statements that were deleted and carry no label */
+        if (instr->name == NULL && instr->label == NULL && instr->align == 0)
+            continue;
+
+        /* .align pads with nops from its own address up to the next
+         * multiple of 2^n (as in pass 1)
+         */
+        instr->address = PC;
+        if (instr->align > 0)
+        {
+            instr->padding = alignUp(PC, 1 << instr->align) - PC;
+            PC += instr->padding;
+        }
+
+        /* only real instructions take up space */
+        if (instr->name != NULL)
+            PC += 4;
+
+        prog->instrs[j++] = *instr;
+    }
+    prog->nbrInstrs = j;
+
+    return updateLabels(prog, table);
+}
+
+int findInstruction(Program *prog, LabelTable *table, char *label)
+/* Returns the index of the instruction marked by label; -1 if the
+   *      label is not in the table or marks the end of the program.
+   */
+{
+    int address = findLabel(table, label);
+    int low = 0, high = prog->nbrInstrs;
+
+    if (address == -1)
+        return -1;
+
+    /* binary search for the first statement at or after address;
+     * addresses never decrease from one statement to the next
+     */
+    while (low < high)
+    {
+        int mid = (low + high) / 2;
+        if (prog->instrs[mid].address < address)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    /* skip label-only and deleted statements */
+    while (low < prog->nbrInstrs && prog->instrs[low].name == NULL)
+        low++;
+
+    return low < prog->nbrInstrs ? low : -1;
+}
+
+int isControlTransfer(Instruction *instr)
+/* Returns 1 if instr is a branch or jump (beq, bne, j, jal, jr);
+   *      0 otherwise.
+   */
+{
+    if (instr->name == NULL)
+        return 0;
+
+    switch (*instr->f.opType)
+    {
+    case 'R':
+        return instr->f.code == 8;
+    case 'I':
+        return instr->f.code == 4 || instr->f.code == 5;
+    default:
+        return 1; /* j, jal */
+    }
+}
+
+int destRegister(Instruction *instr)
+/* Returns the number of the register written by instr; -1 if instr
+   *      does not write a register.
+   */
+{
+    if (instr->name == NULL)
+        return -1;
+
+    switch (*instr->f.opType)
+    {
+    case 'R':
+        return instr->f.code == 8 ? -1 : instr->rd;
+    case 'I':
+        if (instr->f.code == 4 || instr->f.code == 5 || instr->f.code == 43)
+            return -1; /* beq, bne, sw */
+        return instr->rt;
+    default:
+        return instr->f.code == 3 ? 31 : -1; /* jal writes $ra */
+    }
+}
+
+int sourceRegisters(Instruction *instr, int regs[])
+/* Puts the numbers of the registers read by instr in regs, which must
+   *      have room for 2 entries.
+   * Returns the number of registers read.
+   */
+{
+    if (instr->name == NULL)
+        return 0;
+
+    switch (*instr->f.opType)
+    {
+    case 'R':
+        if (instr->f.code == 8) /* jr */
+        {
+            regs[0] = instr->rs;
+            return 1;
+        }
+        if (instr->f.code == 0 || instr->f.code == 2) /* sll, srl */
+        {
+            regs[0] = instr->rt;
+            return 1;
+        }
+        regs[0] = instr->rs;
+        regs[1] = instr->rt;
+        return 2;
+    case 'I':
+        if (instr->f.code == 15) /* lui */
+            return 0;
+        regs[0] = instr->rs;
+        if (instr->f.code == 4 || instr->f.code == 5 || instr->f.code == 43)
+        {
+            regs[1] = instr->rt; /* beq, bne, sw */
+            return 2;
+        }
+        return 1;
+    default:
+        return 0; /* j, jal */
+    }
+}
+
+int readsRegister(Instruction *instr, int reg)
+/* Returns 1 if instr reads register reg; 0 otherwise. */
+{
+    int regs[2];
+    int n = sourceRegisters(instr, regs);
+    int i;
+
+    for (i = 0; i < n; i++)
+        if (regs[i] == reg)
+            return 1;
+
+    return 0;
+}
+
+int isMemoryAccess(Instruction *instr)
+/* Returns 1 if instr is a load (lw), 2 if it is a store (sw), and
+   *      0 otherwise.
+   */
+{
+    if (instr->name == NULL || *instr->f.opType != 'I')
+        return 0;
+
+    if (instr->f.code == 35)
+        return 1;
+    return instr->f.code == 43 ? 2 : 0;
+}
+
+int dependsOn(Instruction *second, Instruction *first)
+/* Returns 1 if second, which comes after first, must stay after it:
+   *      it reads a register that first writes, writes one that first
+   *      reads or writes, or is a load or store that would pass a
+   *      store (or a store that would pass a load); 0 otherwise, or if
+   *      either one is not an instruction.  The test is symmetric, so
+   *      it also tells whether first can move after second.
+   */
+{
+    int firstDest = destRegister(first);
+    int secondDest = destRegister(second);
+    int firstMem = isMemoryAccess(first);
+    int secondMem = isMemoryAccess(second);
+
+    /* writes to $zero are discarded, so they cannot conflict */
+    if (firstDest > 0 && (firstDest == secondDest || readsRegister(second, firstDest)))
+        return 1;
+    if (secondDest > 0 && readsRegister(first, secondDest))
+        return 1;
+
+    return firstMem && secondMem && (firstMem == 2 || secondMem == 2);
+}
+
+int addData(DataSegment *data, int value, int size)
+/* Postcondition: the low size bytes of value (size is 1, 2, or 4)
+   *      have been added to the end of the data segment, most
+   *      significant byte first.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    int i;
+
+    if (data->size + size > data->capacity &&
+        !resizeData(data, data->capacity == 0 ? 256 : (data->capacity + size) * 2))
+        return 0; /* error message already printed */
+
+    for (i = size - 1; i >= 0; i--)
+        data->bytes[data->size++] = (unsigned char)(value >> (8 * i));
+
+    return 1;
+}
+
+int alignData(DataSegment *data, int alignment)
+/* Postcondition: zero bytes have been added to the data segment
+   *      until its size is a multiple of alignment.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    while (data->size % alignment != 0)
+    {
+        if (!addData(data, 0, 1))
+            return 0; /* error message already printed */
+    }
+
+    return 1;
+}
+
+int addFixup(DataSegment *data, char *expr, int size, int lineNum)
+/* Postcondition: a zero item of size bytes has been added to the end
+   *      of the data segment, to be filled in with the value of the
+   *      expression expr (e.g., the address of a label).
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    DataFixup *newFixups;
+    char *exprDuplicate;
+
+    if (data->nbrFixups >= data->fixupCapacity)
+    {
+        int newSize = data->fixupCapacity == 0 ? 16 : data->fixupCapacity * 2;
+        if ((newFixups = memRealloc(MEM_PROGRAM, data->fixups, newSize * sizeof(DataFixup))) == NULL)
+        {
+            printError("%s", ERROR0);
+            return 0; /* fatal error: couldn't allocate memory */
+        }
+        data->fixups = newFixups;
+        data->fixupCapacity = newSize;
+    }
+
+    if ((exprDuplicate = memStrdup(MEM_PROGRAM, expr)) == NULL)
+    {
+        printError("%s", ERROR0);
+        return 0; /* fatal error: couldn't allocate memory */
+    }
+
+    data->fixups[data->nbrFixups].offset = data->size;
+    data->fixups[data->nbrFixups].size = size;
+    data->fixups[data->nbrFixups].expr = exprDuplicate;
+    data->fixups[data->nbrFixups].lineNum = lineNum;
+    data->nbrFixups++;
+
+    return addData(data, 0, size);
+}
+
+void truncateData(DataSegment *data, int size)
+/* Postcondition: the bytes of the data segment from offset size on,
+   *      and the fixups of the items in them, have been removed.
+   */
+{
+    while (data->nbrFixups > 0 && data->fixups[data->nbrFixups - 1].offset >= size)
+        memFree(data->fixups[--data->nbrFixups].expr);
+    if (data->size > size)
+        data->size = size;
+}
+
+int addEquate(Program *prog, char *name, char *expr, int lineNum)
+/* Postcondition: the constant name, whose value is that of the
+   *      expression expr, has been added to the program.  The strings
+   *      are copied.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    Equate *newEquates;
+    Equate *equate;
+
+    if (prog->nbrEquates >= prog->equateCapacity)
+    {
+        int newSize = prog->equateCapacity == 0 ? 16 : prog->equateCapacity * 2;
+        if ((newEquates = memRealloc(MEM_PROGRAM, prog->equates, newSize * sizeof(Equate))) == NULL)
+        {
+            printError("%s", ERROR0);
+            return 0; /* fatal error: couldn't allocate memory */
+        }
+        prog->equates = newEquates;
+        prog->equateCapacity = newSize;
+    }
+
+    equate = &prog->equates[prog->nbrEquates];
+    equate->name = memStrdup(MEM_PROGRAM, name);
+    equate->expr = memStrdup(MEM_PROGRAM, expr);
+    equate->lineNum = lineNum;
+    if (equate->name == NULL || equate->expr == NULL)
+    {
+        memFree(equate->name);
+        memFree(equate->expr);
+        printError("%s", ERROR0);
+        return 0; /* fatal error: couldn't allocate memory */
+    }
+
+    prog->nbrEquates++;
+    return 1;
+}
+
+Equate *findEquate(Program *prog, const char *name)
+/* Returns the constant called name; NULL if there is none. */
+{
+    int i;
+
+    for (i = 0; i < prog->nbrEquates; i++)
+        if (strcmp(prog->equates[i].name, name) == SAME)
+            return &prog->equates[i];
+
+    return NULL;
+}
+
+int dataWord(DataSegment *data, int offset)
+/* Returns the word at offset in the data segment (zero beyond the end
+   *      of the segment).
+   */
+{
+    unsigned int word = 0;
+    int i;
+
+    for (i = offset; i < offset + 4; i++)
+        word = (word << 8) | (i < data->size ? data->bytes[i] : 0);
+
+    return (int)word;
+}
+
+int alignUp(int value, int alignment)
+/* Returns value rounded up to a multiple of alignment. */
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void programFree(Program *prog)
+/* Postcondition: all the memory used by prog has been freed, and
+   *      prog is empty.
+   */
+{
+    int i;
+
+    for (i = 0; i < prog->nbrInstrs; i++)
+        freeStrings(&prog->instrs[i]);
+    memFree(prog->instrs);
+
+    for (i = 0; i < prog->data.nbrFixups; i++)
+        memFree(prog->data.fixups[i].expr);
+    memFree(prog->data.fixups);
+    memFree(prog->data.bytes);
+    tableFree(&prog->data.labels); /* leaves an empty table */
+
+    prog->capacity = prog->nbrInstrs = 0;
+    prog->instrs = NULL;
+    prog->data.capacity = prog->data.size = 0;
+    prog->data.bytes = NULL;
+    prog->data.fixupCapacity = prog->data.nbrFixups = 0;
+    prog->data.fixups = NULL;
+
+    for (i = 0; i < prog->nbrEquates; i++)
+    {
+        memFree(prog->equates[i].name);
+        memFree(prog->equates[i].expr);
+    }
+    memFree(prog->equates);
+    prog->equateCapacity = prog->nbrEquates = 0;
+    prog->equates = NULL;
+}
+
+void codeInit(MachineCode *code)
+/* Postcondition: code is initialized to indicate that there
+   *       are no words in it.
+   */
+{
+    code->capacity = code->nbrWords = code->textWords = 0;
+    code->words = NULL;
+    code->lineNums = NULL;
+    code->output = NULL;
+}
+
+int addWord(MachineCode *code, uint32_t word, int address, int lineNum)
+/* Postcondition: word, which goes at address and comes from source
+   *      line lineNum, has been added to the end of code, which
+   *      has been resized if necessary (or passed to its output
+   *      function, if it has one).
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    uint32_t *newWords;
+    int *newLineNums;
+
+    if (code->output != NULL)
+    {
+        code->output(word, address, lineNum);
+        code->nbrWords++;
+        return 1;
+    }
+
+    if (code->nbrWords >= code->capacity)
+    {
+        int newSize = code->capacity == 0 ? 1024 : code->capacity * 2;
+        if ((newWords = memRealloc(MEM_PROGRAM, code->words, newSize * sizeof(uint32_t))) == NULL)
+        {
+            printError("%s", ERROR0);
+            return 0; /* fatal error: couldn't allocate memory */
+        }
+        code->words = newWords;
+        if ((newLineNums = memRealloc(MEM_PROGRAM, code->lineNums, newSize * sizeof(int))) == NULL)
+        {
+            printError("%s", ERROR0);
+            return 0; /* fatal error: couldn't allocate memory */
+        }
+        code->lineNums = newLineNums;
+        code->capacity = newSize;
+    }
+
+    code->words[code->nbrWords] = word;
+    code->lineNums[code->nbrWords++] = lineNum;
+    return 1;
+}
+
+void codeFree(MachineCode *code)
+/* Postcondition: all the memory used by code has been freed, and
+   *      code is empty (but keeps its output function).
+   */
+{
+    memFree(code->words);
+    memFree(code->lineNums);
+    code->capacity = code->nbrWords = code->textWords = 0;
+    code->words = NULL;
+    code->lineNums = NULL;
+}
+
+static void freeStrings(Instruction *instr)
+/* Postcondition: the strings owned by instr have been freed. */
+{
+    memFree(instr->label);
+    memFree(instr->name);
+    memFree(instr->target);
+    memFree(instr->expr);
+}
+
+static int resizeData(DataSegment *data, int newSize)
+/* Postcondition: the data segment now has the capacity to hold
+   *      newSize bytes.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    unsigned char *newBytes;
+
+    if ((newBytes = memRealloc(MEM_PROGRAM, data->bytes, newSize)) == NULL)
+    {
+        printError("%s", ERROR0);
+        return 0; /* fatal error: couldn't allocate memory */
+    }
+
+    data->bytes = newBytes;
+    data->capacity = newSize;
+    return 1;
+}
+
+
+static int updateLabels(Program *prog, LabelTable *table)
+/* Postcondition: each label in table that marks a statement of prog
+   *      has the address of the statement, the labels of the text
+   *      segment that no statement carries any more have been
+   *      removed, and the labels that the passes made up have been
+   *      added.  The labels of the data segment are left as they are.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    LabelEntry **entries; /* the entries of table, by name */
+    LabelEntry *marks;    /* the labels in prog, by name */
+    int nbrMarks = 0, nbrNew = 0;
+    int i, j, k;
+
+    /* Sort both by name and walk them side by side, rather than look
+     * each label up in the table.
+     */
+    for (i = 0; i < prog->nbrInstrs; i++)
+        nbrMarks += prog->instrs[i].label != NULL;
+    entries = memAlloc(MEM_LABELS, (table->nbrLabels + 1) * sizeof(LabelEntry *));
+    marks = memAlloc(MEM_LABELS, (nbrMarks + 1) * sizeof(LabelEntry));
+    if (entries == NULL || marks == NULL)
+    {
+        memFree(entries);
+        memFree(marks);
+        printError("%s", ERROR0);
+        return 0; /* fatal error: couldn't allocate memory */
+    }
+    for (i = 0; i < table->nbrLabels; i++)
+        entries[i] = &table->entries[i];
+    for (i = 0, k = 0; i < prog->nbrInstrs; i++)
+    {
+        if (prog->instrs[i].label == NULL)
+            continue;
+        marks[k].label = prog->instrs[i].label;
+        marks[k++].address = prog->instrs[i].address;
+    }
+    qsort(entries, table->nbrLabels, sizeof(LabelEntry *), compareEntries);
+    qsort(marks, nbrMarks, sizeof(LabelEntry), compareMarks);
+
+    /* A mark that is not in the table is new; it is moved to the front
+     * of marks, to be added once the walk is over.
+     */
+    for (i = 0, j = 0; i < table->nbrLabels || j < nbrMarks;)
+    {
+        int order = i == table->nbrLabels ? 1 : j == nbrMarks ? -1 :
+                    strcmp(entries[i]->label, marks[j].label);
+
+        if (order == 0)
+            entries[i++]->address = marks[j++].address;
+        else if (order > 0)
+            marks[nbrNew++] = marks[j++];
+        else if (entries[i]->address < DATA_BASE)
+        {
+            memFree(entries[i]->label);
+            entries[i++]->label = NULL; /* removed below */
+        }
+        else
+            i++;
+    }
+    memFree(entries);
+
+    for (i = 0, j = 0; i < table->nbrLabels; i++)
+        if (table->entries[i].label != NULL)
+            table->entries[j++] = table->entries[i];
+    table->nbrLabels = j;
+
+    if (table->nbrLabels + nbrNew > table->capacity &&
+        !tableResize(table, table->nbrLabels + nbrNew))
+    {
+        memFree(marks);
+        return 0; /* error message already printed */
+    }
+    for (k = 0; k < nbrNew; k++)
+    {
+        if ((table->entries[table->nbrLabels].label = memStrdup(MEM_LABELS, marks[k].label)) == NULL)
+        {
+            memFree(marks);
+            printError("%s", ERROR0);
+            return 0; /* fatal error: couldn't allocate memory */
+        }
+        table->entries[table->nbrLabels++].address = marks[k].address;
+    }
+
+    memFree(marks);
+    return 1;
+}
+
+static int compareEntries(const void *a, const void *b)
+/* Compares two pointers to label entries by name, for qsort. */
+{
+    return strcmp((*(LabelEntry *const *)a)->label, (*(LabelEntry *const *)b)->label);
+}
+
+static int compareMarks(const void *a, const void *b)
+/* Compares two label entries by name, for qsort. */
+{
+    return strcmp(((const LabelEntry *)a)->label, ((const LabelEntry *)b)->label);
+}
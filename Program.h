@@ -0,0 +1,290 @@
+/*
+ * Program: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for a group
+ * of associated functions useful for keeping the decoded instructions
+ * of an assembly source file in memory between pass1 and pass2, so that
+ * optional passes (such as the peephole optimizer) can rewrite the
+ * program before it is translated to machine language.  The program
+ * also holds the contents of its data segment (.data).  The machine
+ * code that pass2 translates the program into is kept in memory too,
+ * as an array of words, or passed on a word at a time as it is made.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *   Modified:	10/19/2026  Added the data segment and .align statements.
+ *   Modified:	10/19/2026  Added the machine code (MachineCode).
+ *   Modified:	10/19/2026  Added operands that are expressions, and
+ *                          constants (.equ).
+ *   Modified:	10/19/2026  A branch whose delay slot is filled is no longer
+ *                          in reorder mode.
+ *
+*/
+
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <stdint.h>
+
+/* The text segment starts at address 0; the data segment starts at
+ * DATA_BASE, as in SPIM and MARS.
+ */
+#define DATA_BASE 0x10010000
+
+/* THE DATA STRUCTURES */
+
+/* The struct Format is used to store the code(opcode or funct number)
+ *  and the format('R', 'I', 'J') of an instruction.
+ */
+
+typedef struct
+{
+	int code;	 /* instruction code */
+	char *opType; /* instruction format */
+} Format;
+
+/* The struct Instruction holds one statement of the text segment
+ * after its operands have been decoded.  A line that contains only a
+ * label is kept as an Instruction whose name is NULL, so that the label
+ * still marks the instruction that follows it.  A .align directive is
+ * kept the same way, with align set.
+ */
+
+typedef struct
+{
+	int lineNum;	/* source line number (for error messages) */
+	char *label;	/* label at the beginning of the line, or NULL */
+	char *name;	/* instruction name (e.g., "add"), or NULL */
+	Format f;	/* instruction code and format */
+	int rs, rt, rd;	/* register numbers */
+	int shamt;	/* shift amount (sll, srl) */
+	int imm;	/* immediate value or load/store offset */
+	char *target;	/* label operand, or NULL: the branch target of
+			   beq and bne, the jump target of j and jal, the
+			   upper half of its address for lui, and the
+			   lower half for other I-format instructions */
+	char *expr;	/* the immediate (or shift amount) as an
+			   expression whose value is only known once
+			   the labels are (see expr.h), or NULL */
+	int address;	/* address of the instruction */
+	int reorder;	/* 1 if assembled in .set reorder mode, in which
+			   the assembler fills the delay slot of a branch
+			   or jump; 0 if the source fills its own (or,
+			   for a branch or jump, once it is filled) */
+	int align;	/* for .align n: n (the address is aligned to a
+			   multiple of 2 to the n); 0 otherwise */
+	int padding;	/* for .align: nbr of bytes of nops it adds */
+} Instruction;
+
+/* The struct DataFixup records an item in the data segment whose
+ * value uses a label (e.g., .word label, or .half end - start), to be
+ * filled in once all the labels are known.
+ */
+
+typedef struct
+{
+	int offset;	/* offset of the item in the data segment */
+	int size;	/* nbr of bytes in the item (1, 2, or 4) */
+	char *expr;	/* expression whose value goes in the item */
+	int lineNum;	/* source line number (for error messages) */
+} DataFixup;
+
+typedef struct
+{
+	int capacity;		/* capacity of bytes */
+	int size;		/* nbr of bytes in the data segment */
+	unsigned char *bytes;	/* contents, in big-endian byte order */
+	int fixupCapacity;	/* capacity of fixups */
+	int nbrFixups;		/* actual nbr of fixups */
+	DataFixup *fixups;
+	LabelTable labels;	/* labels in the data segment */
+} DataSegment;
+
+/* The struct Equate holds a constant defined by .equ (or .set) as the
+ * text of its expression, which is evaluated whenever it is used.
+ */
+
+typedef struct
+{
+	char *name;	/* name of the constant */
+	char *expr;	/* expression that gives its value */
+	int lineNum;	/* source line number (for error messages) */
+} Equate;
+
+typedef struct
+{
+	int capacity;	/* capacity of the program */
+	int nbrInstrs;	/* actual nbr of statements in program */
+	Instruction *instrs;
+	DataSegment data;	/* the data segment */
+	int equateCapacity;	/* capacity of equates */
+	int nbrEquates;		/* actual nbr of constants */
+	Equate *equates;
+} Program;
+
+/* The struct MachineCode holds the words of machine code that a
+ * program is translated into: the text segment, followed by the data
+ * segment, with the source line each word comes from (0 for the data
+ * segment), so that an address can be traced back to its line.  If it
+ * has an output function, each word is passed to it as it is made,
+ * with its address and line, instead of being kept (e.g., to print it).
+ */
+
+typedef struct
+{
+	int capacity;		/* capacity of words */
+	int nbrWords;		/* actual nbr of words */
+	int textWords;		/* nbr of words in the text segment */
+	uint32_t *words;
+	int *lineNums;		/* source line of each word */
+	void (*output)(uint32_t word, int address, int lineNum);
+				/* if not NULL, is given the words instead */
+} MachineCode;
+
+/* THE FUNCTIONS */
+
+void programInit(Program *prog);
+/* Postcondition: prog is initialized to indicate that there
+         *       are no statements in it.
+         */
+
+int programResize(Program *prog, int newSize);
+/* Postcondition: prog now has the capacity to hold newSize
+         *      statements.
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+int addInstruction(Program *prog, Instruction *instr);
+/* Postcondition: a copy of instr has been added to the end of the
+         *      program, which has been resized if necessary.  The
+         *      program takes ownership of the label, name, target, and
+         *      expr strings in instr.
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+void deleteInstruction(Program *prog, int index);
+/* Postcondition: the instruction at index has been deleted.  Its
+         *      label (if any) is left behind so that it now marks the
+         *      following instruction.  Indices and addresses of the
+         *      other statements are unchanged until the next call to
+         *      layoutProgram.
+         */
+
+int layoutProgram(Program *prog, LabelTable *table);
+/* Postcondition: deleted statements have been removed, every
+         *      instruction has been given an address (4 bytes apart,
+         *      starting at 0, plus the padding of .align statements),
+         *      and the entries of table have been updated in place:
+         *      each label of the text segment has the address of the
+         *      statement it marks, the labels no statement carries
+         *      any more are gone, and new ones have been added.
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+int findInstruction(Program *prog, LabelTable *table, char *label);
+/* Returns the index of the instruction marked by label; -1 if the
+         *      label is not in the table or marks the end of the program.
+         */
+
+int isControlTransfer(Instruction *instr);
+/* Returns 1 if instr is a branch or jump (beq, bne, j, jal, jr);
+         *      0 otherwise.
+         */
+
+int destRegister(Instruction *instr);
+/* Returns the number of the register written by instr; -1 if instr
+         *      does not write a register.
+         */
+
+int sourceRegisters(Instruction *instr, int regs[]);
+/* Puts the numbers of the registers read by instr in regs, which must
+         *      have room for 2 entries.
+         * Returns the number of registers read.
+         */
+
+int readsRegister(Instruction *instr, int reg);
+/* Returns 1 if instr reads register reg; 0 otherwise. */
+
+int isMemoryAccess(Instruction *instr);
+/* Returns 1 if instr is a load (lw), 2 if it is a store (sw), and
+         *      0 otherwise.
+         */
+
+int dependsOn(Instruction *second, Instruction *first);
+/* Returns 1 if second, which comes after first, must stay after it:
+         *      it reads a register that first writes, writes one that
+         *      first reads or writes, or is a load or store that would
+         *      pass a store (or a store that would pass a load); 0
+         *      otherwise, or if either one is not an instruction.  The
+         *      test is symmetric, so it also tells whether first can
+         *      move after second.
+         */
+
+int addData(DataSegment *data, int value, int size);
+/* Postcondition: the low size bytes of value (size is 1, 2, or 4)
+         *      have been added to the end of the data segment, most
+         *      significant byte first.
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+int alignData(DataSegment *data, int alignment);
+/* Postcondition: zero bytes have been added to the data segment
+         *      until its size is a multiple of alignment.
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+int addFixup(DataSegment *data, char *expr, int size, int lineNum);
+/* Postcondition: a zero item of size bytes has been added to the end
+         *      of the data segment, to be filled in with the value of
+         *      the expression expr (e.g., the address of a label).
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+void truncateData(DataSegment *data, int size);
+/* Postcondition: the bytes of the data segment from offset size on,
+         *      and the fixups of the items in them, have been removed.
+         */
+
+int addEquate(Program *prog, char *name, char *expr, int lineNum);
+/* Postcondition: the constant name, whose value is that of the
+         *      expression expr, has been added to the program.  The
+         *      strings are copied.
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+Equate *findEquate(Program *prog, const char *name);
+/* Returns the constant called name; NULL if there is none. */
+
+int dataWord(DataSegment *data, int offset);
+/* Returns the word at offset in the data segment (zero beyond the end
+         *      of the segment).
+         */
+
+int alignUp(int value, int alignment);
+/* Returns value rounded up to a multiple of alignment. */
+
+void programFree(Program *prog);
+/* Postcondition: all the memory used by prog has been freed, and
+         *      prog is empty.
+         */
+
+void codeInit(MachineCode *code);
+/* Postcondition: code is initialized to indicate that there
+         *       are no words in it.
+         */
+
+int addWord(MachineCode *code, uint32_t word, int address, int lineNum);
+/* Postcondition: word, which goes at address and comes from source
+         *      line lineNum, has been added to the end of code, which
+         *      has been resized if necessary (or passed to its output
+         *      function, if it has one).
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+void codeFree(MachineCode *code);
+/* Postcondition: all the memory used by code has been freed, and
+         *      code is empty (but keeps its output function).
+         */
+
+#endif
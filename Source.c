@@ -0,0 +1,1049 @@
+/*
+ * Source: functions to read the lines of an assembly source file
+ *
+ * This file provides the definitions of the front end of the
+ * assembler, which hands pass1 the lines of a source file one at a
+ * time, with comments stripped off and these directives expanded:
+ *      .include "file"           reads the lines of file, unless it has
+ *                                already been included; file is looked
+ *                                for in the directory of the file that
+ *                                includes it, then in each -I directory
+ *      .macro name p1, p2, ...   defines a macro, whose body runs up to
+ *      ...                       the matching .endm; in the body, \p1
+ *      .endm                     stands for the first argument, etc.
+ *      name a1, a2, ...          expands the macro with the arguments
+ *      .rept n                   repeats the lines up to the matching
+ *      ...                       .endr n times
+ *      .endr
+ * A label defined in the body of a macro or .rept block is renamed in
+ * each expansion (e.g., loop becomes loop#M3; the # starts a comment in
+ * the source, so no label there can have that name), so that a macro
+ * can be used more than once.  The body is kept in memory and expanded line
+ * by line as pass1 reads it, so the source never has to contain the
+ * repeated text.  The lines of an included file are kept in memory too,
+ * with their comments stripped, and reused by later source files that
+ * include it (until it is modified); they are parsed again each time,
+ * since what they mean depends on where they are included (the segment,
+ * the .set options, and the macros and .equ names defined so far).
+ * The lines read from included files are numbered from INCLUDED_LINE
+ * up, in the order they are read, so that they can't be mistaken for
+ * lines of the source file itself; lineName and mainLine tell which
+ * file and line each of them comes from.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *   Modified:  10/19/2026   Added .include and the include cache.
+ *   Modified:  10/19/2026   Tell files modified within the same second
+ *                           apart (for --watch), and list the cache.
+ *   Modified:  10/19/2026   Included files may be compressed.
+ *   Modified:  10/19/2026   The lines of a .rept block keep their own
+ *                           line nbrs.
+ *   Modified:  10/19/2026   The lines of an included file keep their
+ *                           own line nbrs, and errors in them give the
+ *                           name of the file.
+ *   Modified:  10/19/2026   A macro or .rept body ends with the input
+ *                           it is in; local labels are renamed to
+ *                           names the source can't use.
+ *
+ */
+
+#include <sys/stat.h>
+
+#include "assembler.h"
+#include "decompress.h"
+
+/* The struct CachedFile holds the lines of an included file, and the
+ * time it was last modified (to the nanosecond, where the file system
+ * keeps it) and its size when they were read.
+ */
+typedef struct
+{
+    Macro *body;           /* the lines of the file */
+    struct timespec mtime; /* modification time of the file */
+    off_t size;            /* size of the file */
+} CachedFile;
+
+/* The first line nbr given to the lines of included files. */
+#define INCLUDED_LINE 1000000000
+
+/* The struct LineRun maps a run of the line nbrs given to the lines of
+ * included files to the lines they were read from.
+ */
+typedef struct
+{
+    int first;    /* the first line nbr of the run */
+    int count;    /* nbr of line nbrs in the run */
+    int fileLine; /* the line of the file that first stands for */
+    char *path;   /* the file (the name of its lines in the cache) */
+    int mainLine; /* the line of the source file that includes it */
+} LineRun;
+
+/* internal global variables (global to this file only); each thread
+ * has its own include cache
+ */
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+static _Thread_local LabelTable cachePaths; /* paths, with their index in cache */
+static _Thread_local int cacheCapacity = 0; /* capacity of cache */
+static _Thread_local int cacheSize = 0;     /* actual nbr of files in cache */
+static _Thread_local CachedFile *cache = NULL;
+static _Thread_local int runsCapacity = 0;  /* capacity of runs */
+static _Thread_local int nbrRuns = 0;       /* actual nbr of runs */
+static _Thread_local LineRun *runs = NULL;  /* in the order they were read */
+static _Thread_local int nbrIncludedLines = 0;
+static _Thread_local char lineNames[2][BUFSIZ]; /* returned by lineName */
+static _Thread_local int lastName = 0;          /* the one returned last */
+
+/* internal functions (visible to this file only)*/
+static int nextLine(Source *src, char *line, int size);
+static int processLine(Source *src, char *line, int size);
+static Macro *readBody(Source *src, char *name, char *params, char *start, char *end);
+static int addBodyLine(Macro *macro, char *line, int lineNum);
+static void defineMacro(Source *src, char *rest);
+static void includeFile(Source *src, char *rest);
+static char *findInclude(Source *src, char *name);
+static Macro *loadFile(char *path, struct stat *info);
+static int includedLine(char *path, int fileLine, int including);
+static LineRun *findRun(int lineNum);
+static void invokeMacro(Source *src, Macro *macro, char *rest);
+static void pushExpansion(Source *src, Macro *body, char **args, int count, int ownsBody);
+static void popExpansion(Source *src);
+static void expandLine(Source *src, Expansion *exp, char *out, int size);
+static char *firstToken(char *line, char **label, char **rest);
+static char *copyText(char *begin, char *end);
+static void freeMacro(Macro *macro);
+
+void sourceInit(Source *src, FILE *fp, char *fileName)
+/* Postcondition: src reads its lines from fp, which was opened from
+   *      fileName (NULL for the standard input), and has no macros
+   *      defined or files included.
+   */
+{
+    src->fp = fp;
+    src->fileName = fileName;
+    src->fileLine = 0;
+    src->lineNum = 0;
+    src->depth = 0;
+    tableInit(&src->included);
+    tableInit(&src->macroNames);
+    src->capacity = 0;
+    src->nbrMacros = 0;
+    src->macros = NULL;
+    src->nbrExpansions = 0;
+
+    /* the line nbrs of the included files start over */
+    nbrRuns = nbrIncludedLines = 0;
+}
+
+int readLine(Source *src, char *line, int size)
+/* Postcondition: line holds the next line of the source, with any
+   *      comment stripped off and macros and .rept blocks expanded.
+   * Returns 1 if a line was read; 0 at the end of the source.
+   */
+{
+    while (nextLine(src, line, size))
+    {
+        /* Hand the line to pass1 unless it was a macro or .rept */
+        if (processLine(src, line, size))
+            return 1;
+    }
+
+    return 0;
+}
+
+void stripComment(char *line)
+/* Postcondition: the comment (if any) at the end of line has been
+   *      stripped off (the '#' is replaced with a null byte).
+   */
+{
+    int inString = 0;
+
+    for (; *line != '\0'; line++)
+    {
+        if (*line == '"')
+            inString = !inString;
+        else if (*line == '\\' && inString && line[1] != '\0')
+            line++; /* skip the escaped character */
+        else if (*line == '#' && !inString)
+        {
+            *line = '\0';
+            return;
+        }
+    }
+}
+
+void sourceFree(Source *src)
+/* Postcondition: all the memory used by src (but not its file) has
+   *      been freed.
+   */
+{
+    int i;
+
+    while (src->depth > 0)
+        popExpansion(src);
+
+    for (i = 0; i < src->nbrMacros; i++)
+        freeMacro(src->macros[i]);
+    memFree(src->macros);
+    src->macros = NULL;
+    src->capacity = src->nbrMacros = 0;
+    tableFree(&src->macroNames);
+    tableFree(&src->included);
+}
+
+int writeDependencies(Source *src, char *fileName)
+/* Postcondition: a make rule saying that fileName.out depends on
+   *      fileName and on the files it included has been written to
+   *      fileName.d, with an empty rule for each included file.
+   * Returns 1 if everything went OK; 0 if the file can't be written.
+   */
+{
+    char *depName;
+    FILE *fp;
+    int i;
+
+    if ((depName = memAlloc(MEM_SOURCE, strlen(fileName) + 3)) == NULL)
+    {
+        printError("%s", ERROR0);
+        return 0;
+    }
+    sprintf(depName, "%s.d", fileName);
+
+    if ((fp = fopen(depName, "w")) == NULL)
+    {
+        printError("Error: Cannot open file %s.\n", depName);
+        memFree(depName);
+        return 0;
+    }
+
+    fprintf(fp, "%s.out: %s", fileName, fileName);
+    for (i = 0; i < src->included.nbrLabels; i++)
+        fprintf(fp, " \\\n  %s", src->included.entries[i].label);
+    fprintf(fp, "\n");
+
+    /* so that make doesn't fail if an included file is removed */
+    for (i = 0; i < src->included.nbrLabels; i++)
+        fprintf(fp, "\n%s:\n", src->included.entries[i].label);
+
+    memFree(depName);
+    return fclose(fp) == 0;
+}
+
+void freeIncludeCache(void)
+/* Postcondition: the lines of the included files have been freed. */
+{
+    int i;
+
+    for (i = 0; i < cacheSize; i++)
+        freeMacro(cache[i].body);
+    memFree(cache);
+    cache = NULL;
+    cacheCapacity = cacheSize = 0;
+    tableFree(&cachePaths);
+    memFree(runs);
+    runs = NULL;
+    runsCapacity = nbrRuns = nbrIncludedLines = 0;
+}
+
+char *includedFile(int index)
+/* Returns the path of the index'th file in the include cache; NULL if
+   *      there are no more.
+   */
+{
+    return index < cacheSize ? cachePaths.entries[index].label : NULL;
+}
+
+char *lineName(int lineNum)
+/* Returns the name of line lineNum for messages: "line 12" for a line
+   *      of the source file, "file:3" for a line of an included file.
+   *      The name is overwritten by the call after next.
+   */
+{
+    LineRun *run = findRun(lineNum);
+    char *name;
+
+    lastName = !lastName;
+    name = lineNames[lastName];
+    if (run == NULL)
+        snprintf(name, BUFSIZ, "line %d", lineNum);
+    else
+        snprintf(name, BUFSIZ, "%s:%d", run->path, run->fileLine + lineNum - run->first);
+    return name;
+}
+
+int mainLine(int lineNum)
+/* Returns the line of the source file that line lineNum is on or (for
+   *      a line of an included file) includes it.
+   */
+{
+    LineRun *run = findRun(lineNum);
+
+    return run == NULL ? lineNum : run->mainLine;
+}
+
+static int nextLine(Source *src, char *line, int size)
+/* Puts the next line of the innermost expansion in progress (or, if
+   * there is none, of the file) in line, with its comment stripped off.
+   * Returns 1 if a line was read; 0 at the end of the file.
+   */
+{
+    while (src->depth > 0)
+    {
+        Expansion *exp = &src->stack[src->depth - 1];
+
+        if (exp->next < exp->body->nbrLines)
+        {
+            /* a line of an included file or of a .rept block keeps
+             * its own line nbr; a line of a macro has the line of the
+             * invocation
+             */
+            if (exp->body->isFile)
+                src->lineNum = includedLine(exp->body->name, exp->body->lineNums[exp->next],
+                                            mainLine(exp->lineNum));
+            else if (exp->body->name == NULL)
+                src->lineNum = exp->body->lineNums[exp->next];
+            else
+                src->lineNum = exp->lineNum;
+            expandLine(src, exp, line, size);
+            exp->next++;
+            return 1;
+        }
+
+        /* start the next repetition, or finish the expansion */
+        if (--exp->remaining > 0)
+        {
+            exp->next = 0;
+            exp->id = ++src->nbrExpansions;
+        }
+        else
+            popExpansion(src);
+    }
+
+    if (fgets(line, size, src->fp) == NULL)
+        return 0;
+
+    src->lineNum = ++src->fileLine;
+    stripComment(line);
+    return 1;
+}
+
+static int processLine(Source *src, char *line, int size)
+/* Processes line if it is a macro definition, a macro invocation, or
+   * a .rept block.  A label on such a line is left in line for pass1.
+   * Returns 1 if pass1 should process line; 0 otherwise.
+   */
+{
+    char copy[BUFSIZ];
+    char *label, *name, *rest;
+    int index;
+
+    strncpy(copy, line, sizeof(copy) - 1);
+    copy[sizeof(copy) - 1] = '\0';
+    if ((name = firstToken(copy, &label, &rest)) == NULL)
+        return 1;
+
+    if (strcmp(name, ".macro") == SAME)
+        defineMacro(src, rest);
+    else if (strcmp(name, ".include") == SAME)
+        includeFile(src, rest);
+    else if (strcmp(name, ".rept") == SAME)
+    {
+        char *end;
+        long count = strtol(rest, &end, 0);
+        Macro *body;
+
+        while (isspace((unsigned char)*end))
+            end++;
+        if (end == rest || *end != '\0' || count < 0)
+        {
+            printError("Unexpected error on %s: invalid token %s for .rept directive.\n",
+                       lineName(src->lineNum), rest);
+            count = 0;
+        }
+
+        /* read the body even if the count is invalid, to skip it */
+        if ((body = readBody(src, NULL, NULL, ".rept", ".endr")) == NULL)
+            return 0; /* error message already printed */
+        if (count > 0 && body->nbrLines > 0)
+            pushExpansion(src, body, NULL, (int)count, 1);
+        else
+            freeMacro(body);
+    }
+    else if ((index = findLabel(&src->macroNames, name)) != -1)
+        invokeMacro(src, src->macros[index], rest);
+    else
+        return 1;
+
+    /* the label marks the first line of the expansion */
+    if (label == NULL)
+        return 0;
+    snprintf(line, size, "%s:\n", label);
+    return 1;
+}
+
+static Macro *readBody(Source *src, char *name, char *params, char *start, char *end)
+/* Reads the lines up to the end directive that matches start (.macro
+   * and .endm, or .rept and .endr) into a new macro with the given name
+   * and parameters (which may be NULL).  The end directive must be in
+   * the same input as start: the file, or the included file, macro, or
+   * .rept block being expanded.
+   * Returns the macro; NULL if the end directive is missing or memory
+   * allocation error.
+   */
+{
+    Macro *macro;
+    char line[BUFSIZ], copy[BUFSIZ];
+    char *label, *token, *rest;
+    int lineNum = src->lineNum;
+    int depth = src->depth; /* of the expansion the body is in */
+    int nesting = 0;
+
+    if ((macro = memCalloc(MEM_SOURCE, 1, sizeof(Macro))) == NULL)
+    {
+        printError("%s", ERROR0);
+        return NULL;
+    }
+    tableInit(&macro->params);
+    tableInit(&macro->locals);
+
+    if (name != NULL && (macro->name = memStrdup(MEM_SOURCE, name)) == NULL)
+    {
+        printError("%s", ERROR0);
+        freeMacro(macro);
+        return NULL;
+    }
+
+    /* the parameters are separated by commas or whitespace */
+    for (token = params; token != NULL && *token != '\0';)
+    {
+        char *tokEnd;
+
+        getToken(&token, &tokEnd);
+        if (*token == '\0')
+            break;
+        rest = *tokEnd == '\0' ? tokEnd : tokEnd + 1;
+        *tokEnd = '\0';
+        if (findLabel(&macro->params, token) != -1)
+            printError("Unexpected error on %s: duplicate parameter %s.\n", lineName(lineNum), token);
+        else if (addLabel(&macro->params, token, macro->params.nbrLabels) == 0)
+        {
+            freeMacro(macro);
+            return NULL; /* error message already printed */
+        }
+        token = rest;
+    }
+
+    /* stop at the end of the input the body is in, rather than go on
+     * into the one that included or invoked it
+     */
+    while ((depth == 0 || src->stack[depth - 1].next < src->stack[depth - 1].body->nbrLines) &&
+           nextLine(src, line, sizeof(line)))
+    {
+        strcpy(copy, line);
+        if ((token = firstToken(copy, &label, &rest)) != NULL)
+        {
+            if (strcmp(token, start) == SAME)
+                nesting++;
+            else if (strcmp(token, end) == SAME && nesting-- == 0)
+                return macro;
+        }
+
+        /* labels defined in the body are renamed in each expansion */
+        if ((label != NULL && findLabel(&macro->locals, label) == -1 &&
+             addLabel(&macro->locals, label, 0) == 0) ||
+            !addBodyLine(macro, line, src->lineNum))
+        {
+            freeMacro(macro);
+            return NULL; /* error message already printed */
+        }
+    }
+
+    printError("Unexpected error on %s: %s without %s.\n", lineName(lineNum), start, end);
+    freeMacro(macro);
+    return NULL;
+}
+
+static int addBodyLine(Macro *macro, char *line, int lineNum)
+/* Postcondition: a copy of line, which was read as line nbr lineNum,
+   *      has been added to the end of the body of macro, which has
+   *      been resized if necessary.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    if (macro->nbrLines >= macro->capacity)
+    {
+        int newSize = macro->capacity == 0 ? 16 : macro->capacity * 2;
+        char **newLines = memRealloc(MEM_SOURCE, macro->lines, newSize * sizeof(char *));
+        int *newLineNums;
+
+        if (newLines == NULL)
+        {
+            printError("%s", ERROR0);
+            return 0;
+        }
+        macro->lines = newLines;
+        if ((newLineNums = memRealloc(MEM_SOURCE, macro->lineNums, newSize * sizeof(int))) == NULL)
+        {
+            printError("%s", ERROR0);
+            return 0;
+        }
+        macro->lineNums = newLineNums;
+        macro->capacity = newSize;
+    }
+
+    if ((macro->lines[macro->nbrLines] = memStrdup(MEM_SOURCE, line)) == NULL)
+    {
+        printError("%s", ERROR0);
+        return 0;
+    }
+    macro->lineNums[macro->nbrLines++] = lineNum;
+    return 1;
+}
+
+static void defineMacro(Source *src, char *rest)
+/* Defines the macro whose name and parameters are in rest, with the
+   * body that follows it.
+   */
+{
+    char *name = rest, *tokEnd;
+    Macro *macro;
+
+    getToken(&name, &tokEnd);
+    if (*name == '\0')
+    {
+        printError("Unexpected error on %s: Directive contains fewer tokens than expected.\n",
+                   lineName(src->lineNum));
+        name = NULL; /* still skip the body */
+    }
+    else
+    {
+        rest = *tokEnd == '\0' ? tokEnd : tokEnd + 1;
+        *tokEnd = '\0';
+    }
+
+    if ((macro = readBody(src, name, rest, ".macro", ".endm")) == NULL)
+        return; /* error message already printed */
+
+    if (name == NULL || findLabel(&src->macroNames, name) != -1)
+    {
+        if (name != NULL)
+            printError("Unexpected error on %s: macro %s is already defined.\n",
+                       lineName(src->lineNum), name);
+        freeMacro(macro);
+        return;
+    }
+
+    /* Resize the list if necessary to add the new macro */
+    if (src->nbrMacros >= src->capacity)
+    {
+        int newSize = src->capacity == 0 ? 8 : src->capacity * 2;
+        Macro **newMacros = memRealloc(MEM_SOURCE, src->macros, newSize * sizeof(Macro *));
+
+        if (newMacros == NULL)
+        {
+            printError("%s", ERROR0);
+            freeMacro(macro);
+            return;
+        }
+        src->macros = newMacros;
+        src->capacity = newSize;
+    }
+
+    if (addLabel(&src->macroNames, name, src->nbrMacros) == 0)
+    {
+        freeMacro(macro);
+        return; /* error message already printed */
+    }
+    src->macros[src->nbrMacros++] = macro;
+}
+
+static void includeFile(Source *src, char *rest)
+/* Starts reading the file whose name (in double quotes) is in rest,
+   * unless it has already been included.
+   */
+{
+    char *name = rest, *end;
+    char *path;
+    struct stat info;
+    Macro *body;
+
+    while (isspace((unsigned char)*name))
+        name++;
+    if (*name != '"' || (end = strchr(name + 1, '"')) == NULL)
+    {
+        printError("Unexpected error on %s: invalid token %s for .include directive.\n",
+                   lineName(src->lineNum), rest);
+        return;
+    }
+    *end = '\0';
+    name++;
+
+    if ((path = findInclude(src, name)) == NULL)
+    {
+        printError("Unexpected error on %s: cannot find included file %s.\n",
+                   lineName(src->lineNum), name);
+        return;
+    }
+
+    /* Each file is included only once (which also stops a file from
+     * including itself).
+     */
+    if (findLabel(&src->included, path) == -1 &&
+        addLabel(&src->included, path, 0) != 0 &&
+        stat(path, &info) == 0 &&
+        (body = loadFile(path, &info)) != NULL)
+        pushExpansion(src, body, NULL, 1, 0);
+
+    memFree(path);
+}
+
+static char *findInclude(Source *src, char *name)
+/* Returns the path of the included file name: in the directory of the
+   * file that includes it, or else in the first -I directory that has
+   * it; NULL if there is no such file (or memory allocation error).
+   */
+{
+    char *including = src->fileName;
+    struct stat info;
+    int i;
+
+    /* the innermost file being read */
+    for (i = src->depth - 1; i >= 0; i--)
+    {
+        if (src->stack[i].body->isFile)
+        {
+            including = src->stack[i].body->name;
+            break;
+        }
+    }
+
+    for (i = -1; i < OPTIONS.nbrIncludeDirs; i++)
+    {
+        char *dir = i == -1 ? including : OPTIONS.includeDirs[i];
+        int dirLength = 0;
+        char *path;
+
+        /* the directory of the including file is the part of its name
+         * up to the last '/' (none for a file in the current directory)
+         */
+        if (*name == '/')
+            dirLength = 0;
+        else if (i == -1 && dir != NULL && strrchr(dir, '/') != NULL)
+            dirLength = strrchr(dir, '/') - dir + 1;
+        else if (i != -1)
+            dirLength = strlen(dir);
+
+        if ((path = memAlloc(MEM_SOURCE, dirLength + strlen(name) + 2)) == NULL)
+        {
+            printError("%s", ERROR0);
+            return NULL;
+        }
+        sprintf(path, "%.*s%s%s", dirLength, dirLength > 0 ? dir : "",
+                dirLength > 0 && dir[dirLength - 1] != '/' ? "/" : "", name);
+
+        if (stat(path, &info) == 0 && S_ISREG(info.st_mode))
+            return path;
+        memFree(path);
+
+        /* an absolute path is not searched for */
+        if (*name == '/')
+            break;
+    }
+
+    return NULL;
+}
+
+static Macro *loadFile(char *path, struct stat *info)
+/* Returns the lines of the file at path, whose modification time and
+   * size are in info: from the cache if they were read since it was
+   * last modified, or else read from the file (and cached).
+   * Returns NULL if the file can't be read or memory allocation error.
+   */
+{
+    int index = findLabel(&cachePaths, path);
+    char line[BUFSIZ];
+    Macro *body;
+    FILE *fp;
+
+    if (index != -1 && cache[index].mtime.tv_sec == info->st_mtim.tv_sec &&
+        cache[index].mtime.tv_nsec == info->st_mtim.tv_nsec &&
+        cache[index].size == info->st_size)
+        return cache[index].body;
+
+    if ((fp = fopen(path, "r")) == NULL)
+    {
+        printError("Error: Cannot open file %s.\n", path);
+        return NULL;
+    }
+    if ((fp = decompressOpen(fp, path)) == NULL)
+        return NULL; /* error message already printed */
+
+    if ((body = memCalloc(MEM_SOURCE, 1, sizeof(Macro))) == NULL || (body->name = memStrdup(MEM_SOURCE, path)) == NULL)
+    {
+        printError("%s", ERROR0);
+        memFree(body);
+        fclose(fp);
+        return NULL;
+    }
+    body->isFile = 1;
+    tableInit(&body->params);
+    tableInit(&body->locals);
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        stripComment(line);
+        if (!addBodyLine(body, line, body->nbrLines + 1))
+            break; /* error message already printed */
+    }
+    fclose(fp);
+
+    /* the file has been modified since it was cached */
+    if (index != -1)
+    {
+        freeMacro(cache[index].body);
+        cache[index].body = body;
+        cache[index].mtime = info->st_mtim;
+        cache[index].size = info->st_size;
+        return body;
+    }
+
+    /* Resize the cache if necessary to add the new file */
+    if (cacheSize >= cacheCapacity)
+    {
+        int newSize = cacheCapacity == 0 ? 8 : cacheCapacity * 2;
+        CachedFile *newCache = memRealloc(MEM_SOURCE, cache, newSize * sizeof(CachedFile));
+
+        if (newCache == NULL)
+        {
+            printError("%s", ERROR0);
+            freeMacro(body);
+            return NULL;
+        }
+        cache = newCache;
+        cacheCapacity = newSize;
+    }
+
+    if (addLabel(&cachePaths, path, cacheSize) == 0)
+    {
+        freeMacro(body);
+        return NULL; /* error message already printed */
+    }
+    cache[cacheSize].body = body;
+    cache[cacheSize].mtime = info->st_mtim;
+    cache[cacheSize].size = info->st_size;
+    cacheSize++;
+    return body;
+}
+
+static int includedLine(char *path, int fileLine, int including)
+/* Returns a new line nbr for line fileLine of the included file path,
+   * which line including of the source file includes (directly or not);
+   * including itself if memory allocation error.
+   */
+{
+    LineRun *last = nbrRuns > 0 ? &runs[nbrRuns - 1] : NULL;
+
+    /* the next line of the same file continues the last run */
+    if (last != NULL && last->path == path && last->mainLine == including &&
+        last->fileLine + last->count == fileLine)
+    {
+        last->count++;
+        return INCLUDED_LINE + nbrIncludedLines++;
+    }
+
+    /* Resize the runs if necessary to add a new one */
+    if (nbrRuns >= runsCapacity)
+    {
+        int newSize = runsCapacity == 0 ? 8 : runsCapacity * 2;
+        LineRun *newRuns = memRealloc(MEM_SOURCE, runs, newSize * sizeof(LineRun));
+
+        if (newRuns == NULL)
+        {
+            printError("%s", ERROR0);
+            return including;
+        }
+        runs = newRuns;
+        runsCapacity = newSize;
+    }
+
+    runs[nbrRuns].first = INCLUDED_LINE + nbrIncludedLines;
+    runs[nbrRuns].count = 1;
+    runs[nbrRuns].fileLine = fileLine;
+    runs[nbrRuns].path = path;
+    runs[nbrRuns].mainLine = including;
+    nbrRuns++;
+    return INCLUDED_LINE + nbrIncludedLines++;
+}
+
+static LineRun *findRun(int lineNum)
+/* Returns the run that line nbr lineNum is in; NULL if it is a line of
+   * the source file itself.
+   */
+{
+    int low = 0, high = nbrRuns - 1;
+
+    if (lineNum < INCLUDED_LINE)
+        return NULL;
+
+    /* the runs are in the order of their line nbrs */
+    while (low <= high)
+    {
+        int mid = (low + high) / 2;
+
+        if (lineNum < runs[mid].first)
+            high = mid - 1;
+        else if (lineNum >= runs[mid].first + runs[mid].count)
+            low = mid + 1;
+        else
+            return &runs[mid];
+    }
+    return NULL;
+}
+
+static void invokeMacro(Source *src, Macro *macro, char *rest)
+/* Starts expanding macro with the arguments in rest, which are
+   * separated by commas.
+   */
+{
+    int nbrParams = macro->params.nbrLabels;
+    char **args;
+    int nbrArgs = 0;
+    int depth = 0; /* parentheses */
+    char *begin = rest, *str;
+
+    if ((args = memCalloc(MEM_SOURCE, nbrParams + 1, sizeof(char *))) == NULL)
+    {
+        printError("%s", ERROR0);
+        return;
+    }
+
+    for (str = rest;; str++)
+    {
+        if (*str == '(')
+            depth++;
+        else if (*str == ')')
+            depth--;
+        else if ((*str == ',' && depth == 0) || *str == '\0' || *str == '\n')
+        {
+            char *end = str;
+
+            /* trim the argument */
+            while (begin < end && isspace((unsigned char)*begin))
+                begin++;
+            while (end > begin && isspace((unsigned char)end[-1]))
+                end--;
+
+            /* a macro without parameters takes no arguments */
+            if (begin < end || *str == ',' || nbrArgs > 0)
+            {
+                if (nbrArgs < nbrParams && (args[nbrArgs] = copyText(begin, end)) == NULL)
+                    break; /* error message already printed */
+                nbrArgs++;
+            }
+
+            if (*str != ',')
+                break;
+            begin = str + 1;
+        }
+    }
+
+    if (nbrArgs != nbrParams)
+    {
+        printError("Unexpected error on %s: macro %s expects %d arguments.\n",
+                   lineName(src->lineNum), macro->name, nbrParams);
+        nbrArgs = nbrArgs < nbrParams ? nbrArgs : nbrParams;
+        while (nbrArgs > 0)
+            memFree(args[--nbrArgs]);
+        memFree(args);
+        return;
+    }
+
+    pushExpansion(src, macro, args, 1, 0);
+}
+
+static void pushExpansion(Source *src, Macro *body, char **args, int count, int ownsBody)
+/* Starts expanding body count times; src takes ownership of args (and
+   * of body, if ownsBody is 1).
+   */
+{
+    Expansion *exp;
+
+    if (src->depth >= MAX_NESTING)
+    {
+        printError("Unexpected error on %s: macros nested too deeply.\n", lineName(src->lineNum));
+        if (args != NULL)
+        {
+            int i;
+            for (i = 0; i < body->params.nbrLabels; i++)
+                memFree(args[i]);
+            memFree(args);
+        }
+        if (ownsBody)
+            freeMacro(body);
+        return;
+    }
+
+    exp = &src->stack[src->depth++];
+    exp->body = body;
+    exp->args = args;
+    exp->next = 0;
+    exp->remaining = count;
+    exp->id = ++src->nbrExpansions;
+    exp->lineNum = src->lineNum;
+    exp->ownsBody = ownsBody;
+}
+
+static void popExpansion(Source *src)
+/* Postcondition: the innermost expansion has been finished, and its
+   *      memory freed.
+   */
+{
+    Expansion *exp = &src->stack[--src->depth];
+    int i;
+
+    if (exp->args != NULL)
+    {
+        for (i = 0; i < exp->body->params.nbrLabels; i++)
+            memFree(exp->args[i]);
+        memFree(exp->args);
+    }
+
+    if (exp->ownsBody)
+        freeMacro(exp->body);
+}
+
+static void expandLine(Source *src, Expansion *exp, char *out, int size)
+/* Puts the next line of the expansion exp in out, replacing each
+   * parameter (\name) with its argument, and each label defined in the
+   * body with the name it has in this expansion.
+   */
+{
+    char *str = exp->body->lines[exp->next];
+    int len = 0;
+    int inString = 0;
+
+    /* the lines of an included file are used as they are */
+    if (exp->body->isFile)
+    {
+        strncpy(out, str, size - 1);
+        out[size - 1] = '\0';
+        return;
+    }
+
+    while (*str != '\0' && len < size - 1)
+    {
+        char *begin = str;
+        char saved;
+        int index;
+
+        /* copy strings (in double quotes) as they are */
+        if (*str == '"' || inString)
+        {
+            if (*str == '"')
+                inString = !inString;
+            else if (*str == '\\' && str[1] != '\0')
+                out[len++] = *str++;
+            if (len < size - 1)
+                out[len++] = *str++;
+            continue;
+        }
+
+        /* find the end of a name (a parameter, label, register, or
+         * number); any other character is copied as it is
+         */
+        if (*str == '\\')
+            str++;
+        while (isalnum((unsigned char)*str) || *str == '_' || *str == '.' || *str == '$')
+            str++;
+        if (str == begin || (*begin == '\\' && str == begin + 1))
+        {
+            out[len++] = *str++;
+            continue;
+        }
+
+        saved = *str;
+        *str = '\0';
+        if (*begin == '\\' && (index = findLabel(&exp->body->params, begin + 1)) != -1)
+            len += snprintf(out + len, size - len, "%s", exp->args[index]);
+        else if (!isdigit((unsigned char)*begin) && findLabel(&exp->body->locals, begin) != -1)
+            len += snprintf(out + len, size - len, "%s#M%d", begin, exp->id);
+        else
+            len += snprintf(out + len, size - len, "%s", begin);
+        *str = saved;
+    }
+
+    if (len >= size - 1)
+    {
+        printError("Unexpected error on %s: expanded line is too long.\n", lineName(src->lineNum));
+        len = size - 1;
+    }
+    out[len] = '\0';
+}
+
+static char *firstToken(char *line, char **label, char **rest)
+/* Finds the first token in line after the label (if any), and turns
+   * both into strings.  Sets *label to the label, or NULL, and *rest to
+   * the rest of the line after the token, without blanks around it.
+   * Returns the token; NULL if there is none.
+   */
+{
+    char *tokBegin = line, *tokEnd, *end;
+
+    *label = NULL;
+    getToken(&tokBegin, &tokEnd);
+    if (*tokEnd == ':')
+    {
+        *tokEnd = '\0';
+        *label = tokBegin;
+        tokBegin = tokEnd + 1;
+        getToken(&tokBegin, &tokEnd);
+    }
+
+    if (*tokBegin == '\0')
+        return NULL;
+
+    *rest = *tokEnd == '\0' ? tokEnd : tokEnd + 1;
+    *tokEnd = '\0';
+
+    /* drop the blanks around the rest (and the end of line) */
+    while (isspace((unsigned char)**rest))
+        (*rest)++;
+    end = *rest + strlen(*rest);
+    while (end > *rest && isspace((unsigned char)end[-1]))
+        end--;
+    *end = '\0';
+    return tokBegin;
+}
+
+static char *copyText(char *begin, char *end)
+/* Returns a new string holding the characters from begin up to end;
+   * NULL if memory allocation error.
+   */
+{
+    char *copy;
+
+    if ((copy = memAlloc(MEM_SOURCE, end - begin + 1)) == NULL)
+    {
+        printError("%s", ERROR0);
+        return NULL;
+    }
+
+    memcpy(copy, begin, end - begin);
+    copy[end - begin] = '\0';
+    return copy;
+}
+
+static void freeMacro(Macro *macro)
+/* Postcondition: all the memory used by macro has been freed. */
+{
+    int i;
+
+    for (i = 0; i < macro->nbrLines; i++)
+        memFree(macro->lines[i]);
+    memFree(macro->lines);
+    memFree(macro->lineNums);
+    memFree(macro->name);
+    tableFree(&macro->params);
+    tableFree(&macro->locals);
+    memFree(macro);
+}
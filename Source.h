@@ -0,0 +1,145 @@
+/*
+ * Source: data structure and associated functions
+ *
+ * This file provides the data structures and declarations for the
+ * front end of the assembler, which reads the lines of an assembly
+ * source file for pass1.  Comments are stripped off, and included
+ * files (.include), macros (.macro/.endm), and repeated blocks
+ * (.rept/.endr) are expanded before pass1 sees the lines, so that pass1
+ * never has to handle them.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *   Modified:	10/19/2026  Added .include.
+ *   Modified:	10/19/2026  Added includedFile (for --watch).
+ *   Modified:	10/19/2026  Keep the line nbr of each line of a body.
+ *   Modified:	10/19/2026  Added lineName and mainLine.
+ *
+*/
+
+#ifndef SOURCE_H
+#define SOURCE_H
+
+/* The deepest that included files, macro invocations, and .rept blocks
+ * may be nested.
+ */
+#define MAX_NESTING 64
+
+/* THE DATA STRUCTURES */
+
+/* The struct Macro holds the body of a macro or of a .rept block, with
+ * the names of its parameters and of the labels defined in it (which are
+ * renamed in each expansion, so that every expansion has its own).  The
+ * lines of an included file are kept the same way, with no parameters
+ * or local labels.
+ */
+
+typedef struct
+{
+	char *name;		/* macro name (NULL for .rept); path of an
+				   included file */
+	int isFile;		/* 1 for an included file; 0 otherwise */
+	LabelTable params;	/* parameter names, with their index */
+	int capacity;		/* capacity of lines */
+	int nbrLines;		/* actual nbr of lines in the body */
+	char **lines;		/* the body, as written */
+	int *lineNums;		/* the line nbr each line was read as */
+	LabelTable locals;	/* labels defined in the body */
+} Macro;
+
+/* The struct Expansion records where the front end is in the body of
+ * a macro, .rept block, or included file that is being expanded.
+ */
+
+typedef struct
+{
+	Macro *body;	/* the macro or .rept body */
+	char **args;	/* the arguments (one per parameter) */
+	int next;	/* index of the next line of the body */
+	int remaining;	/* nbr of repetitions left, including this one */
+	int id;		/* nbr that makes labels in this expansion unique */
+	int lineNum;	/* line of the invocation (for error messages) */
+	int ownsBody;	/* 1 if body is a .rept block, freed at the end */
+} Expansion;
+
+typedef struct
+{
+	FILE *fp;		/* the source file */
+	char *fileName;		/* its name (NULL for the standard input) */
+	int fileLine;		/* nbr of lines read from the file */
+	int lineNum;		/* line nbr of the last line returned */
+	int depth;		/* nbr of expansions in progress */
+	Expansion stack[MAX_NESTING];
+	LabelTable included;	/* paths of the files included so far */
+	LabelTable macroNames;	/* macro names, with their index in macros */
+	int capacity;		/* capacity of macros */
+	int nbrMacros;		/* actual nbr of macros defined */
+	Macro **macros;
+	int nbrExpansions;	/* expansions so far (for unique labels) */
+} Source;
+
+/* THE FUNCTIONS */
+
+void sourceInit(Source *src, FILE *fp, char *fileName);
+/* Postcondition: src reads its lines from fp, which was opened from
+         *      fileName (NULL for the standard input), and has no macros
+         *      defined or files included.
+         */
+
+int readLine(Source *src, char *line, int size);
+/* Postcondition: line holds the next line of the source, with any
+         *      comment stripped off and macros and .rept blocks
+         *      expanded, and src->lineNum holds its line nbr (for a line
+         *      of a macro expansion, the line of the invocation; a line
+         *      of a .rept block has its own, in every repetition).  The
+         *      lines of included files are given line nbrs past those of
+         *      the source file; see lineName and mainLine.
+         * Returns 1 if a line was read; 0 at the end of the source.
+         */
+
+char *lineName(int lineNum);
+/* Returns the name of line lineNum for messages: "line 12" for a line
+         *      of the source file, "file:3" for line 3 of an included
+         *      file (as long as no other source file has been read since).
+         *      The name is overwritten by the call after next.
+         */
+
+int mainLine(int lineNum);
+/* Returns lineNum for a line of the source file; for a line of an
+         *      included file, the line of the source file that includes
+         *      it (directly or not).
+         */
+
+void stripComment(char *line);
+/* Postcondition: the comment (if any) at the end of line has been
+         *      stripped off.  A '#' inside a string in double quotes does
+         *      not start a comment.
+         */
+
+int writeDependencies(Source *src, char *fileName);
+/* Postcondition: a make rule saying that the output of fileName
+         *      (fileName.out) depends on it and on the files it included
+         *      has been written to fileName.d, with an empty rule for each
+         *      included file (so that make doesn't fail if one is removed).
+         * Returns 1 if everything went OK; 0 if the file can't be written.
+         */
+
+void sourceFree(Source *src);
+/* Postcondition: all the memory used by src (but not its file) has
+         *      been freed.
+         */
+
+char *includedFile(int index);
+/* Returns the path of the index'th file that has been included by any
+         *      source file read so far (and is still in the include
+         *      cache); NULL if index is past the last one.
+         */
+
+void freeIncludeCache(void);
+/* Postcondition: the lines of the included files, which are kept from
+         *      one source file to the next (and read again only if the
+         *      file has been modified), have been freed.
+         */
+
+#endif
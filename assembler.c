@@ -14,13 +14,19 @@
  *              bne $t0, $zero, A_LABEL  # This instr. is at address 8
  *
  * USAGE:
- *      name [ filename ] [ 0|1 ]
- * where "name" is the name of the executable, "filename" is an optional
- * file containing the input to read, and " 0" or "1" specifies that
+ *      name [ -O ] [ -MD ] [ -Idir ] [ --check ] [ filename ... ] [ 0|1 ]
+ * where "name" is the name of the executable, "-O" turns on the
+ * peephole optimizer (see peephole.c), "-MD" writes a make rule
+ * listing the files included by filename to filename.d, "-Idir" adds
+ * dir to the directories searched for .include files (see Source.c),
+ * "--check" only checks the files for errors (the exit code is 1 if
+ * there are any) without writing any output, "filename ..." are optional
+ * files containing the input to read (assembled one after the other),
+ * and " 0" or "1" specifies that
  * debugging should be turned off or on, respectively, regardless of any
- * calls to debug_on, debug_off, or debug_restore in the program.  Both
- * arguments are optional; if both are present they may appear in either
- * order.  If no filename is provided, the program reads its input from
+ * calls to debug_on, debug_off, or debug_restore in the program.  These
+ * arguments are optional, and may appear in any order.  If no filename
+ * is provided, the program reads its input from
  * stdin.  If no debugging choice is provided, the program prints
  * debugging messages, or not, depending on indications in the code.
  *
@@ -53,24 +59,58 @@
  *      Improve function documentation.
  * Modified by:  Maria Katrantzi, 5/25/2019
  *      Turn debugging off, and uncomment part of the code.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Keep the decoded program in memory between pass1 and pass2,
+ *      and run the peephole optimizer on it if -O is given.
+ *      Fill delay slots for code assembled in .set reorder mode.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Assemble (or, with --check, only check) several files in turn.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Time each phase, for --stats and --trace=file.json.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Rewrite branches and jumps whose target is out of range.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Add watch mode (--watch).
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Assemble through the library (libassembler.h), then print the
+ *      machine code.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Read and write in threads of their own (--pipeline).
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Write several output formats in one run (--emit).
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Report the memory used by each subsystem (--mem-stats).
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      A check goes through every pass, and only throws the output away.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Stop at the error limit here, since the library doesn't exit.
  * 
  */
 
-#include "assembler.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "libassembler.h"
+#include "emit.h"
 #include "pass2.h"
+#include "pipeline.h"
+#include "watch.h"
 
-const int SAME = 0; /* useful for making strcmp readable */
-                    /* e.g., if (strcmp (str1, str2) == SAME) */
+/* internal function (visible to this file only)*/
+static void assemble(FILE *fptr);
+static int assembleToFile(int index);
 
 int main(int argc, char *argv[])
 {
     FILE *fptr; /* file pointer */
-    LabelTable table;
+    int nbrFiles, i;
 
-    /* Process command-line arguments (if any) -- input file name
+    /* Process command-line arguments (if any) -- input file names
      *    and/or debugging indicator (1 = on; 0 = off).
      */
+    statsBegin(PHASE_ARGS);
     fptr = process_arguments(argc, argv);
+    statsEnd(PHASE_ARGS);
     if (fptr == NULL)
     {
         return 1; /* Fatal error when processing arguments */
@@ -81,19 +121,185 @@ int main(int argc, char *argv[])
      */
     debug_off(); /* turn debugging off. */
 
-    /* Call pass1 to generate the label table. */
-    table = pass1(fptr);
+    /* A check reports every error, in every file. */
+    if (OPTIONS.check)
+        ERROR_LIMIT = 0;
+
+    /* In watch mode, errors are reported and the assembler waits for
+     * them to be fixed.
+     */
+    if (OPTIONS.watch)
+    {
+        if (OPTIONS.nbrFiles == 0)
+        {
+            printError("Error: --watch needs an input file.\n");
+            return 1;
+        }
+        if (OPTIONS.nbrEmits > 0)
+        {
+            printError("Error: --emit can't be used with --watch.\n");
+            return 1;
+        }
+        (void)fclose(fptr); /* opened again by assembleToFile */
+        ERROR_LIMIT = 0;
+        return watchFiles(OPTIONS.nbrFiles, assembleToFile) ? 0 : 1;
+    }
+
+    /* Open the outputs asked for with --emit (the output of every file
+     * goes to each of them).
+     */
+    if (!OPTIONS.check && !emitOpen())
+        return 1; /* error message already printed */
+
+    /* Assemble each file in turn (stdin if there are none). */
+    nbrFiles = OPTIONS.nbrFiles > 0 ? OPTIONS.nbrFiles : 1;
+    for (i = 0; i < nbrFiles; i++)
+    {
+        /* tell the files apart in error messages */
+        if (nbrFiles > 1)
+            ERROR_PREFIX = OPTIONS.fileNames[i];
+
+        if (i > 0 && (fptr = open_input(i)) == NULL)
+            continue; /* error message already printed */
+
+        assemble(fptr);
 
-    /* Print the label table if debugging is turned on. */
-    if (debug_is_on())
-        printLabels(&table);
+        /* Too many errors: stop, as printError would have. */
+        if (ERROR_LIMIT > 0 && ERROR_COUNT > ERROR_LIMIT)
+            break;
+    }
+
+    freeIncludeCache();
+    emitClose();
+
+    /* Report where the time went, if requested. */
+    if (OPTIONS.stats)
+        statsPrint(stderr);
+    if (OPTIONS.traceFile != NULL)
+        (void)statsWriteTrace(OPTIONS.traceFile);
+    statsFree();
 
-    /* Rewind the file pointer to be back at the beginning
-     * of the file and call pass2 passing it the label table.
+    /* Report the memory used, and what wasn't freed, if requested. */
+    if (OPTIONS.memStats)
+        memPrint(stderr);
+
+    /* A check reports its result in the exit code, as does stopping
+     * at the error limit.
      */
-    rewind(fptr);
-    pass2(fptr, table);
+    if (ERROR_LIMIT > 0 && ERROR_COUNT > ERROR_LIMIT)
+        return 1;
+    return OPTIONS.check && ERROR_COUNT > 0 ? 1 : 0;
+}
+
+static void assemble(FILE *fptr)
+/* Assembles the program in fptr (or, with --check, only checks it for
+   * errors), and closes the file.
+   */
+{
+    Assembler as;
+
+    /* Errors are printed in the order of the lines once the program
+     * has been translated, up to ERROR_LIMIT (main stops once there are
+     * more), and the machine code is printed as it is made.
+     */
+    assemblerInit(&as);
+    as.options = OPTIONS;
+    as.printErrors = 1;
+    as.code.output = printWord;
+
+    /* In pipelined mode, other threads read the source and write the
+     * machine code (see pipeline.c); if the reader can't be started,
+     * the file is read here.
+     */
+    if (OPTIONS.pipeline)
+    {
+        FILE *lines = pipelineOpen(fptr);
 
+        if (lines != NULL)
+            fptr = lines;
+        as.code.output = pipelineWord;
+    }
+
+    /* Each word is encoded once and written in every --emit format. */
+    if (OPTIONS.nbrEmits > 0)
+    {
+        as.code.output = emitWord;
+        emitBegin(OPTIONS.fileName);
+    }
+
+    (void)assembleStream(&as, fptr);
     (void)fclose(fptr);
-    return 0;
-}
\ No newline at end of file
+    if (OPTIONS.nbrEmits > 0 && !OPTIONS.check)
+        emitEnd(&as.symbols);
+
+    /* Write out the machine code that is still buffered. */
+    statsBegin(PHASE_OUTPUT);
+    STATS.bytesWritten += pipelineFinish();
+    (void)fflush(stdout);
+    statsEnd(PHASE_OUTPUT);
+
+    assemblerFree(&as);
+}
+
+static int assembleToFile(int index)
+/* Assembles the input file OPTIONS.fileNames[index] into
+   * filename.out, which is replaced only once the new output is
+   * complete and has no errors (so a program reading it never sees half
+   * of it), and reports the result.
+   * Returns 1 if the file was assembled; 0 otherwise.
+   */
+{
+    char *name = OPTIONS.fileNames[index];
+    int errors = ERROR_COUNT;
+    char *outName, *tmpName;
+    FILE *fptr;
+    int saved, fd;
+
+    ERROR_PREFIX = name;
+    if ((fptr = open_input(index)) == NULL)
+        return 0; /* error message already printed */
+    if ((outName = memAlloc(MEM_OUTPUT, 2 * strlen(name) + 16)) == NULL)
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        (void)fclose(fptr);
+        return 0;
+    }
+    tmpName = outName + strlen(name) + 5;
+    sprintf(outName, "%s.out", name);
+    sprintf(tmpName, "%s.out.tmp", name);
+
+    /* Send the machine code (standard output) to the temporary file. */
+    (void)fflush(stdout);
+    if ((fd = open(tmpName, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0 ||
+        (saved = dup(STDOUT_FILENO)) < 0)
+    {
+        printError("Error: Cannot open file %s.\n", tmpName);
+        if (fd >= 0)
+            (void)close(fd);
+        (void)fclose(fptr);
+        memFree(outName);
+        return 0;
+    }
+    (void)dup2(fd, STDOUT_FILENO);
+    (void)close(fd);
+
+    assemble(fptr);
+
+    (void)fflush(stdout);
+    (void)dup2(saved, STDOUT_FILENO);
+    (void)close(saved);
+
+    /* Keep the last good output if there are errors. */
+    errors = ERROR_COUNT - errors;
+    if (errors == 0 && rename(tmpName, outName) == 0)
+        fprintf(stderr, "%s: assembled into %s.\n", name, outName);
+    else
+    {
+        (void)remove(tmpName);
+        fprintf(stderr, "%s: %d error%s; %s not changed.\n", name, errors,
+                errors == 1 ? "" : "s", outName);
+    }
+
+    memFree(outName);
+    return errors == 0;
+}
@@ -12,13 +12,20 @@
 #include <string.h> /* Might be memory.h on some machines. */
 #include <ctype.h>
 
+#include "mem.h"
 #include "LabelTable.h"
+#include "Program.h"
+#include "CFG.h"
+#include "expr.h"
+#include "Source.h"
 #include "getToken.h"
 #include "printFuncs.h"
 #include "process_arguments.h"
 #include "same.h"
+#include "stats.h"
+#include "trace.h"
 
 int getNTokens(char *instructionBuffer, int N, char *results[]);
-LabelTable pass1(FILE *fp);
+LabelTable pass1(FILE *fp, Program *prog);
 
 #endif
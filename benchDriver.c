@@ -0,0 +1,176 @@
+/*
+ * Benchmark driver: measures the throughput of the assembler on
+ * synthetic programs of several sizes (see benchGen.c), and prints the
+ * results in a machine-readable form (one JSON object per line), so
+ * that they can be tracked from one release to the next.
+ *
+ * Usage:
+ *      benchDriver [-r repeats] [-a assembler] [-s seed] [-l label%]
+ *                  [-b backward%] [-c comment%] [-w width] lines ...
+ *
+ *      -r  nbr of times each program is assembled; the fastest run is
+ *          reported (default 3)
+ *      -a  the assembler to run (default ./assembler)
+ *      The other options are passed on to benchGen (./benchGen).
+ *
+ * For each size, the program is generated to bench_<lines>.mips and
+ * assembled into bench_<lines>.out, which are removed afterward.  The
+ * wall-clock time covers running the assembler as a whole; the peak
+ * resident set size (RSS) is the largest of any of the runs.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/* The most generator options that are passed on. */
+#define MAX_GEN_ARGS 16
+
+/* internal global variables (global to this file only)*/
+static const char *USAGE =
+    "Usage:  %s [-r repeats] [-a assembler] [-s seed] [-l label%%] [-b backward%%]\n"
+    "                [-c comment%%] [-w width] lines ...\n";
+
+/* internal functions (visible to this file only)*/
+static int run(char *argv[], const char *output, struct rusage *usage, double *seconds);
+static long fileSize(const char *fileName);
+
+int main(int argc, char *argv[])
+{
+    char *assembler = "./assembler";
+    char *genArgs[MAX_GEN_ARGS + 4] = {"./benchGen"};
+    int nbrGenArgs = 1;
+    int repeats = 3;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "r:a:s:l:b:c:w:")) != -1)
+    {
+        if (opt == 'r' && (repeats = atoi(optarg)) > 0)
+            continue;
+        if (opt == 'a')
+        {
+            assembler = optarg;
+            continue;
+        }
+        if (opt != '?' && opt != 'r' && nbrGenArgs + 2 <= MAX_GEN_ARGS)
+        {
+            static char flags[MAX_GEN_ARGS][3];
+            sprintf(flags[nbrGenArgs], "-%c", opt);
+            genArgs[nbrGenArgs] = flags[nbrGenArgs];
+            genArgs[nbrGenArgs + 1] = optarg;
+            nbrGenArgs += 2;
+            continue;
+        }
+        fprintf(stderr, USAGE, argv[0]);
+        return 1;
+    }
+    if (optind == argc)
+    {
+        fprintf(stderr, USAGE, argv[0]);
+        return 1;
+    }
+
+    for (i = optind; i < argc; i++)
+    {
+        char source[64], output[64];
+        char *asmArgs[3];
+        long lines = strtol(argv[i], NULL, 10);
+        long maxRSS = 0, inputBytes, outputBytes;
+        double best = -1;
+        int status = 0, r;
+
+        /* Generate the program. */
+        sprintf(source, "bench_%ld.mips", lines);
+        sprintf(output, "bench_%ld.out", lines);
+        genArgs[nbrGenArgs] = "-n";
+        genArgs[nbrGenArgs + 1] = argv[i];
+        genArgs[nbrGenArgs + 2] = NULL;
+        if (run(genArgs, source, NULL, NULL) != 0)
+        {
+            fprintf(stderr, "Error: cannot generate %s.\n", source);
+            return 1;
+        }
+
+        /* Assemble it, keeping the fastest run. */
+        asmArgs[0] = assembler;
+        asmArgs[1] = source;
+        asmArgs[2] = NULL;
+        for (r = 0; r < repeats; r++)
+        {
+            struct rusage usage;
+            double seconds;
+
+            status = run(asmArgs, output, &usage, &seconds);
+            if (best < 0 || seconds < best)
+                best = seconds;
+            if (usage.ru_maxrss > maxRSS)
+                maxRSS = usage.ru_maxrss;
+        }
+        inputBytes = fileSize(source);
+        outputBytes = fileSize(output);
+        (void)remove(source);
+        (void)remove(output);
+
+        printf("{\"lines\":%ld,\"input_bytes\":%ld,\"seconds\":%.6f,"
+               "\"lines_per_sec\":%.0f,\"peak_rss_kb\":%ld,"
+               "\"output_bytes\":%ld,\"output_bytes_per_sec\":%.0f,\"exit\":%d}\n",
+               lines, inputBytes, best, best > 0 ? lines / best : 0.0, maxRSS,
+               outputBytes, best > 0 ? outputBytes / best : 0.0, status);
+        fflush(stdout);
+    }
+
+    return 0;
+}
+
+static int run(char *argv[], const char *output, struct rusage *usage, double *seconds)
+/* Runs the program argv[0] with the arguments in argv, with its
+   * standard output going to the file output.  If usage and seconds are
+   * not NULL, they are set to the resources the program used and the
+   * wall-clock time it took.
+   * Returns the exit status of the program; -1 if it can't be run.
+   */
+{
+    struct timespec start, end;
+    struct rusage ignored;
+    int status;
+    pid_t pid;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if ((pid = fork()) < 0)
+        return -1;
+    if (pid == 0)
+    {
+        int fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || dup2(fd, STDOUT_FILENO) < 0)
+            _exit(127);
+        close(fd);
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    if (wait4(pid, &status, 0, usage != NULL ? usage : &ignored) < 0)
+        return -1;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (seconds != NULL)
+        *seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static long fileSize(const char *fileName)
+/* Returns the size of the file, in bytes; -1 if it doesn't exist. */
+{
+    struct stat info;
+
+    return stat(fileName, &info) == 0 ? (long)info.st_size : -1;
+}
@@ -0,0 +1,208 @@
+/*
+ * Benchmark corpus generator: writes a synthetic MIPS assembly program
+ * of a given size to standard output, for measuring the throughput of
+ * the assembler (see bench.c and "make bench").
+ *
+ * Usage:
+ *      benchGen [-n lines] [-s seed] [-l label%] [-b backward%]
+ *               [-c comment%] [-w width]
+ *
+ *      -n  number of lines to write (default 1000)
+ *      -s  seed; the same seed and options always give the same
+ *          program (default 1)
+ *      -l  percentage of lines that have a label (default 10)
+ *      -b  percentage of branches that go backward rather than
+ *          forward (default 50)
+ *      -c  percentage of lines that have a comment, half of them on a
+ *          line of their own (default 20)
+ *      -w  width to which commented lines are padded (default 40)
+ *
+ * The program uses only instructions the assembler knows, and every
+ * branch goes to a label within BRANCH_WINDOW lines, so that it
+ * assembles without errors at any size.  Whether a line has a label
+ * depends only on its number, so forward branches can name labels that
+ * have not been written yet.  A private random number generator is used
+ * (rather than rand) so that the program is the same on every system.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* How far (in lines) a branch may look for a label. */
+#define BRANCH_WINDOW 256
+
+/* internal global variables (global to this file only)*/
+static const char *USAGE =
+    "Usage:  %s [-n lines] [-s seed] [-l label%%] [-b backward%%] [-c comment%%] [-w width]\n";
+
+static const char *REGISTERS[] =
+    {"$t0", "$t1", "$t2", "$t3", "$t4", "$t5", "$t6", "$t7", "$t8", "$t9",
+     "$s0", "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7", "$a0", "$v0"};
+#define NBR_REGISTERS ((int)(sizeof(REGISTERS) / sizeof(REGISTERS[0])))
+
+static const char *R_NAMES[] = {"add", "addu", "sub", "subu", "and", "or", "nor", "slt", "sltu"};
+static const char *I_NAMES[] = {"addi", "addiu", "slti", "sltiu", "andi", "ori"};
+#define NBR_R_NAMES ((int)(sizeof(R_NAMES) / sizeof(R_NAMES[0])))
+#define NBR_I_NAMES ((int)(sizeof(I_NAMES) / sizeof(I_NAMES[0])))
+
+static unsigned long long state;   /* state of the random number generator */
+static unsigned long long seed;
+static int labelDensity = 10;
+
+/* internal functions (visible to this file only)*/
+static int readOption(const char *arg, long min, long max, long *value);
+static unsigned int next(int bound);
+static int isLabeled(long line, long nbrLines);
+static long findTarget(long line, long nbrLines, int backward);
+static const char *reg(void);
+
+int main(int argc, char *argv[])
+{
+    long nbrLines = 1000, backward = 50, comments = 20, width = 40, s = 1;
+    long labels = 10;
+    long line;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:l:b:c:w:")) != -1)
+    {
+        int ok;
+        switch (opt)
+        {
+        case 'n': ok = readOption(optarg, 1, 1000000000L, &nbrLines); break;
+        case 's': ok = readOption(optarg, 0, 2147483647L, &s); break;
+        case 'l': ok = readOption(optarg, 0, 100, &labels); break;
+        case 'b': ok = readOption(optarg, 0, 100, &backward); break;
+        case 'c': ok = readOption(optarg, 0, 100, &comments); break;
+        case 'w': ok = readOption(optarg, 0, 1000, &width); break;
+        default:  ok = 0; break;
+        }
+        if (!ok)
+        {
+            fprintf(stderr, USAGE, argv[0]);
+            return 1;
+        }
+    }
+    seed = state = (unsigned long long)s * 0x9E3779B97F4A7C15ULL + 1;
+    labelDensity = (int)labels;
+
+    for (line = 0; line < nbrLines; line++)
+    {
+        char text[128];
+        int length = 0;
+        int comment = (int)next(100) < comments;
+
+        if (isLabeled(line, nbrLines))
+            length += printf("L%ld:", line);
+        length += printf("\t");
+
+        /* Half of the comments are on a line of their own. */
+        if (comment && next(2) == 0)
+            text[0] = '\0';
+        else
+        {
+            unsigned int kind = next(100);
+            long target = -1;
+
+            /* 15% branches, 3% jumps, and a mix of the rest */
+            if (kind < 18)
+                target = findTarget(line, nbrLines, (int)next(100) < backward);
+            if (target >= 0 && kind < 15)
+                sprintf(text, "%s %s, %s, L%ld", next(2) ? "beq" : "bne", reg(), reg(), target);
+            else if (target >= 0)
+                sprintf(text, "%s L%ld", next(4) ? "j" : "jal", target);
+            else if (kind < 55)
+                sprintf(text, "%s %s, %s, %s", R_NAMES[next(NBR_R_NAMES)], reg(), reg(), reg());
+            else if (kind < 60)
+                sprintf(text, "%s %s, %s, %u", next(2) ? "sll" : "srl", reg(), reg(), next(32));
+            else if (kind < 80)
+                sprintf(text, "%s %s, %s, %u", I_NAMES[next(NBR_I_NAMES)], reg(), reg(), next(1000));
+            else if (kind < 83)
+                sprintf(text, "lui %s, %u", reg(), next(1000));
+            else if (kind < 98)
+                sprintf(text, "%s %s, %u($sp)", next(3) ? "lw" : "sw", reg(), 4 * next(64));
+            else
+                sprintf(text, "jr $ra");
+        }
+        length += printf("%s", text);
+
+        /* A comment pads the line out to the width. */
+        if (comment)
+        {
+            length += printf("%s#", text[0] == '\0' ? "" : " ");
+            while (length < width)
+                length += printf("%c", 'a' + (int)(length % 26));
+        }
+        printf("\n");
+    }
+
+    return 0;
+}
+
+static int readOption(const char *arg, long min, long max, long *value)
+/* Reads the numeric option value in arg into value.
+   * Returns 1 if it is a number between min and max; 0 otherwise.
+   */
+{
+    char *end;
+    long n = strtol(arg, &end, 10);
+
+    if (end == arg || *end != '\0' || n < min || n > max)
+        return 0;
+    *value = n;
+    return 1;
+}
+
+static unsigned int next(int bound)
+/* Returns the next random number, between 0 and bound - 1 (xorshift64*). */
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return (unsigned int)(((state * 0x2545F4914F6CDD1DULL) >> 32) % (unsigned int)bound);
+}
+
+static int isLabeled(long line, long nbrLines)
+/* Returns 1 if line has a label; 0 otherwise.  This depends only on the
+   * line number and the seed, so that it can be known in advance.  The
+   * first and last lines always have one.
+   */
+{
+    unsigned long long h = (unsigned long long)line * 0xBF58476D1CE4E5B9ULL ^ seed;
+
+    if (line == 0 || line == nbrLines - 1)
+        return 1;
+    h ^= h >> 31;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 29;
+    return (int)(h % 100) < labelDensity;
+}
+
+static long findTarget(long line, long nbrLines, int backward)
+/* Returns the line of the nearest label a random distance (up to
+   * BRANCH_WINDOW lines) before or after line; -1 if there is none.
+   */
+{
+    long step = backward ? -1 : 1;
+    long t = line + step * (1 + (long)next(BRANCH_WINDOW / 2));
+    long limit = line + step * BRANCH_WINDOW;
+
+    for (; t != limit && t >= 0 && t < nbrLines; t += step)
+    {
+        if (isLabeled(t, nbrLines))
+            return t;
+    }
+    return -1;
+}
+
+static const char *reg(void)
+/* Returns the name of a random register. */
+{
+    return REGISTERS[next(NBR_REGISTERS)];
+}
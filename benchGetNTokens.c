@@ -0,0 +1,199 @@
+/*
+ * Microbenchmark for the tokenizer (getToken.c and getNTokens.c), to
+ * give each change to it a baseline to be measured against.  Each
+ * operation is done on every line of a set of representative statements
+ * (labels, comments, and the R, I, J, and memory formats), and reports
+ * the time per line of:
+ *      copy            copying the line into a buffer, which the other
+ *                      operations also do, since they modify the line
+ *      getToken        splitting the whole line into tokens
+ *      getNTokens      skipping the label and opcode, and reading the
+ *                      operands with getNTokens, as pass1 does
+ *
+ * Usage:
+ *      benchGetNTokens [-r repeats] [-n lines]
+ *
+ *      -r  nbr of timed repetitions, after one untimed warm-up
+ *          (default 5); the fastest and the median are reported
+ *      -n  nbr of lines tokenized in each repetition (default 1000000)
+ *
+ * The results are printed one JSON object per line.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <time.h>
+#include <unistd.h>
+#include "assembler.h"
+
+const int SAME = 0; /* useful for making strcmp readable */
+                    /* e.g., if (strcmp (str1, str2) == SAME) */
+
+/* internal global variables (global to this file only)*/
+static const char *USAGE = "Usage:  %s [-r repeats] [-n lines]\n";
+
+/* The statements, with comments already stripped (as pass1 does), and
+ * the nbr of operands of each.
+ */
+static const char *LINES[] =
+    {"main:   lw $a0, 0($t0)",
+     "begin:  addi $t0, $zero, 0",
+     "        addi $t1, $zero, 1",
+     "loop:   slt $t2, $a0, $t1",
+     "        bne $t2, $zero, finish",
+     "        add $t0, $t0, $t1",
+     "        sll $t3, $t0, 2",
+     "        sw $t3, 12($sp)",
+     "        j loop",
+     "finish: add $v0, $t0, $zero",
+     "        lui $at, 4097",
+     "        jr $ra"};
+static const int OPERANDS[] = {3, 3, 3, 3, 3, 3, 3, 3, 1, 3, 2, 1};
+#define NBR_LINES ((int)(sizeof(LINES) / sizeof(LINES[0])))
+
+static long nbrOps = 1000000;
+
+/* The results of the operations are stored here, so that the compiler
+ * can't leave the work out.
+ */
+volatile long benchSink;
+
+/* internal functions (visible to this file only)*/
+static double now(void);
+static int compareTimes(const void *a, const void *b);
+static void report(const char *op, double times[], int repeats);
+static long copyOnly(void);
+static long tokenizeAll(void);
+static long readOperands(void);
+
+int main(int argc, char *argv[])
+{
+    static const char *NAMES[] = {"copy", "getToken", "getNTokens"};
+    long (*const OPS[])(void) = {copyOnly, tokenizeAll, readOperands};
+    double *times;
+    int repeats = 5;
+    int opt, i, r;
+
+    while ((opt = getopt(argc, argv, "r:n:")) != -1)
+    {
+        if (opt == 'r' && (repeats = atoi(optarg)) > 0)
+            continue;
+        if (opt == 'n' && (nbrOps = atol(optarg)) > 0)
+            continue;
+        fprintf(stderr, USAGE, argv[0]);
+        return 1;
+    }
+    if ((times = malloc((repeats + 1) * sizeof(double))) == NULL)
+        return 1;
+
+    for (i = 0; i < 3; i++)
+    {
+        for (r = 0; r <= repeats; r++)
+        {
+            double start = now();
+
+            benchSink = OPS[i]();
+            times[r] = now() - start;
+        }
+        report(NAMES[i], times + 1, repeats);
+    }
+
+    free(times);
+    return 0;
+}
+
+static double now(void)
+/* Returns the time, in seconds, on a clock that only goes forward. */
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static int compareTimes(const void *a, const void *b)
+/* Compares two times, for qsort. */
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *op, double times[], int repeats)
+/* Prints the fastest and the median time per line for op, with nbrOps
+   * lines in each of the repeats times.
+   */
+{
+    qsort(times, repeats, sizeof(double), compareTimes);
+    printf("{\"op\":\"%s\",\"ops\":%ld,\"repeats\":%d,"
+           "\"ns_per_op_min\":%.1f,\"ns_per_op_median\":%.1f}\n",
+           op, nbrOps, repeats, times[0] * 1e9 / nbrOps, times[repeats / 2] * 1e9 / nbrOps);
+    fflush(stdout);
+}
+
+static long copyOnly(void)
+/* Copies nbrOps lines into a buffer.  Returns the nbr of bytes copied. */
+{
+    char buffer[BUFSIZ];
+    long k, bytes = 0;
+
+    for (k = 0; k < nbrOps; k++)
+    {
+        strcpy(buffer, LINES[k % NBR_LINES]);
+        bytes += buffer[0];
+    }
+    return bytes;
+}
+
+static long tokenizeAll(void)
+/* Splits nbrOps lines into tokens with getToken.  Returns the nbr of
+   * tokens found.
+   */
+{
+    char buffer[BUFSIZ];
+    long k, tokens = 0;
+
+    for (k = 0; k < nbrOps; k++)
+    {
+        char *tokBegin = buffer, *tokEnd;
+
+        strcpy(buffer, LINES[k % NBR_LINES]);
+        for (getToken(&tokBegin, &tokEnd); *tokBegin != '\0'; getToken(&tokBegin, &tokEnd))
+        {
+            tokens++;
+            if (*tokEnd == '\0')
+                break;
+            tokBegin = tokEnd + 1;
+        }
+    }
+    return tokens;
+}
+
+static long readOperands(void)
+/* Skips the label and opcode of nbrOps lines with getToken, and reads
+   * their operands with getNTokens.  Returns the nbr of lines whose
+   * operands were read.
+   */
+{
+    char buffer[BUFSIZ];
+    char *operands[4];
+    long k, read = 0;
+
+    for (k = 0; k < nbrOps; k++)
+    {
+        char *tokBegin = buffer, *tokEnd;
+
+        strcpy(buffer, LINES[k % NBR_LINES]);
+        getToken(&tokBegin, &tokEnd);
+        if (*tokEnd == ':')
+        {
+            tokBegin = tokEnd + 1;
+            getToken(&tokBegin, &tokEnd);
+        }
+        *tokEnd = '\0';
+        read += getNTokens(tokEnd + 1, OPERANDS[k % NBR_LINES], operands);
+    }
+    return read;
+}
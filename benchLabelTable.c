@@ -0,0 +1,258 @@
+/*
+ * Microbenchmark for the functions that create and search a label
+ * table (LabelTable.c), to give each change to the table a baseline to
+ * be measured against.  For each table size it reports the time per
+ * operation of:
+ *      addLabel        adding every label to an empty table
+ *      tableResize     doubling the capacity of a full table (and
+ *                      shrinking it back)
+ *      findLabel       looking up labels, hit% of which are in the table
+ *
+ * Usage:
+ *      benchLabelTable [-r repeats] [-h hit%] [-m maxAdd] [size ...]
+ *
+ *      -r  nbr of timed repetitions, after one untimed warm-up
+ *          (default 5); the fastest and the median are reported
+ *      -h  percentage of lookups that find their label (default 90)
+ *      -m  largest table built with addLabel (default 10000); since
+ *          addLabel looks for the label first, building a table takes
+ *          time proportional to the square of its size, so larger
+ *          tables are filled in directly and addLabel is not timed
+ *      sizes default to 1000 10000 100000 1000000
+ *
+ * The labels look like the ones in real programs (loop3, L127,
+ * end_if_42, print_string, ...), and are looked up in random order.
+ * The results are printed one JSON object per line.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <time.h>
+#include <unistd.h>
+#include "assembler.h"
+
+const int SAME = 0; /* useful for making strcmp readable */
+                    /* e.g., if (strcmp (str1, str2) == SAME) */
+
+/* The largest nbr of lookups timed at once. */
+#define MAX_LOOKUPS 1000000
+
+/* internal global variables (global to this file only)*/
+static const char *USAGE =
+    "Usage:  %s [-r repeats] [-h hit%%] [-m maxAdd] [size ...]\n";
+
+static const char *PREFIXES[] =
+    {"L", "loop", "end_if_", "else", "done", "main_loop_", "print_string",
+     "__tmp", "binToDec", "next_"};
+#define NBR_PREFIXES ((int)(sizeof(PREFIXES) / sizeof(PREFIXES[0])))
+
+static unsigned long long state = 88172645463325252ULL; /* for random */
+static char **names;      /* the labels in the table */
+static char **queries;    /* the labels looked up */
+static long nbrQueries;
+static LabelTable table;
+
+/* The results of the lookups are stored here, so that the compiler
+ * can't leave them out.
+ */
+volatile long benchSink;
+
+/* internal functions (visible to this file only)*/
+static char *makeName(long i, int missing);
+static unsigned long next(unsigned long bound);
+static double now(void);
+static int compareTimes(const void *a, const void *b);
+static void report(const char *op, long size, long ops, double times[], int repeats);
+static void addAll(long size);
+static void fillDirectly(long size);
+static void resizeTwice(long size);
+static void findAll(void);
+
+int main(int argc, char *argv[])
+{
+    static const long DEFAULT_SIZES[] = {1000, 10000, 100000, 1000000};
+    long maxAdd = 10000;
+    int repeats = 5, hits = 90;
+    int opt, i, r;
+
+    while ((opt = getopt(argc, argv, "r:h:m:")) != -1)
+    {
+        if (opt == 'r' && (repeats = atoi(optarg)) > 0)
+            continue;
+        if (opt == 'h' && (hits = atoi(optarg)) >= 0 && hits <= 100)
+            continue;
+        if (opt == 'm' && (maxAdd = atol(optarg)) >= 0)
+            continue;
+        fprintf(stderr, USAGE, argv[0]);
+        return 1;
+    }
+
+    for (i = 0; i < (optind < argc ? argc - optind : 4); i++)
+    {
+        long size = optind < argc ? atol(argv[optind + i]) : DEFAULT_SIZES[i];
+        double *times;
+        long k;
+
+        if (size <= 0 || (times = malloc((repeats + 1) * sizeof(double))) == NULL ||
+            (names = malloc(size * sizeof(char *))) == NULL)
+        {
+            fprintf(stderr, USAGE, argv[0]);
+            return 1;
+        }
+        for (k = 0; k < size; k++)
+            names[k] = makeName(k, 0);
+
+        /* addLabel, from an empty table each time */
+        if (size <= maxAdd)
+        {
+            for (r = 0; r <= repeats; r++)
+            {
+                double start;
+
+                tableInit(&table);
+                start = now();
+                addAll(size);
+                times[r] = now() - start;
+                tableFree(&table);
+            }
+            report("addLabel", size, size, times + 1, repeats);
+        }
+
+        /* tableResize, on a full table */
+        fillDirectly(size);
+        for (r = 0; r <= repeats; r++)
+        {
+            double start = now();
+            resizeTwice(size);
+            times[r] = now() - start;
+        }
+        report("tableResize", size, 2, times + 1, repeats);
+
+        /* findLabel: as many lookups as keep each repetition short */
+        nbrQueries = 200000000L / size;
+        nbrQueries = nbrQueries < 100 ? 100 : nbrQueries > MAX_LOOKUPS ? MAX_LOOKUPS : nbrQueries;
+        if ((queries = malloc(nbrQueries * sizeof(char *))) == NULL)
+            return 1;
+        for (k = 0; k < nbrQueries; k++)
+        {
+            if ((long)next(100) < hits)
+                queries[k] = names[next(size)];
+            else
+                queries[k] = makeName(k, 1);
+        }
+        for (r = 0; r <= repeats; r++)
+        {
+            double start = now();
+            findAll();
+            times[r] = now() - start;
+        }
+        report(hits == 100 ? "findLabel(hit)" : hits == 0 ? "findLabel(miss)" : "findLabel(mix)",
+               size, nbrQueries, times + 1, repeats);
+
+        for (k = 0; k < nbrQueries; k++)
+            if (queries[k][0] == '!')
+                free(queries[k]);
+        free(queries);
+        tableFree(&table);
+        for (k = 0; k < size; k++)
+            free(names[k]);
+        free(names);
+        free(times);
+    }
+
+    return 0;
+}
+
+static char *makeName(long i, int missing)
+/* Returns a new label name, unique to i.  Names that are missing from
+   * the table start with '!', which no label can.
+   */
+{
+    char buffer[64];
+
+    sprintf(buffer, "%s%s%ld", missing ? "!" : "", PREFIXES[i % NBR_PREFIXES], i / NBR_PREFIXES);
+    return strdup(buffer);
+}
+
+static unsigned long next(unsigned long bound)
+/* Returns the next random number, between 0 and bound - 1 (xorshift64). */
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (unsigned long)(state % bound);
+}
+
+static double now(void)
+/* Returns the time, in seconds, on a clock that only goes forward. */
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static int compareTimes(const void *a, const void *b)
+/* Compares two times, for qsort. */
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *op, long size, long ops, double times[], int repeats)
+/* Prints the fastest and the median time per operation for op on a
+   * table of size labels, with ops operations in each of the repeats
+   * times.
+   */
+{
+    qsort(times, repeats, sizeof(double), compareTimes);
+    printf("{\"op\":\"%s\",\"size\":%ld,\"ops\":%ld,\"repeats\":%d,"
+           "\"ns_per_op_min\":%.1f,\"ns_per_op_median\":%.1f}\n",
+           op, size, ops, repeats, times[0] * 1e9 / ops, times[repeats / 2] * 1e9 / ops);
+    fflush(stdout);
+}
+
+static void addAll(long size)
+/* Adds the first size names to the table. */
+{
+    long k;
+
+    for (k = 0; k < size; k++)
+        (void)addLabel(&table, names[k], (int)(4 * k));
+}
+
+static void fillDirectly(long size)
+/* Fills the table with the first size names without looking for
+   * duplicates.
+   */
+{
+    long k;
+
+    tableInit(&table);
+    (void)tableResize(&table, (int)size);
+    for (k = 0; k < size; k++)
+    {
+        table.entries[k].label = memStrdup(MEM_LABELS, names[k]);
+        table.entries[k].address = (int)(4 * k);
+    }
+    table.nbrLabels = (int)size;
+}
+
+static void resizeTwice(long size)
+/* Doubles the capacity of the full table, then shrinks it back. */
+{
+    (void)tableResize(&table, (int)(2 * size));
+    (void)tableResize(&table, (int)size);
+}
+
+static void findAll(void)
+/* Looks up every query in the table. */
+{
+    long k;
+
+    for (k = 0; k < nbrQueries; k++)
+        benchSink = findLabel(&table, queries[k]);
+}
@@ -0,0 +1,299 @@
+/*
+ * This file contains the reading of compressed source files (see
+ * decompress.h).  The first bytes of the file are read to tell how it
+ * is compressed; if it is, a stream (fopencookie) is returned whose read
+ * function decompresses the next buffer of the file each time it runs
+ * out, starting with the bytes already read.  zlib's memory is counted
+ * as the source's (see mem.h).
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#define _GNU_SOURCE /* for fopencookie */
+
+#include <limits.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "assembler.h"
+#include "decompress.h"
+
+/* The magic numbers that compressed files start with. */
+static const unsigned char GZIP_MAGIC[] = {0x1f, 0x8b};
+static const unsigned char ZSTD_MAGIC[] = {0x28, 0xb5, 0x2f, 0xfd};
+#define MAGIC_SIZE 4
+
+typedef enum {PLAIN, GZIP, ZSTD} Compression;
+
+/* The struct Decompressor holds the state of a stream that decompresses
+ * a file: the bytes read from the file that haven't been decompressed
+ * yet, and the decompressor.
+ */
+typedef struct
+{
+    FILE *fp;               /* the compressed file */
+    char *fileName;         /* its name, for error messages */
+    Compression compression;
+    unsigned char in[BUFSIZ];
+    size_t inLength;        /* nbr of bytes in in */
+    size_t inPos;           /* nbr of them decompressed */
+    int inFrame;            /* 1 if in the middle of a gzip member or zstd
+                               frame (so the file can't end here) */
+    int failed;             /* 1 once an error has been reported */
+    z_stream z;
+#ifdef HAVE_ZSTD
+    ZSTD_DStream *zstd;
+#endif
+} Decompressor;
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+
+/* internal functions (visible to this file only)*/
+static ssize_t readDecompressed(void *cookie, char *buf, size_t size);
+static int closeDecompressed(void *cookie);
+static int fill(Decompressor *d);
+static size_t decode(Decompressor *d, char *buf, size_t size);
+static void fail(Decompressor *d, const char *problem);
+static void freeDecompressor(Decompressor *d);
+static voidpf zAlloc(voidpf opaque, uInt items, uInt size);
+static void zFree(voidpf opaque, voidpf address);
+
+FILE *decompressOpen(FILE *fp, const char *fileName)
+/* Takes an open file, named fileName (NULL for the standard input),
+   * and reads its magic number.
+   * Returns a stream from which its lines can be read, as from fp: fp
+   * itself if it is not compressed, or else a stream that decompresses
+   * it (closing the stream also closes fp); NULL if it is compressed in
+   * a way that can't be read, or memory allocation error (an error
+   * message is printed, and fp is closed).
+   */
+{
+    cookie_io_functions_t functions = {readDecompressed, NULL, NULL, closeDecompressed};
+    unsigned char magic[MAGIC_SIZE];
+    size_t n = fread(magic, 1, MAGIC_SIZE, fp);
+    Compression compression = PLAIN;
+    Decompressor *d;
+    FILE *stream;
+
+    if (fileName == NULL)
+        fileName = "the standard input";
+    if (n >= sizeof(GZIP_MAGIC) && memcmp(magic, GZIP_MAGIC, sizeof(GZIP_MAGIC)) == SAME)
+        compression = GZIP;
+    else if (n >= sizeof(ZSTD_MAGIC) && memcmp(magic, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)) == SAME)
+        compression = ZSTD;
+
+    /* A file that isn't compressed is read again from the start (or, if
+     * it can't be, e.g., a pipe, through a stream that gives back the
+     * bytes read first)
+     */
+    if (compression == PLAIN && fseek(fp, 0, SEEK_SET) == 0)
+        return fp;
+#ifndef HAVE_ZSTD
+    if (compression == ZSTD)
+    {
+        printError("Error: %s is compressed with zstd; build the assembler with "
+                   "\"make ZSTD=1\" to read it.\n", fileName);
+        (void)fclose(fp);
+        return NULL;
+    }
+#endif
+
+    if ((d = memCalloc(MEM_SOURCE, 1, sizeof(Decompressor))) == NULL ||
+        (d->fileName = memStrdup(MEM_SOURCE, fileName)) == NULL)
+    {
+        printError("%s", ERROR0);
+        memFree(d);
+        (void)fclose(fp);
+        return NULL;
+    }
+    d->fp = fp;
+    d->compression = compression;
+    memcpy(d->in, magic, n);
+    d->inLength = n;
+
+    /* Start the decompressor, and the stream that reads from it */
+    if (compression == GZIP)
+    {
+        d->z.zalloc = zAlloc;
+        d->z.zfree = zFree;
+        d->z.opaque = Z_NULL;
+        if (inflateInit2(&d->z, 15 + 16) != Z_OK) /* 15-bit window, gzip header */
+            d->compression = PLAIN;                /* nothing to end */
+    }
+#ifdef HAVE_ZSTD
+    else if (compression == ZSTD)
+    {
+        if ((d->zstd = ZSTD_createDStream()) != NULL && ZSTD_isError(ZSTD_initDStream(d->zstd)))
+        {
+            ZSTD_freeDStream(d->zstd);
+            d->zstd = NULL;
+        }
+        if (d->zstd == NULL)
+            d->compression = PLAIN;
+    }
+#endif
+    if (d->compression != compression || (stream = fopencookie(d, "r", functions)) == NULL)
+    {
+        printError("%s", ERROR0);
+        (void)fclose(fp);
+        freeDecompressor(d);
+        return NULL;
+    }
+
+    return stream;
+}
+
+static ssize_t readDecompressed(void *cookie, char *buf, size_t size)
+/* Decompresses the next bytes of the file of the Decompressor cookie
+   * into buf, which has room for size bytes (the read function of the
+   * stream).
+   * Returns the nbr of bytes, 0 at the end of the file; -1 if the file
+   * can't be read or decompressed (an error message is printed).
+   */
+{
+    Decompressor *d = cookie;
+    size_t n = 0;
+
+    while (n == 0 && !d->failed)
+    {
+        if (d->inPos == d->inLength && !fill(d))
+        {
+            if (d->inFrame && !d->failed)
+                fail(d, "ends in the middle of the compressed data");
+            break; /* the end of the file */
+        }
+        n = decode(d, buf, size);
+    }
+
+    return n > 0 || !d->failed ? (ssize_t)n : -1;
+}
+
+static int closeDecompressed(void *cookie)
+/* Postcondition: the Decompressor cookie, and its file, have been
+   *      closed (the close function of the stream).
+   * Returns 0 if the file was closed; EOF otherwise.
+   */
+{
+    Decompressor *d = cookie;
+    int status = fclose(d->fp);
+
+    freeDecompressor(d);
+    return status;
+}
+
+static int fill(Decompressor *d)
+/* Postcondition: the next bytes of the file of d have been read into
+   *      its input buffer.
+   * Returns 1 if there were any; 0 at the end of the file or if it
+   *      can't be read (an error message is printed).
+   */
+{
+    d->inLength = fread(d->in, 1, sizeof(d->in), d->fp);
+    d->inPos = 0;
+    if (d->inLength == 0 && ferror(d->fp))
+        fail(d, "can't be read");
+
+    return d->inLength > 0;
+}
+
+static size_t decode(Decompressor *d, char *buf, size_t size)
+/* Decompresses what it can of the input buffer of d into buf, which
+   * has room for size bytes (the rest of the input is kept for later).
+   * Returns the nbr of bytes put in buf (0 if the input buffer only had
+   * the start of something).
+   */
+{
+    size_t n;
+    int status;
+
+    switch (d->compression)
+    {
+    case GZIP:
+        d->z.next_in = d->in + d->inPos;
+        d->z.avail_in = (uInt)(d->inLength - d->inPos);
+        d->z.next_out = (Bytef *)buf;
+        d->z.avail_out = size > UINT_MAX ? UINT_MAX : (uInt)size;
+        status = inflate(&d->z, Z_NO_FLUSH);
+        d->inPos = d->inLength - d->z.avail_in;
+        n = (size_t)((char *)d->z.next_out - buf);
+
+        /* another member may follow the one that ended */
+        if (status == Z_STREAM_END)
+        {
+            d->inFrame = 0;
+            (void)inflateReset(&d->z);
+        }
+        else if (status == Z_OK || status == Z_BUF_ERROR)
+            d->inFrame = 1;
+        else
+            fail(d, "is not valid gzip data");
+        return n;
+
+#ifdef HAVE_ZSTD
+    case ZSTD:
+    {
+        ZSTD_inBuffer input = {d->in, d->inLength, d->inPos};
+        ZSTD_outBuffer output = {buf, size, 0};
+        size_t left = ZSTD_decompressStream(d->zstd, &output, &input);
+
+        /* what is left of the frame is 0 once it is all written out */
+        d->inPos = input.pos;
+        if (ZSTD_isError(left))
+            fail(d, "is not valid zstd data");
+        else
+            d->inFrame = left != 0;
+        return output.pos;
+    }
+#endif
+
+    default: /* not compressed, but its first bytes were read */
+        n = d->inLength - d->inPos < size ? d->inLength - d->inPos : size;
+        memcpy(buf, d->in + d->inPos, n);
+        d->inPos += n;
+        return n;
+    }
+}
+
+static void fail(Decompressor *d, const char *problem)
+/* Postcondition: the problem with the file of d has been reported,
+   *      and nothing more is read from it.
+   */
+{
+    printError("Error: %s %s.\n", d->fileName, problem);
+    d->failed = 1;
+}
+
+static void freeDecompressor(Decompressor *d)
+/* Postcondition: all the memory used by d has been freed (but its file
+   *      is left open).
+   */
+{
+    if (d->compression == GZIP)
+        (void)inflateEnd(&d->z);
+#ifdef HAVE_ZSTD
+    if (d->compression == ZSTD)
+        ZSTD_freeDStream(d->zstd);
+#endif
+    memFree(d->fileName);
+    memFree(d);
+}
+
+static voidpf zAlloc(voidpf opaque, uInt items, uInt size)
+/* Returns memory for zlib: items items of size bytes each. */
+{
+    (void)opaque;
+    return memCalloc(MEM_SOURCE, items, size);
+}
+
+static void zFree(voidpf opaque, voidpf address)
+/* Postcondition: the memory at address, from zAlloc, has been freed. */
+{
+    (void)opaque;
+    memFree(address);
+}
@@ -0,0 +1,39 @@
+/*
+ * Decompress: reading compressed source files
+ *
+ * This file provides the declaration for reading a source file that
+ * is compressed as if it were not, without a temporary file.  The
+ * compression is told from the first bytes of the file (its magic
+ * number), not from its name:
+ *      gzip    1f 8b           (with zlib)
+ *      zstd    28 b5 2f fd     (with libzstd, if the assembler was
+ *                               built with "make ZSTD=1")
+ * The file is decompressed as it is read, a buffer at a time, through a
+ * stream (fopencookie), so the lexer reads its lines as it reads those
+ * of any file.  Several gzip members (or zstd frames) one after the
+ * other are read as one file, as gunzip does.  A file that is not
+ * compressed is read as it is.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef DECOMPRESS_H
+#define DECOMPRESS_H
+
+#include <stdio.h>
+
+FILE *decompressOpen(FILE *fp, const char *fileName);
+/* Takes an open file, named fileName (NULL for the standard input),
+		 * and reads its magic number.
+		 * Returns a stream from which its lines can be read, as from
+		 * fp: fp itself if it is not compressed, or else a stream that
+		 * decompresses it (closing the stream also closes fp); NULL if
+		 * it is compressed in a way that can't be read, or memory
+		 * allocation error (an error message is printed, and fp is
+		 * closed).
+		 */
+
+#endif
@@ -0,0 +1,545 @@
+/*
+ * This file contains the functions that pass1 uses to process the
+ * directives (tokens starting with '.') and labels in an assembly
+ * source file.  The source is split into a text segment, which holds
+ * the instructions and starts at address 0, and a data segment, which
+ * starts at DATA_BASE; each has its own location counter.
+ *      .text            the lines that follow go in the text segment
+ *                       (default)
+ *      .data            the lines that follow go in the data segment
+ *      .word  v, ...    32-bit values, aligned to a multiple of 4
+ *      .half  v, ...    16-bit values, aligned to a multiple of 2
+ *      .byte  v, ...    8-bit values
+ *      .space n         n zero bytes
+ *      .ascii  "s", ... strings
+ *      .asciiz "s", ... strings, each followed by a null byte
+ *      .align n         aligns the current segment to a multiple of
+ *                       2 to the n (with zero bytes in the data segment
+ *                       and nops in the text segment)
+ *      .set reorder     the assembler fills the delay slots of the
+ *                       branches and jumps that follow
+ *      .set noreorder   the source fills its own delay slots (default)
+ *      .equ name, v     name stands for the value v wherever it is used
+ *      .set name, v     the same as .equ
+ * The values (and n) are expressions (see expr.h); the values of .word,
+ * .half, and .byte may use labels, whose addresses are filled in by
+ * pass2, and constants defined later, but n must only use numbers and
+ * the constants defined before it.  A name can only be defined once.
+ * A label on a line by itself, or on a directive that does not add any
+ * data, marks the current address in the current segment.  A label on a
+ * data directive marks its first item (after alignment).
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <limits.h>
+
+#include "assembler.h"
+#include "pass1.h"
+#include "pass2.h"
+
+/* Each directive is processed by a function that takes its operands,
+ * line number, label, the assembler state, and the arg from the table.
+ */
+typedef struct
+{
+    char *name;   /* directive name, e.g., ".word" */
+    int dataOnly; /* 1 if only allowed in the data segment */
+    int arg;      /* item size (.word, .half, .byte); null byte (.asciiz) */
+    void (*process)(char *rest, int lineNum, char **label, Pass1State *state, int arg);
+} Directive;
+
+static void setSection(char *rest, int lineNum, char **label, Pass1State *state, int arg);
+static void setOption(char *rest, int lineNum, char **label, Pass1State *state, int arg);
+static void defineConstant(char *rest, int lineNum, char **label, Pass1State *state, int arg);
+static void align(char *rest, int lineNum, char **label, Pass1State *state, int arg);
+static void dataValues(char *rest, int lineNum, char **label, Pass1State *state, int arg);
+static void space(char *rest, int lineNum, char **label, Pass1State *state, int arg);
+static void dataStrings(char *rest, int lineNum, char **label, Pass1State *state, int arg);
+
+static Directive directives[] =
+    {
+        {".text", 0, 0, setSection},
+        {".data", 0, 1, setSection},
+        {".set", 0, 0, setOption},
+        {".equ", 0, 0, defineConstant},
+        {".align", 0, 0, align},
+        {".word", 1, 4, dataValues},
+        {".half", 1, 2, dataValues},
+        {".byte", 1, 1, dataValues},
+        {".space", 1, 0, space},
+        {".ascii", 1, 0, dataStrings},
+        {".asciiz", 1, 1, dataStrings}};
+
+static const int NBR_DIRECTIVES = sizeof(directives) / sizeof(directives[0]);
+
+/* internal functions (visible to this file only)*/
+static void defineHere(char **label, Pass1State *state, int lineNum);
+static int readConstant(char *rest, Pass1State *state, int lineNum, char *directive, long *value);
+static char *trim(char *str);
+static char *readString(char *str, int lineNum, DataSegment *data);
+
+void processDirective(char *name, char *rest, int lineNum, char **label,
+                      Pass1State *state)
+/* Processes the directive name, whose operands are in rest, and
+   * updates the state accordingly.  Prints an error message if the
+   * directive or its operands are invalid.
+   */
+{
+    int i;
+
+    for (i = 0; i < NBR_DIRECTIVES; i++)
+    {
+        if (strcmp(name, directives[i].name) != SAME)
+            continue;
+
+        if (directives[i].dataOnly && !state->inData)
+        {
+            printError("Unexpected error on %s: %s directive outside of the data segment.\n",
+                       lineName(lineNum), name);
+            return;
+        }
+
+        directives[i].process(rest, lineNum, label, state, directives[i].arg);
+        return;
+    }
+
+    printError("Unexpected error on %s: %s is an invalid Directive.\n", lineName(lineNum), name);
+}
+
+int defineLabel(Pass1State *state, char *label, int lineNum)
+/* Postcondition: label has been added to the label table with the
+   *      current address in the current segment, and to the program
+   *      (text labels) or its data segment (data labels).  A duplicate
+   *      label is reported and otherwise ignored.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    DataSegment *data = &state->prog->data;
+    Instruction instr;
+    int before = state->table->nbrLabels;
+    int address = state->inData ? DATA_BASE + data->size : state->PC;
+
+    TRACE(TRACE_LABELS, 1, "%s: %s defined at 0x%x.\n", lineName(lineNum), label, address);
+
+    if (findEquate(state->prog, label) != NULL)
+    {
+        printError("Unexpected error on %s: %s is already defined.\n", lineName(lineNum), label);
+        return 1;
+    }
+
+    /* A duplicate label is reported by addLabel (which leaves the
+     * table as it was), and is not kept with the program.  It is about
+     * no line, so it comes before the errors in the statements, as when
+     * the labels were collected in a pass of their own.
+     */
+    ERROR_LINE = 0;
+    if (addLabel(state->table, label, address) == 0)
+    {
+        ERROR_LINE = lineNum;
+        return 0; /* error message already printed */
+    }
+    ERROR_LINE = lineNum;
+    if (state->table->nbrLabels == before)
+        return 1;
+
+    /* data labels don't move when the text segment is laid out again */
+    if (state->inData)
+        return addLabel(&data->labels, label, address);
+
+    /* a text label marks the statement that follows it */
+    memset(&instr, 0, sizeof(instr));
+    instr.lineNum = lineNum;
+    instr.address = address;
+    instr.reorder = state->reorder;
+    if ((instr.label = memStrdup(MEM_PROGRAM, label)) == NULL)
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return 0;
+    }
+
+    return addInstruction(state->prog, &instr);
+}
+
+static void setSection(char *rest, int lineNum, char **label, Pass1State *state, int arg)
+/* Processes .text (arg is 0) and .data (arg is 1). */
+{
+    char *tokBegin = rest, *tokEnd;
+
+    (void)label; /* marks the start of the new segment */
+
+    getToken(&tokBegin, &tokEnd);
+    if (*tokBegin != '\0')
+    {
+        printError("Unexpected error on %s: Directive contains more tokens than expected.\n", lineName(lineNum));
+        return;
+    }
+
+    state->inData = arg;
+}
+
+static void setOption(char *rest, int lineNum, char **label, Pass1State *state, int arg)
+/* Processes .set reorder and .set noreorder, and .set name, value
+   * (the same as .equ).
+   */
+{
+    char *parameters[1];
+
+    if (strchr(rest, ',') != NULL)
+    {
+        defineConstant(rest, lineNum, label, state, arg);
+        return;
+    }
+
+    (void)label;
+    (void)arg;
+
+    if (getNTokens(rest, 1, parameters) == 0)
+    {
+        /* parameters[0] contains error message */
+        printError("Unexpected error on %s: %s\n", lineName(lineNum), parameters[0]);
+    }
+    else if (strcmp(parameters[0], "reorder") == SAME)
+        state->reorder = 1;
+    else if (strcmp(parameters[0], "noreorder") == SAME)
+        state->reorder = 0;
+    else
+        printError("Unexpected error on %s: invalid option %s for .set directive.\n",
+                   lineName(lineNum), parameters[0]);
+}
+
+static void defineConstant(char *rest, int lineNum, char **label, Pass1State *state, int arg)
+/* Processes .equ name, value (and .set name, value): name stands for
+   * the value of the expression value wherever it is used.  The
+   * expression is kept, and evaluated when the constant is used.
+   */
+{
+    char *tokBegin = rest, *tokEnd, *value;
+    char undefined[BUFSIZ];
+    char delimiter;
+    long result;
+    int status;
+
+    (void)label; /* marks the current address */
+    (void)arg;
+
+    getToken(&tokBegin, &tokEnd);
+    if (*tokBegin == '\0' || *tokEnd == '\0')
+    {
+        printError("Unexpected error on %s: Directive contains fewer tokens than expected.\n", lineName(lineNum));
+        return;
+    }
+
+    /* Turn the name into a string; the value comes after the comma */
+    delimiter = *tokEnd;
+    *tokEnd = '\0';
+    value = trim(tokEnd + 1);
+    if (delimiter != ',' && *value == ',')
+        value = trim(value + 1);
+    if (*value == '\0')
+    {
+        printError("Unexpected error on %s: Directive contains fewer tokens than expected.\n", lineName(lineNum));
+        return;
+    }
+
+    if (!isName(tokBegin))
+    {
+        printError("Unexpected error on %s: invalid token %s for .equ directive.\n",
+                   lineName(lineNum), tokBegin);
+        return;
+    }
+    if (findEquate(state->prog, tokBegin) != NULL || findLabel(state->table, tokBegin) != -1)
+    {
+        printError("Unexpected error on %s: %s is already defined.\n", lineName(lineNum), tokBegin);
+        return;
+    }
+
+    /* the names in it may be defined later */
+    status = evaluateIn(state->prog, NULL, value, &result, undefined, sizeof(undefined));
+    if (status != EXPR_OK && status != EXPR_UNDEFINED)
+    {
+        expressionError(status, value, undefined, ".equ directive", lineNum);
+        return;
+    }
+
+    TRACE(TRACE_LABELS, 1, "%s: %s defined as %s.\n", lineName(lineNum), tokBegin, value);
+    (void)addEquate(state->prog, tokBegin, value, lineNum); /* error message printed */
+}
+
+static void align(char *rest, int lineNum, char **label, Pass1State *state, int arg)
+/* Processes .align n, in either segment. */
+{
+    Instruction instr;
+    long n;
+
+    (void)arg;
+
+    if (!readConstant(rest, state, lineNum, ".align", &n))
+        return; /* error message already printed */
+    if (n < 0 || n > MAX_ALIGN)
+    {
+        printError("Unexpected error on %s: invalid token %s for .align directive.\n",
+                   lineName(lineNum), rest);
+        return;
+    }
+
+    if (state->inData)
+    {
+        if (!alignData(&state->prog->data, 1 << n))
+            return; /* error message already printed */
+    }
+    else if (n > 0)
+    {
+        /* The padding is worked out again whenever the text segment is
+         * laid out, since the optimizer may move the instructions.
+         */
+        memset(&instr, 0, sizeof(instr));
+        instr.lineNum = lineNum;
+        instr.address = state->PC;
+        instr.reorder = state->reorder;
+        instr.align = (int)n;
+        instr.padding = alignUp(state->PC, 1 << n) - state->PC;
+        if (!addInstruction(state->prog, &instr))
+            return; /* error message already printed */
+        state->PC += instr.padding;
+    }
+
+    /* the label marks the aligned address */
+    defineHere(label, state, lineNum);
+}
+
+static void dataValues(char *rest, int lineNum, char **label, Pass1State *state, int arg)
+/* Processes .word, .half, and .byte, whose items are arg bytes each:
+   * expressions, separated by commas.  An item that uses a label (or a
+   * constant not defined yet) is filled in by pass2.  Nothing is added
+   * if an item has an error.
+   */
+{
+    DataSegment *data = &state->prog->data;
+    char undefined[BUFSIZ];
+    char *item = rest, *next;
+    long min = -(1L << (8 * arg - 1));   /* smallest signed value */
+    long max = (1L << (8 * arg)) - 1;    /* largest unsigned value */
+    long value;
+    int status, start;
+
+    if (!alignData(data, arg))
+        return; /* error message already printed */
+    defineHere(label, state, lineNum);
+    start = data->size;
+
+    for (; item != NULL; item = next)
+    {
+        int depth = 0; /* of parentheses */
+
+        /* Turn the item into a string, up to the comma that ends it */
+        for (next = item; *next != '\0' && (*next != ',' || depth > 0); next++)
+            depth += (*next == '(') - (*next == ')');
+        if (*next == ',')
+            *next++ = '\0';
+        else
+            next = NULL;
+
+        if (*(item = trim(item)) == '\0')
+        {
+            printError("Unexpected error on %s: Directive contains fewer tokens than expected.\n", lineName(lineNum));
+            truncateData(data, start);
+            return;
+        }
+
+        status = evaluateIn(state->prog, NULL, item, &value, undefined, sizeof(undefined));
+        if (status == EXPR_UNDEFINED)
+        {
+            /* the value is filled in by pass2 */
+            if (!addFixup(data, item, arg, lineNum))
+                return; /* error message already printed */
+        }
+        else if (status == EXPR_OK && value >= min && value <= max)
+        {
+            if (!addData(data, (int)value, arg))
+                return; /* error message already printed */
+        }
+        else
+        {
+            expressionError(status == EXPR_OK ? EXPR_INVALID : status, item, undefined,
+                            "data directive", lineNum);
+            truncateData(data, start);
+            return;
+        }
+    }
+}
+
+static void space(char *rest, int lineNum, char **label, Pass1State *state, int arg)
+/* Processes .space n. */
+{
+    long n;
+
+    (void)arg;
+
+    if (!readConstant(rest, state, lineNum, ".space", &n))
+        return; /* error message already printed */
+    if (n < 0 || n > INT_MAX - state->prog->data.size)
+    {
+        printError("Unexpected error on %s: invalid token %s for .space directive.\n",
+                   lineName(lineNum), rest);
+        return;
+    }
+
+    defineHere(label, state, lineNum);
+    while (n-- > 0)
+    {
+        if (!addData(&state->prog->data, 0, 1))
+            return; /* error message already printed */
+    }
+}
+
+static void dataStrings(char *rest, int lineNum, char **label, Pass1State *state, int arg)
+/* Processes .ascii (arg is 0) and .asciiz (arg is 1): one or more
+   * strings in double quotes, separated by commas.  Nothing is added if
+   * a string has an error.
+   */
+{
+    DataSegment *data = &state->prog->data;
+    char *str = rest;
+    int start = data->size;
+
+    defineHere(label, state, lineNum);
+
+    for (;;)
+    {
+        if ((str = readString(str, lineNum, data)) == NULL)
+        {
+            truncateData(data, start);
+            return; /* error message already printed */
+        }
+        if (arg && !addData(data, 0, 1))
+            return; /* error message already printed */
+
+        while (isspace((unsigned char)*str))
+            str++;
+        if (*str == '\0')
+            return;
+        if (*str++ != ',')
+        {
+            printError("Unexpected error on %s: Directive contains more tokens than expected.\n", lineName(lineNum));
+            truncateData(data, start);
+            return;
+        }
+    }
+}
+
+static void defineHere(char **label, Pass1State *state, int lineNum)
+/* Defines the label on the directive's line (if any) at the current
+   * address, and sets *label to NULL so that pass1 doesn't define it
+   * again.
+   */
+{
+    if (*label != NULL)
+    {
+        (void)defineLabel(state, *label, lineNum);
+        *label = NULL;
+    }
+}
+
+static int readConstant(char *rest, Pass1State *state, int lineNum, char *directive, long *value)
+/* Works out the value of the expression in rest (the operand of
+   * directive), which must only use numbers and the constants defined
+   * so far, into *value.  rest is trimmed of whitespace.
+   * Returns 1 if it has a value; 0 otherwise (an error message is
+   * printed).
+   */
+{
+    char undefined[BUFSIZ];
+    char *text = trim(rest);
+
+    if (*text == '\0')
+    {
+        printError("Unexpected error on %s: Directive contains fewer tokens than expected.\n", lineName(lineNum));
+        return 0;
+    }
+    memmove(rest, text, strlen(text) + 1);
+
+    if (evaluateIn(state->prog, NULL, rest, value, undefined, sizeof(undefined)) != EXPR_OK)
+    {
+        printError("Unexpected error on %s: invalid token %s for %s directive.\n",
+                   lineName(lineNum), rest, directive);
+        return 0;
+    }
+
+    return 1;
+}
+
+static char *trim(char *str)
+/* Removes the whitespace at the end of str.
+   * Returns a pointer to the first character of str that is not
+   * whitespace.
+   */
+{
+    size_t length = strlen(str);
+
+    while (length > 0 && isspace((unsigned char)str[length - 1]))
+        str[--length] = '\0';
+    while (isspace((unsigned char)*str))
+        str++;
+
+    return str;
+}
+
+static char *readString(char *str, int lineNum, DataSegment *data)
+/* Adds the characters of the string in double quotes at the beginning
+   * of str (after any whitespace) to the data segment.  Supports the
+   * escape sequences \n, \t, \0, \\, and \".
+   * Returns a pointer to the character after the closing quote; NULL
+   * if there is no valid string.
+   */
+{
+    while (isspace((unsigned char)*str))
+        str++;
+    if (*str != '"')
+    {
+        printError("Unexpected error on %s: Directive contains fewer tokens than expected.\n", lineName(lineNum));
+        return NULL;
+    }
+
+    for (str++; *str != '"'; str++)
+    {
+        int c = *str;
+
+        if (c == '\0' || c == '\n')
+        {
+            printError("Unexpected error on %s: missing closing quote.\n", lineName(lineNum));
+            return NULL;
+        }
+
+        if (c == '\\')
+        {
+            switch (*++str)
+            {
+            case 'n':
+                c = '\n';
+                break;
+            case 't':
+                c = '\t';
+                break;
+            case '0':
+                c = '\0';
+                break;
+            case '\\':
+            case '"':
+                c = *str;
+                break;
+            default:
+                printError("Unexpected error on %s: invalid escape sequence in string.\n", lineName(lineNum));
+                return NULL;
+            }
+        }
+
+        if (!addData(data, c, 1))
+            return NULL; /* error message already printed */
+    }
+
+    return str + 1;
+}
@@ -0,0 +1,300 @@
+/*
+ * This file contains the writers for the output formats that can be
+ * asked for with --emit=format:path (bin, hex, sym, lst, lines, and c;
+ * see emit.h).  The outputs are opened once, before the first input file is
+ * read, and the machine code and labels of every input file are written
+ * to them in turn, as they are to the standard output.  The listing
+ * reads the source file again for the text of its lines (the lines of
+ * macros and included files are listed at the line that uses them).
+ * The C output is written at the end, from the words kept as they are
+ * made (see translate.c).
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *   Modified:  10/19/2026   Added the listing and the line table.
+ *   Modified:  10/19/2026   Added the translation to C.
+ *   Modified:  10/19/2026   Listed source files may be compressed.
+ *   Modified:  10/19/2026   Included lines have line nbrs of their own.
+ *
+ */
+
+#include "emit.h"
+#include "LineTable.h"
+#include "translate.h"
+#include "decompress.h"
+
+/* The formats an output can have. */
+typedef enum {EMIT_BIN, EMIT_HEX, EMIT_SYM, EMIT_LST, EMIT_LINES, EMIT_C} EmitFormat;
+
+static const char *FORMAT_NAMES[] = {"bin", "hex", "sym", "lst", "lines", "c"};
+#define NBR_FORMATS ((int)(sizeof(FORMAT_NAMES) / sizeof(FORMAT_NAMES[0])))
+
+/* The struct Output records an output asked for by --emit. */
+typedef struct
+{
+    EmitFormat format;
+    FILE *fp;
+} Output;
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+static Output outputs[MAX_EMITS];
+static int nbrOutputs = 0;
+static int wantsListing = 0;    /* is there a lst output? */
+static int wantsLines = 0;      /* is there a lines output? */
+static int wantsC = 0;          /* is there a c output? */
+
+/* The source file being listed, and the line table being built. */
+static char **sourceLines = NULL;
+static int nbrSourceLines = 0;
+static int lastListed = 0;      /* the line listed last */
+static LineRows rows;
+
+/* The machine code to translate into C, and the errors before it. */
+static MachineCode translated;
+static int errorsBefore = 0;
+
+/* internal functions (visible to this file only)*/
+static void readSource(char *fileName);
+static void freeSource(void);
+static int compareAddresses(const void *a, const void *b);
+
+int emitOpen(void)
+/* Opens the outputs named by the --emit options (OPTIONS.emits).
+   * Returns 1 if they were all opened; 0 if one has an unknown format
+   * or can't be opened (an error message is printed).
+   */
+{
+    int i;
+
+    for (i = 0; i < OPTIONS.nbrEmits; i++)
+    {
+        char *spec = OPTIONS.emits[i];
+        char *path = strchr(spec, ':') + 1; /* checked by process_option */
+        int f;
+
+        for (f = 0; f < NBR_FORMATS; f++)
+        {
+            if (strlen(FORMAT_NAMES[f]) == (size_t)(path - 1 - spec) &&
+                strncmp(spec, FORMAT_NAMES[f], path - 1 - spec) == SAME)
+                break;
+        }
+        if (f == NBR_FORMATS)
+        {
+            printError("Error: unknown output format in --emit=%s.\n", spec);
+            return 0;
+        }
+
+        if (f == EMIT_C && OPTIONS.nbrFiles > 1)
+        {
+            printError("Error: --emit=c can only translate one input file.\n");
+            return 0;
+        }
+
+        outputs[nbrOutputs].format = (EmitFormat)f;
+        wantsListing |= f == EMIT_LST;
+        wantsLines |= f == EMIT_LINES;
+        wantsC |= f == EMIT_C;
+        if (strcmp(path, "-") == SAME)
+            outputs[nbrOutputs].fp = stdout;
+        else if ((outputs[nbrOutputs].fp = fopen(path, "w")) == NULL)
+        {
+            printError("Error: Cannot open file %s.\n", path);
+            return 0;
+        }
+        nbrOutputs++;
+    }
+
+    return 1;
+}
+
+void emitBegin(char *fileName)
+/* Prepares the outputs for the machine code of the source file
+   * fileName (NULL for the standard input, whose lines can't be listed,
+   * since they can't be read again).
+   */
+{
+    if (wantsListing && fileName != NULL)
+        readSource(fileName);
+    lastListed = 0;
+    linesInit(&rows);
+    codeInit(&translated);
+    errorsBefore = ERROR_COUNT;
+}
+
+void emitWord(uint32_t word, int address, int lineNum)
+/* Writes word, which goes at address and comes from source line
+   * lineNum (0 for the data segment), to every output that holds
+   * machine code, and adds it to the line tables.  Used as the output
+   * function of a MachineCode.
+   */
+{
+    char line[34];
+    int i, k;
+
+    /* the lines of an included file are listed at the .include */
+    lineNum = mainLine(lineNum);
+    if (wantsLines && lineNum > 0)
+        (void)addLineRow(&rows, address, lineNum);
+    if (wantsC && addWord(&translated, word, address, lineNum) && address < DATA_BASE)
+        translated.textWords = translated.nbrWords;
+
+    for (i = 0; i < nbrOutputs; i++)
+    {
+        switch (outputs[i].format)
+        {
+        case EMIT_BIN:
+            for (k = 0; k < 32; k++)
+                line[k] = (word >> (31 - k)) & 1 ? '1' : '0';
+            line[32] = '\n';
+            STATS.bytesWritten += fwrite(line, 1, 33, outputs[i].fp);
+            break;
+
+        case EMIT_HEX:
+            STATS.bytesWritten += fprintf(outputs[i].fp, "%08x\n", (unsigned int)word);
+            break;
+
+        case EMIT_LST:
+            /* the text of a line goes with the first word made from it */
+            if (lineNum == 0 || lineNum == lastListed)
+                STATS.bytesWritten += fprintf(outputs[i].fp, "%08x  %08x\n",
+                                              (unsigned int)address, (unsigned int)word);
+            else
+                STATS.bytesWritten += fprintf(outputs[i].fp, "%08x  %08x  %5d  %s\n",
+                                              (unsigned int)address, (unsigned int)word, lineNum,
+                                              lineNum <= nbrSourceLines ? sourceLines[lineNum - 1] : "");
+            break;
+
+        case EMIT_SYM:
+        case EMIT_LINES:
+        case EMIT_C:
+            break;
+        }
+    }
+    if (lineNum > 0)
+        lastListed = lineNum;
+}
+
+void emitEnd(LabelTable *table)
+/* Writes the labels in table, in order of address, to every output
+   * that lists symbols (leaving out the ones that the assembler makes
+   * up; see relax.c), the line table of the source file to every output
+   * that holds one, and, if the source file had no errors, its
+   * translation to every C output.
+   */
+{
+    LabelEntry *sorted;
+    int i, k;
+
+    for (i = 0; i < nbrOutputs; i++)
+    {
+        if (outputs[i].format == EMIT_LINES)
+            STATS.bytesWritten += lineTableWrite(&rows, outputs[i].fp);
+        else if (outputs[i].format == EMIT_C && ERROR_COUNT == errorsBefore)
+            STATS.bytesWritten += translateToC(outputs[i].fp, &translated, table,
+                                               OPTIONS.fileName);
+    }
+    linesFree(&rows);
+    codeFree(&translated);
+    freeSource();
+
+    if (table->nbrLabels == 0)
+        return;
+    if ((sorted = memAlloc(MEM_OUTPUT, table->nbrLabels * sizeof(LabelEntry))) == NULL)
+    {
+        printError("%s", ERROR0);
+        return;
+    }
+    memcpy(sorted, table->entries, table->nbrLabels * sizeof(LabelEntry));
+    qsort(sorted, table->nbrLabels, sizeof(LabelEntry), compareAddresses);
+
+    for (i = 0; i < nbrOutputs; i++)
+    {
+        if (outputs[i].format != EMIT_SYM)
+            continue;
+        for (k = 0; k < table->nbrLabels; k++)
+        {
+            if (strchr(sorted[k].label, ':') != NULL)
+                continue;
+            STATS.bytesWritten += fprintf(outputs[i].fp, "%08x %c %s\n",
+                                          (unsigned int)sorted[k].address,
+                                          sorted[k].address >= DATA_BASE ? 'D' : 'T',
+                                          sorted[k].label);
+        }
+    }
+
+    memFree(sorted);
+}
+
+void emitClose(void)
+/* Postcondition: the outputs have been written out and closed. */
+{
+    int i;
+
+    for (i = 0; i < nbrOutputs; i++)
+    {
+        if (outputs[i].fp == stdout)
+            (void)fflush(stdout);
+        else if (fclose(outputs[i].fp) != 0)
+            printError("Error: cannot write the output to %s.\n",
+                       strchr(OPTIONS.emits[i], ':') + 1);
+    }
+    nbrOutputs = 0;
+    wantsListing = wantsLines = wantsC = 0;
+}
+
+static void readSource(char *fileName)
+/* Postcondition: the lines of the file fileName (without their
+   *      newlines) are in sourceLines; none if it can't be read.
+   */
+{
+    char line[BUFSIZ];
+    FILE *fp = fopen(fileName, "r");
+    int capacity = 0;
+
+    if (fp != NULL)
+        fp = decompressOpen(fp, fileName);
+
+    while (fp != NULL && fgets(line, sizeof(line), fp) != NULL)
+    {
+        char **newLines;
+
+        if (nbrSourceLines >= capacity)
+        {
+            capacity = capacity == 0 ? 256 : capacity * 2;
+            if ((newLines = memRealloc(MEM_OUTPUT, sourceLines, capacity * sizeof(char *))) == NULL)
+                break;
+            sourceLines = newLines;
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+        if ((sourceLines[nbrSourceLines] = memStrdup(MEM_OUTPUT, line)) == NULL)
+            break;
+        nbrSourceLines++;
+    }
+
+    if (fp != NULL)
+        (void)fclose(fp);
+}
+
+static void freeSource(void)
+/* Postcondition: the lines read by readSource have been freed. */
+{
+    int i;
+
+    for (i = 0; i < nbrSourceLines; i++)
+        memFree(sourceLines[i]);
+    memFree(sourceLines);
+    sourceLines = NULL;
+    nbrSourceLines = 0;
+}
+
+static int compareAddresses(const void *a, const void *b)
+/* Compares two label entries by address (then by name), for qsort. */
+{
+    const LabelEntry *x = a, *y = b;
+
+    if (x->address != y->address)
+        return (x->address > y->address) - (x->address < y->address);
+    return strcmp(x->label, y->label);
+}
@@ -0,0 +1,64 @@
+/*
+ * Output formats (--emit=format:path)
+ *
+ * This file provides the declarations for writing the machine code in
+ * several formats, to several files, in one run.  Each word is encoded
+ * once and then written to every output that wants it.  The formats
+ * are:
+ *      bin     a word per line, as 32 binary digits (the default output)
+ *      hex     a word per line, as 8 hex digits (for $readmemh)
+ *      sym     the labels, a line each: address, T (text) or D (data),
+ *              and name, as nm prints them
+ *      lst     a listing: the address and hex of each word, with the
+ *              nbr and text of the source line it comes from
+ *      lines   the table from addresses to source lines, in the
+ *              compact binary form described in LineTable.h
+ *      c       a C program that runs the machine code (see translate.h)
+ * A path of "-" is the standard output.  The outputs for all the input
+ * files are written one after the other, except for c, which can only
+ * be asked for with one input file.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *   Modified:	10/19/2026  Added the listing and the line table.
+ *   Modified:	10/19/2026  Added the translation to C.
+ *
+*/
+
+#ifndef EMIT_H
+#define EMIT_H
+
+#include "assembler.h"
+
+int emitOpen(void);
+/* Opens the outputs named by the --emit options (OPTIONS.emits).
+		 * Returns 1 if they were all opened; 0 if one has an unknown
+		 * format or can't be opened (an error message is printed).
+		 */
+
+void emitBegin(char *fileName);
+/* Prepares the outputs for the machine code of the source file
+		 * fileName (NULL for the standard input, whose lines can't be
+		 * listed, since they can't be read again).
+		 */
+
+void emitWord(uint32_t word, int address, int lineNum);
+/* Writes word, which goes at address and comes from source line
+		 * lineNum (0 for the data segment), to every output that
+		 * holds machine code, and adds it to the line tables.  Used
+		 * as the output function of a MachineCode.
+		 */
+
+void emitEnd(LabelTable *table);
+/* Writes the labels in table, in order of address, to every output
+		 * that lists symbols (leaving out the ones that the assembler
+		 * makes up; see relax.c), the line table of the source file to
+		 * every output that holds one, and, if the source file had no
+		 * errors, its translation to every C output.
+		 */
+
+void emitClose(void);
+/* Postcondition: the outputs have been written out and closed. */
+
+#endif
@@ -0,0 +1,419 @@
+/*
+ * Expressions: functions to evaluate an expression at assembly time
+ *
+ * This file provides the definitions of a set of functions for working
+ * out the value of the operand of an instruction or directive, such as
+ * (end - start) / 4, from the constants and labels in it.  See expr.h
+ * for the operators.
+ *
+ * The expression is read by recursive descent: there is one function
+ * for each level of precedence, which reads the operands of its
+ * operators with the function for the level above it.  The names are
+ * looked up as soon as they are read.  A constant (.equ) is kept as
+ * the text of its expression, which is evaluated whenever the constant
+ * is used, so it may use labels and constants defined after it.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <errno.h>
+
+#include "assembler.h"
+
+/* The state of the evaluation of one expression. */
+typedef struct
+{
+    const char *next;  /* the next character to read */
+    SymbolValue lookup; /* looks up the names */
+    void *arg;         /* passed to lookup */
+    int status;        /* EXPR_OK, until something goes wrong */
+    char *undefined;   /* where to copy a name that has no value */
+    size_t size;       /* room in undefined */
+    char name[BUFSIZ]; /* the name being looked up */
+} Parser;
+
+/* What evaluateIn looks the names up in. */
+typedef struct
+{
+    Program *prog;     /* has the constants */
+    LabelTable *table; /* has the labels, or is NULL */
+    int depth;         /* nbr of constants being evaluated */
+    char *undefined;   /* passed on to evaluate */
+    size_t size;
+} Scope;
+
+/* internal functions (visible to this file only)*/
+static long parseOr(Parser *p);
+static long parseAnd(Parser *p);
+static long parseShift(Parser *p);
+static long parseSum(Parser *p);
+static long parseProduct(Parser *p);
+static long parseUnary(Parser *p);
+static long parsePrimary(Parser *p);
+static int nextOperator(Parser *p, const char *op);
+static long fail(Parser *p, int status);
+static int symbolValue(void *arg, const char *name, long *value);
+static int isNameStart(int c);
+static int isNameChar(int c);
+
+int evaluate(const char *text, SymbolValue lookup, void *arg, long *value,
+             char *undefined, size_t size)
+/* Works out the value of the expression text into *value, looking up
+   * the names in it with lookup.  If a name has no value, it is copied
+   * into undefined (which has room for size characters).
+   * Returns EXPR_OK, or the first reason that text has no value.
+   */
+{
+    Parser p;
+    long result;
+
+    p.next = text;
+    p.lookup = lookup;
+    p.arg = arg;
+    p.status = EXPR_OK;
+    p.undefined = undefined;
+    p.size = size;
+    if (size > 0)
+        undefined[0] = '\0';
+
+    result = parseOr(&p);
+    while (isspace((unsigned char)*p.next))
+        p.next++;
+    if (p.status == EXPR_OK && *p.next != '\0')
+        p.status = EXPR_INVALID; /* something is left over */
+
+    *value = p.status == EXPR_OK ? result : 0;
+    return p.status;
+}
+
+int evaluateIn(Program *prog, LabelTable *table, const char *text, long *value,
+               char *undefined, size_t size)
+/* Works out the value of the expression text into *value, as evaluate
+   * does, with the constants defined in prog and, if table is not NULL,
+   * the addresses of the labels in table.
+   * Returns EXPR_OK, or the first reason that text has no value.
+   */
+{
+    Scope scope;
+
+    scope.prog = prog;
+    scope.table = table;
+    scope.depth = 0;
+    scope.undefined = undefined;
+    scope.size = size;
+
+    return evaluate(text, symbolValue, &scope, value, undefined, size);
+}
+
+void scanSymbols(const char *text, void (*visit)(void *arg, const char *name), void *arg)
+/* Calls visit with arg and each name used in the expression text. */
+{
+    char name[BUFSIZ];
+    size_t n;
+
+    while (*text != '\0')
+    {
+        if (isdigit((unsigned char)*text))
+        {
+            /* skip the number, even if it is in hexadecimal */
+            while (isalnum((unsigned char)*text))
+                text++;
+        }
+        else if (isNameStart((unsigned char)*text))
+        {
+            for (n = 0; isNameChar((unsigned char)*text); text++)
+                if (n < sizeof(name) - 1)
+                    name[n++] = *text;
+            name[n] = '\0';
+            visit(arg, name);
+        }
+        else
+            text++;
+    }
+}
+
+void expressionError(int status, const char *text, const char *undefined,
+                     const char *use, int lineNum)
+/* Prints the error message for the expression text on line lineNum,
+   * which has no value for status (undefined is the name that evaluate
+   * copied).  use says what the expression is for (e.g., "data
+   * directive").
+   */
+{
+    switch (status)
+    {
+    case EXPR_UNDEFINED:
+        printError("Unexpected error on %s: Label %s not found in the label table.\n",
+                   lineName(lineNum), undefined);
+        break;
+    case EXPR_DIVIDE_BY_ZERO:
+        printError("Unexpected error on %s: division by zero in %s.\n", lineName(lineNum), text);
+        break;
+    case EXPR_CIRCULAR:
+        printError("Unexpected error on %s: %s is defined in terms of itself.\n",
+                   lineName(lineNum), undefined);
+        break;
+    default:
+        printError("Unexpected error on %s: invalid token %s for %s.\n", lineName(lineNum), text, use);
+    }
+}
+
+int isName(const char *text)
+/* Returns 1 if text is a name (of a label or a constant) on its own,
+   * rather than a number or an expression; 0 otherwise.
+   */
+{
+    if (!isNameStart((unsigned char)*text))
+        return 0;
+    while (isNameChar((unsigned char)*++text))
+        ;
+
+    return *text == '\0';
+}
+
+static long parseOr(Parser *p)
+/* Reads a | b | ... and returns its value. */
+{
+    long value = parseAnd(p);
+
+    while (p->status == EXPR_OK && nextOperator(p, "|"))
+        value |= parseAnd(p);
+
+    return value;
+}
+
+static long parseAnd(Parser *p)
+/* Reads a & b & ... and returns its value. */
+{
+    long value = parseShift(p);
+
+    while (p->status == EXPR_OK && nextOperator(p, "&"))
+        value &= parseShift(p);
+
+    return value;
+}
+
+static long parseShift(Parser *p)
+/* Reads a << b >> ... and returns its value.  A shift by a negative
+   * nbr of bits, or by 64 or more, is not valid.
+   */
+{
+    long value = parseSum(p);
+    long count;
+
+    while (p->status == EXPR_OK)
+    {
+        int left = nextOperator(p, "<<");
+
+        if (!left && !nextOperator(p, ">>"))
+            break;
+        count = parseSum(p);
+        if (p->status != EXPR_OK)
+            break;
+        if (count < 0 || count > 63)
+            return fail(p, EXPR_INVALID);
+
+        /* shift left without a signed overflow; shift right keeping the sign */
+        value = left ? (long)((unsigned long)value << count) : value >> count;
+    }
+
+    return value;
+}
+
+static long parseSum(Parser *p)
+/* Reads a + b - ... and returns its value (wrapping around, rather
+   * than overflowing).
+   */
+{
+    long value = parseProduct(p);
+
+    while (p->status == EXPR_OK)
+    {
+        if (nextOperator(p, "+"))
+            value = (long)((unsigned long)value + (unsigned long)parseProduct(p));
+        else if (nextOperator(p, "-"))
+            value = (long)((unsigned long)value - (unsigned long)parseProduct(p));
+        else
+            break;
+    }
+
+    return value;
+}
+
+static long parseProduct(Parser *p)
+/* Reads a * b / ... and returns its value.  Division rounds toward
+   * zero, as in C.
+   */
+{
+    long value = parseUnary(p);
+    long divisor;
+
+    while (p->status == EXPR_OK)
+    {
+        if (nextOperator(p, "*"))
+            value = (long)((unsigned long)value * (unsigned long)parseUnary(p));
+        else if (nextOperator(p, "/"))
+        {
+            divisor = parseUnary(p);
+            if (p->status != EXPR_OK)
+                break;
+            if (divisor == 0)
+                return fail(p, EXPR_DIVIDE_BY_ZERO);
+
+            /* the one division that overflows is by -1 */
+            value = divisor == -1 ? (long)(0UL - (unsigned long)value) : value / divisor;
+        }
+        else
+            break;
+    }
+
+    return value;
+}
+
+static long parseUnary(Parser *p)
+/* Reads -a, +a, ~a, or a, and returns its value. */
+{
+    if (nextOperator(p, "-"))
+        return (long)(0UL - (unsigned long)parseUnary(p));
+    if (nextOperator(p, "+"))
+        return parseUnary(p);
+    if (nextOperator(p, "~"))
+        return ~parseUnary(p);
+
+    return parsePrimary(p);
+}
+
+static long parsePrimary(Parser *p)
+/* Reads a number, a name, or an expression in parentheses, and returns
+   * its value.
+   */
+{
+    const char *start;
+    char *end;
+    long value;
+    size_t n;
+    int status;
+
+    while (isspace((unsigned char)*p->next))
+        p->next++;
+
+    if (nextOperator(p, "("))
+    {
+        value = parseOr(p);
+        if (p->status == EXPR_OK && !nextOperator(p, ")"))
+            return fail(p, EXPR_INVALID);
+        return value;
+    }
+
+    /* a number, in decimal or in hexadecimal (with a leading 0x) */
+    if (isdigit((unsigned char)*p->next))
+    {
+        errno = 0;
+        value = strtol(p->next, &end, 0);
+        if (errno == ERANGE || isNameChar((unsigned char)*end))
+            return fail(p, EXPR_INVALID);
+        p->next = end;
+        return value;
+    }
+
+    if (!isNameStart((unsigned char)*p->next))
+        return fail(p, EXPR_INVALID);
+
+    /* a name, which the lookup function gives the value of */
+    for (start = p->next; isNameChar((unsigned char)*p->next); p->next++)
+        ;
+    if ((n = p->next - start) >= sizeof(p->name))
+        return fail(p, EXPR_INVALID);
+    memcpy(p->name, start, n);
+    p->name[n] = '\0';
+
+    if ((status = p->lookup(p->arg, p->name, &value)) != EXPR_OK)
+    {
+        /* a constant that has no value may have copied its own name */
+        if (p->size > 0 && p->undefined[0] == '\0')
+        {
+            strncpy(p->undefined, p->name, p->size - 1);
+            p->undefined[p->size - 1] = '\0';
+        }
+        return fail(p, status);
+    }
+
+    return value;
+}
+
+static int nextOperator(Parser *p, const char *op)
+/* Skips the whitespace at the next character, and the operator op if
+   * it comes next.
+   * Returns 1 if op was skipped; 0 otherwise.
+   */
+{
+    size_t n = strlen(op);
+
+    while (isspace((unsigned char)*p->next))
+        p->next++;
+    if (strncmp(p->next, op, n) != SAME)
+        return 0;
+
+    p->next += n;
+    return 1;
+}
+
+static long fail(Parser *p, int status)
+/* Postcondition: the evaluation has failed for status (unless it had
+   *      already failed).
+   * Returns 0, as the value of what was being read.
+   */
+{
+    if (p->status == EXPR_OK)
+        p->status = status;
+
+    return 0;
+}
+
+static int symbolValue(void *arg, const char *name, long *value)
+/* Looks up name, for evaluateIn: a constant in the program of the
+   * Scope arg, whose expression is evaluated in turn, or else a label
+   * in its table.
+   * Returns EXPR_OK, or why name has no value.
+   */
+{
+    Scope *scope = arg;
+    Equate *equate = findEquate(scope->prog, name);
+    Scope inner;
+    int address;
+
+    if (equate != NULL)
+    {
+        if (scope->depth >= MAX_EQUATE_DEPTH)
+            return EXPR_CIRCULAR;
+
+        inner = *scope;
+        inner.depth++;
+        return evaluate(equate->expr, symbolValue, &inner, value, inner.undefined, inner.size);
+    }
+
+    if (scope->table != NULL && (address = findLabel(scope->table, (char *)name)) != -1)
+    {
+        *value = address;
+        return EXPR_OK;
+    }
+
+    return EXPR_UNDEFINED;
+}
+
+static int isNameStart(int c)
+/* Returns 1 if a name (of a label or a constant) can start with c. */
+{
+    return isalpha(c) || c == '_' || c == '.';
+}
+
+static int isNameChar(int c)
+/* Returns 1 if c can be part of a name, after its first character (a
+   * # only in the labels that a macro expansion renames; see Source.c).
+   */
+{
+    return isalnum(c) || c == '_' || c == '.' || c == '#';
+}
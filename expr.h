@@ -0,0 +1,85 @@
+/*
+ * Expressions: evaluating the operands of instructions and directives
+ *
+ * This file provides the declarations for the functions that work out
+ * the value of an expression at assembly time.  An expression is made
+ * of numbers (in decimal, or in hexadecimal with a leading 0x), the
+ * names of constants (.equ and .set) and labels, and the operators
+ *      ( )             grouping
+ *      - + ~           negation, plus, and bitwise not (unary)
+ *      * /             multiplication and division (rounding toward 0)
+ *      + -             addition and subtraction
+ *      << >>           shifts (>> keeps the sign)
+ *      &               bitwise and
+ *      |               bitwise or
+ * from the highest precedence to the lowest, as in C.  E.g.,
+ *      (end - start) / 4       the nbr of words from start to end
+ * The arithmetic is done with 64 bits; the instruction or directive
+ * that uses the value checks that it fits in its field.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef EXPR_H
+#define EXPR_H
+
+/* The most constants that may be defined in terms of each other (a
+ * constant that takes more is taken to be defined in terms of itself).
+ */
+#define MAX_EQUATE_DEPTH 16
+
+/* What evaluating an expression found. */
+enum
+{
+	EXPR_OK,		/* the expression has a value */
+	EXPR_INVALID,		/* it is not a valid expression */
+	EXPR_UNDEFINED,		/* it uses a name that has no value (yet) */
+	EXPR_DIVIDE_BY_ZERO,	/* it divides by zero */
+	EXPR_CIRCULAR		/* a constant is defined in terms of itself */
+};
+
+/* A function that looks up the value of name (for evaluate), given the
+ * arg passed to evaluate.  It returns EXPR_OK, or why name has no
+ * value.
+ */
+typedef int (*SymbolValue)(void *arg, const char *name, long *value);
+
+/* THE FUNCTIONS */
+
+int evaluate(const char *text, SymbolValue lookup, void *arg, long *value,
+	     char *undefined, size_t size);
+/* Works out the value of the expression text into *value, looking up
+         *      the names in it with lookup.  If a name has no value, it
+         *      is copied into undefined (which has room for size
+         *      characters).
+         * Returns EXPR_OK, or the first reason that text has no value.
+         */
+
+int evaluateIn(Program *prog, LabelTable *table, const char *text, long *value,
+	       char *undefined, size_t size);
+/* Works out the value of the expression text into *value, as evaluate
+         *      does, with the constants defined in prog and, if table is
+         *      not NULL, the addresses of the labels in table.
+         * Returns EXPR_OK, or the first reason that text has no value.
+         */
+
+void scanSymbols(const char *text, void (*visit)(void *arg, const char *name), void *arg);
+/* Calls visit with arg and each name used in the expression text. */
+
+void expressionError(int status, const char *text, const char *undefined,
+		     const char *use, int lineNum);
+/* Prints the error message for the expression text on line lineNum,
+         *      which has no value for status (undefined is the name
+         *      that evaluate copied).  use says what the expression is
+         *      for (e.g., "data directive").
+         */
+
+int isName(const char *text);
+/* Returns 1 if text is a name (of a label or a constant) on its own,
+         *      rather than a number or an expression; 0 otherwise.
+         */
+
+#endif
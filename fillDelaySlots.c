@@ -0,0 +1,178 @@
+/*
+ * This file contains the delay slot scheduler, the pass that fills the
+ * delay slot of every branch and jump assembled in .set reorder mode.
+ * In that mode the source is written as if there were no delay slots,
+ * so the assembler must put an instruction in each slot itself.  The
+ * scheduler looks back through the basic block ending at the branch
+ * for an instruction that the branch (and every instruction in
+ * between) does not depend on, and moves it into the slot.  Only if
+ * no instruction qualifies does it insert a nop.
+ *
+ * An instruction qualifies if
+ *      - it was also assembled in reorder mode,
+ *      - no label comes after it in the block (a jump to that label
+ *        would otherwise execute it when it should not),
+ *      - it does not write a register that the instructions after it
+ *        read or write, or read a register that they write, and
+ *      - it is not a load or store that would pass a store (or a
+ *        store that would pass a load).
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *   Modified:  10/19/2026   A filled branch is no longer in reorder mode
+ *                           (for the passes that build the CFG after it).
+ *
+ */
+
+#include "assembler.h"
+#include "optimize.h"
+
+/* How far back from a branch to look for an instruction to move. */
+#define MAX_WINDOW 8
+
+/* internal functions (visible to this file only)*/
+static int findSlotFiller(Program *prog, int branch);
+
+int fillDelaySlots(Program *prog, LabelTable *table)
+/* Fills the delay slot of every branch and jump assembled in .set
+   * reorder mode, and lays the program out again.
+   * Returns the number of slots filled with a moved instruction
+   * (rather than a nop).
+   */
+{
+    Program out;    /* the program with its delay slots filled */
+    int filled = 0; /* slots filled with a moved instruction */
+    int nops = 0;   /* slots filled with a nop */
+    int i;
+
+    /* Most programs have no branch in reorder mode; leave them as they
+     * are, without laying them out again.
+     */
+    for (i = 0; i < prog->nbrInstrs; i++)
+        if (prog->instrs[i].reorder && isControlTransfer(&prog->instrs[i]))
+            break;
+    if (i == prog->nbrInstrs)
+        return 0;
+
+    /* Build the new program in one pass, so that inserting slots does
+     * not shift the rest of the program once per branch.
+     */
+    programInit(&out);
+    if (!programResize(&out, prog->nbrInstrs + prog->nbrInstrs / 4 + 1))
+        return 0; /* error message already printed */
+
+    for (i = 0; i < prog->nbrInstrs; i++)
+    {
+        Instruction *instr = &prog->instrs[i];
+        Instruction slot;
+        int k;
+
+        if (!addInstruction(&out, instr))
+            break; /* error message already printed */
+
+        if (!instr->reorder || !isControlTransfer(instr))
+            continue;
+
+        if ((k = findSlotFiller(&out, out.nbrInstrs - 1)) != -1)
+        {
+            /* Move the instruction, leaving its label (if any) behind. */
+            TRACE(TRACE_OPTIMIZER, 2, "%s: moved into the delay slot of %s.\n",
+                  lineName(out.instrs[k].lineNum), lineName(instr->lineNum));
+            slot = out.instrs[k];
+            slot.label = NULL;
+            out.instrs[k].name = NULL;
+            out.instrs[k].target = NULL;
+            out.instrs[k].expr = NULL;
+            filled++;
+        }
+        else
+        {
+            /* nop (sll $zero, $zero, 0) */
+            slot = *instr;
+            slot.label = NULL;
+            slot.target = NULL;
+            slot.expr = NULL;
+            if ((slot.name = memStrdup(MEM_OPTIMIZER, "nop")) == NULL)
+            {
+                printError("Error: cannot allocate space in memory.\n");
+                break;
+            }
+            slot.f.code = 0;
+            slot.f.opType = "R";
+            slot.rs = slot.rt = slot.rd = 0;
+            slot.shamt = slot.imm = 0;
+            nops++;
+        }
+
+        /* The branch now has its delay slot after it, as outside
+         * reorder mode (so later passes find its block's end there).
+         */
+        out.instrs[out.nbrInstrs - 1].reorder = 0;
+        if (!addInstruction(&out, &slot))
+            break; /* error message already printed */
+    }
+
+    /* The statements (and the strings they own) now belong to out;
+     * the data segment is unchanged.
+     */
+    memFree(prog->instrs);
+    prog->instrs = out.instrs;
+    prog->capacity = out.capacity;
+    prog->nbrInstrs = out.nbrInstrs;
+    tableFree(&out.data.labels);
+
+    TRACE(TRACE_OPTIMIZER, 1, "delay slots: %d filled, %d nops.\n", filled, nops);
+    (void)layoutProgram(prog, table);
+    return filled;
+}
+
+static int findSlotFiller(Program *prog, int branch)
+/* Returns the index of an instruction before the branch at index
+   * branch, in the same basic block, that can be moved into its delay
+   * slot; -1 if there is none.
+   */
+{
+    Instruction *instrs = prog->instrs;
+    int k, j;
+
+    /* A label on the branch itself starts a new block. */
+    if (instrs[branch].label != NULL)
+        return -1;
+
+    for (k = branch - 1; k >= 0 && k >= branch - MAX_WINDOW; k--)
+    {
+        Instruction *mover = &instrs[k];
+        int prev;
+
+        /* skip instructions that have already been moved */
+        if (mover->name == NULL && mover->label == NULL && mover->align == 0)
+            continue;
+
+        /* stop at a label, .align, or the end of the previous block */
+        if (mover->name == NULL || isControlTransfer(mover))
+            return -1;
+
+        /* the instruction may be filling an earlier delay slot */
+        for (prev = k - 1; prev >= 0 && instrs[prev].name == NULL; prev--)
+            ;
+        if (prev >= 0 && isControlTransfer(&instrs[prev]))
+            return -1;
+
+        if (mover->reorder)
+        {
+            /* it must be independent of everything it would pass */
+            for (j = k + 1; j <= branch; j++)
+                if (dependsOn(&instrs[j], mover))
+                    break;
+            if (j > branch)
+                return k;
+        }
+
+        /* an instruction with a label starts the block */
+        if (mover->label != NULL)
+            return -1;
+    }
+
+    return -1;
+}
@@ -0,0 +1,290 @@
+/*
+ * This file contains the inliner, an optional pass (--inline, or
+ * --inline=n) that copies the bodies of small leaf functions into the
+ * places that call them, so that a call in a loop doesn't pay for the
+ * jal, the jr, and their delay slots every time.  A leaf function is a
+ * label that a jal goes to, followed by at most n instructions
+ * (INLINE_LIMIT by default) and a jr $ra (and, outside .set reorder
+ * mode, its delay slot), where
+ *      - no instruction reads or writes $ra (so there is no jal), or
+ *        writes $sp,
+ *      - every branch and j goes to a label in the body, and there is
+ *        no other jr, and
+ *      - there is no .align.
+ * A call is replaced by the delay slot of the jal (which runs before
+ * the function, as it did), then a copy of the body up to the jr, then
+ * the delay slot of the jr:
+ *
+ *          jal f                       <delay slot of the jal>
+ *          <delay slot>        =>      <body of f>
+ *                                      <delay slot of the jr>
+ *
+ * so the delay slot of the jal must not use $ra either, or be labeled.
+ * The labels in the body get new names in each copy (inline:1:f, ...;
+ * the colon keeps them apart from the labels in the source), which the
+ * branches in the copy go to; other uses of the labels (such as la)
+ * still refer to the function.  The function itself stays where it is,
+ * since it may still be called from elsewhere, or through a jr;
+ * --unreachable=strip deletes it if nothing reaches it any more.  A call
+ * that is inlined no longer sets $ra, which a leaf function doesn't use.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include "assembler.h"
+#include "optimize.h"
+
+/* The registers that a leaf function may not write ($sp), or use at
+ * all ($ra), but to return.
+ */
+#define SP 29
+#define RA 31
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+
+/* internal functions (visible to this file only)*/
+static int findLeaf(Program *prog, LabelTable *table, int start, int limit);
+static int bodyStart(Program *prog, int start);
+static int canInlineAt(Program *prog, int call);
+static int copyBody(Program *out, Program *prog, int start, int jr, int nbr);
+static char *freshLabel(char *label, int nbr);
+static int definedIn(Program *prog, char *label, int first, int last);
+static int usesRegister(Instruction *instr, int reg);
+
+int inlineLeaves(Program *prog, LabelTable *table, int limit)
+/* Replaces every call to a leaf function of at most limit instructions
+   * with a copy of its body, and lays the program out again.
+   * Returns the number of calls that were inlined.
+   */
+{
+    Program out; /* the program with its calls inlined */
+    int *leaves; /* for each statement that a jal goes to: the index of
+                    the jr that ends its leaf function, -1 if it isn't
+                    one, or -2 if not found yet */
+    int inlined = 0;
+    int i;
+
+    if ((leaves = memAlloc(MEM_OPTIMIZER, (prog->nbrInstrs + 1) * sizeof(int))) == NULL)
+    {
+        printError("%s", ERROR0);
+        return 0; /* fatal error: couldn't allocate memory */
+    }
+    for (i = 0; i < prog->nbrInstrs; i++)
+        leaves[i] = -2;
+    programInit(&out);
+    if (!programResize(&out, prog->nbrInstrs + 1))
+    {
+        memFree(leaves);
+        return 0; /* error message already printed */
+    }
+
+    for (i = 0; i < prog->nbrInstrs; i++)
+    {
+        Instruction *instr = &prog->instrs[i];
+        Instruction call;
+        int start = -1;
+
+        if (instr->name != NULL && *instr->f.opType == 'J' && instr->f.code == 3 &&
+            (start = findInstruction(prog, table, instr->target)) != -1 && leaves[start] == -2)
+            leaves[start] = findLeaf(prog, table, start, limit);
+
+        if (start == -1 || leaves[start] == -1 || !canInlineAt(prog, i))
+        {
+            if (!addInstruction(&out, instr))
+                break; /* error message already printed */
+            continue;
+        }
+
+        TRACE(TRACE_OPTIMIZER, 2, "%s: call to %s inlined.\n", lineName(instr->lineNum), instr->target);
+        inlined++;
+
+        /* The label of the jal (if any) now marks the copy, after the
+         * delay slot of the jal, which runs first.
+         */
+        call = *instr;
+        call.name = call.target = call.expr = NULL;
+        memFree(instr->name);
+        memFree(instr->target);
+        memFree(instr->expr);
+        if ((call.label != NULL && !addInstruction(&out, &call)) ||
+            (!instr->reorder && !addInstruction(&out, &prog->instrs[++i])) ||
+            !copyBody(&out, prog, start, leaves[start], inlined))
+            break; /* error message already printed */
+    }
+    memFree(leaves);
+
+    /* The statements (and the strings they own) now belong to out;
+     * the data segment is unchanged.
+     */
+    memFree(prog->instrs);
+    prog->instrs = out.instrs;
+    prog->capacity = out.capacity;
+    prog->nbrInstrs = out.nbrInstrs;
+    tableFree(&out.data.labels);
+
+    TRACE(TRACE_OPTIMIZER, 1, "inlining: %d calls inlined.\n", inlined);
+    (void)layoutProgram(prog, table);
+    return inlined;
+}
+
+static int findLeaf(Program *prog, LabelTable *table, int start, int limit)
+/* Returns the index of the jr $ra that ends the leaf function whose
+   * first instruction is at start; -1 if it is not a leaf function of
+   * at most limit instructions.
+   */
+{
+    int size = 0; /* nbr of instructions before the jr */
+    int jr, k;
+
+    for (jr = start; jr < prog->nbrInstrs; jr++)
+    {
+        Instruction *instr = &prog->instrs[jr];
+
+        if (instr->align > 0)
+            return -1;
+        if (instr->name == NULL)
+            continue;
+        if (*instr->f.opType == 'R' && instr->f.code == 8)
+            break;
+        if (++size > limit || usesRegister(instr, RA) || destRegister(instr) == SP)
+            return -1;
+    }
+    if (jr == prog->nbrInstrs || prog->instrs[jr].rs != RA)
+        return -1;
+
+    /* Outside reorder mode, the delay slot of the jr is copied too (it
+     * can't be the delay slot of a branch).
+     */
+    if (!prog->instrs[jr].reorder)
+    {
+        Instruction *slot = jr + 1 < prog->nbrInstrs ? &prog->instrs[jr + 1] : NULL;
+
+        if (slot == NULL || slot->name == NULL || isControlTransfer(slot) ||
+            usesRegister(slot, RA) || destRegister(slot) == SP)
+            return -1;
+        if (jr > start && !prog->instrs[jr - 1].reorder && isControlTransfer(&prog->instrs[jr - 1]))
+            return -1;
+    }
+
+    /* Every branch and j goes to a label that is copied with the body. */
+    for (k = start; k < jr; k++)
+    {
+        Instruction *instr = &prog->instrs[k];
+        int target;
+
+        if (!isControlTransfer(instr))
+            continue;
+        if (instr->target == NULL ||
+            (target = findInstruction(prog, table, instr->target)) < start || target > jr ||
+            !definedIn(prog, instr->target, bodyStart(prog, start), jr))
+            return -1;
+    }
+
+    return jr;
+}
+
+static int bodyStart(Program *prog, int start)
+/* Returns the index of the first statement of the body of the function
+   * whose first instruction is at start: the label-only statements
+   * right before it (which mark it too) are part of the body.
+   */
+{
+    int first = start;
+
+    while (first > 0 && prog->instrs[first - 1].name == NULL &&
+           prog->instrs[first - 1].align == 0 &&
+           prog->instrs[first - 1].address == prog->instrs[start].address)
+        first--;
+    return first;
+}
+
+static int canInlineAt(Program *prog, int call)
+/* Returns 1 if the jal at index call can be replaced with the body of
+   * the function: if it is in reorder mode, or its delay slot is an
+   * unlabeled instruction that doesn't use $ra; 0 otherwise.
+   */
+{
+    Instruction *slot = call + 1 < prog->nbrInstrs ? &prog->instrs[call + 1] : NULL;
+
+    if (prog->instrs[call].reorder)
+        return 1;
+    return slot != NULL && slot->name != NULL && slot->label == NULL &&
+           !isControlTransfer(slot) && !usesRegister(slot, RA);
+}
+
+static int copyBody(Program *out, Program *prog, int start, int jr, int nbr)
+/* Postcondition: a copy of the body of the function whose first
+   *      instruction is at start, up to the jr at index jr (and its
+   *      delay slot, if any), has been added to out, with the labels in
+   *      it renamed for the copy nbr nbr.  The jr itself is left out
+   *      (but its label is kept).
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    int first = bodyStart(prog, start);
+    int last = prog->instrs[jr].reorder ? jr : jr + 1;
+    int k;
+
+    for (k = first; k <= last; k++)
+    {
+        Instruction *instr = &prog->instrs[k];
+        Instruction copy = *instr;
+
+        copy.label = copy.name = copy.target = copy.expr = NULL;
+        if ((instr->label != NULL && (copy.label = freshLabel(instr->label, nbr)) == NULL) ||
+            (k != jr && instr->name != NULL &&
+             (copy.name = memStrdup(MEM_OPTIMIZER, instr->name)) == NULL) ||
+            (k != jr && instr->target != NULL &&
+             (copy.target = isControlTransfer(instr) ? freshLabel(instr->target, nbr) :
+                                                       memStrdup(MEM_OPTIMIZER, instr->target)) == NULL) ||
+            (k != jr && instr->expr != NULL &&
+             (copy.expr = memStrdup(MEM_OPTIMIZER, instr->expr)) == NULL))
+        {
+            memFree(copy.label);
+            memFree(copy.name);
+            memFree(copy.target);
+            printError("%s", ERROR0);
+            return 0;
+        }
+
+        if ((copy.name != NULL || copy.label != NULL) && !addInstruction(out, &copy))
+            return 0; /* error message already printed */
+    }
+
+    return 1;
+}
+
+static char *freshLabel(char *label, int nbr)
+/* Returns the name of label in the copy nbr nbr of a function body
+   * (e.g., inline:3:loop); NULL if memory allocation error.
+   */
+{
+    char *fresh = memAlloc(MEM_OPTIMIZER, strlen(label) + 32);
+
+    if (fresh != NULL)
+        sprintf(fresh, "inline:%d:%s", nbr, label);
+    return fresh;
+}
+
+static int definedIn(Program *prog, char *label, int first, int last)
+/* Returns 1 if label is defined by one of the statements from index
+   * first to last; 0 otherwise.
+   */
+{
+    int k;
+
+    for (k = first; k <= last; k++)
+        if (prog->instrs[k].label != NULL && strcmp(prog->instrs[k].label, label) == SAME)
+            return 1;
+    return 0;
+}
+
+static int usesRegister(Instruction *instr, int reg)
+/* Returns 1 if instr reads or writes register reg; 0 otherwise. */
+{
+    return destRegister(instr) == reg || readsRegister(instr, reg);
+}
@@ -0,0 +1,356 @@
+/*
+ * libassembler: functions to use the assembler as a library
+ *
+ * This file provides the definitions of the functions that assemble a
+ * stream or a buffer of assembly source into an Assembler, which holds
+ * the machine code, the labels, and the error messages.  See
+ * libassembler.h.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *   Modified:  10/19/2026   A check runs every pass, and throws the
+ *                           machine code away.
+ *
+ */
+
+#include "libassembler.h"
+#include "pass2.h"
+#include "optimize.h"
+
+/* The error messages of an assembly, kept until it is done so that
+ * they are reported in the order of the lines they are about: pass1
+ * finds most errors, but the labels that are missing are only found by
+ * pass2.
+ */
+typedef struct
+{
+    int line;      /* ERROR_LINE when it was reported */
+    int order;     /* nbr of messages reported before it */
+    char *message; /* with its prefix */
+} Message;
+
+typedef struct
+{
+    ErrorHandler handler; /* where the messages go in the end (NULL: */
+    void *arg;            /* printed), and its argument */
+    int capacity;
+    int nbrMessages;
+    Message *messages;
+} ErrorLog;
+
+/* The library defines SAME for all of its modules (see same.h). */
+const int SAME = 0; /* useful for making strcmp readable */
+                    /* e.g., if (strcmp (str1, str2) == SAME) */
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+
+/* internal functions (visible to this file only)*/
+static void clearResults(Assembler *as);
+static void collect(void *arg, const char *message);
+static void keep(void *arg, const char *message);
+static void reportInOrder(ErrorLog *log, int errors);
+static int compareMessages(const void *a, const void *b);
+static void discardWord(uint32_t word, int address, int lineNum);
+
+void assemblerInit(Assembler *as)
+/* Postcondition: as is initialized with no options, to collect the
+   *       error messages, and with no results.
+   */
+{
+    memset(&as->options, 0, sizeof(as->options));
+    as->printErrors = 0;
+    codeInit(&as->code);
+    tableInit(&as->symbols);
+    as->nbrErrors = 0;
+    as->diagCapacity = as->nbrDiagnostics = 0;
+    as->diagnostics = NULL;
+}
+
+int assembleStream(Assembler *as, FILE *fp)
+/* Postcondition: the program read from fp has been assembled (or,
+   *      with as->options.check, only checked for errors: every pass
+   *      runs, but no machine code is kept or output), and the
+   *      results of any earlier assembly in as have been replaced
+   *      by its machine code, labels, and error messages.  The
+   *      file is not closed.
+   * Returns the nbr of errors found.
+   */
+{
+    Options savedOptions = OPTIONS;
+    ErrorHandler savedHandler = ERROR_HANDLER;
+    void *savedArg = ERROR_HANDLER_ARG;
+    int errors = ERROR_COUNT;
+    ErrorLog log;
+    LabelTable table;
+    Program program; /* decoded instructions, kept for pass2 */
+    void (*output)(uint32_t word, int address, int lineNum);
+
+    /* The modules read the options from OPTIONS, and report errors
+     * through printError, in this thread only; the messages are kept
+     * until the program has been translated, and then reported in the
+     * order of the lines.
+     */
+    clearResults(as);
+    OPTIONS = as->options;
+    if (!as->printErrors)
+    {
+        ERROR_HANDLER = collect;
+        ERROR_HANDLER_ARG = as;
+    }
+    log.handler = ERROR_HANDLER;
+    log.arg = ERROR_HANDLER_ARG;
+    log.capacity = log.nbrMessages = 0;
+    log.messages = NULL;
+    ERROR_HANDLER = keep;
+    ERROR_HANDLER_ARG = &log;
+
+    /* Call pass1 to decode the program and generate the label table. */
+    programInit(&program);
+    statsBegin(PHASE_PASS1);
+    table = pass1(fp, &program);
+    statsEnd(PHASE_PASS1);
+    STATS.labels += table.nbrLabels;
+    ERROR_LINE = 0; /* the optimizer's messages are about no line */
+
+    /* A check goes through every pass (so that it finds the errors
+     * that only show once the program is laid out, such as a branch
+     * that can't reach its label), but the words are thrown away.
+     */
+    output = as->code.output;
+    if (OPTIONS.check)
+        as->code.output = discardWord;
+
+    /* Rewrite the program with the peephole optimizer, if requested. */
+    statsBegin(PHASE_OPTIMIZE);
+
+    /* Inline the calls to small leaf functions, if requested. */
+    if (OPTIONS.inlineLimit > 0)
+        (void)inlineLeaves(&program, &table, OPTIONS.inlineLimit);
+
+    if (OPTIONS.optimize)
+    {
+        int rewrites = peephole(&program, &table);
+        TRACE(TRACE_OPTIMIZER, 1, "peephole: %d rewrites.\n", rewrites);
+    }
+
+    /* Report (or delete) the code that can't run, if requested. */
+    if (OPTIONS.unreachable)
+        (void)removeUnreachable(&program, &table, OPTIONS.unreachable == 2);
+
+    /* Fill the delay slots of branches and jumps in .set reorder mode. */
+    (void)fillDelaySlots(&program, &table);
+
+    /* Lay the blocks out by how often they ran, if a profile was given. */
+    if (OPTIONS.profile != NULL)
+        (void)layoutByProfile(&program, &table, OPTIONS.profile);
+
+    /* Move loads away from the instructions that use them, if requested. */
+    if (OPTIONS.schedule)
+        (void)scheduleLoads(&program, &table);
+
+    /* Rewrite the branches and jumps that can't reach their target. */
+    (void)relaxBranches(&program, &table);
+    statsEnd(PHASE_OPTIMIZE);
+
+    /* Print the label table if debugging is turned on. */
+    if (debug_is_on())
+        printLabels(&table);
+
+    /* Call pass2 to translate the program, passing it the label table. */
+    statsBegin(PHASE_PASS2);
+    pass2(&program, table, &as->code);
+    statsEnd(PHASE_PASS2);
+    as->code.output = output;
+
+    programFree(&program);
+    reportInOrder(&log, errors);
+    as->symbols = table;
+    as->nbrErrors = ERROR_COUNT - errors;
+
+    OPTIONS = savedOptions;
+    ERROR_HANDLER = savedHandler;
+    ERROR_HANDLER_ARG = savedArg;
+    return as->nbrErrors;
+}
+
+int assembleBuffer(Assembler *as, const char *source, size_t length,
+                   uint32_t *words, int capacity)
+/* Postcondition: the length characters of assembly source at source
+   *      have been assembled as by assembleStream, and the first
+   *      capacity words of machine code (at most) have been
+   *      stored in words, which may be NULL if capacity is 0.
+   *      The files included are not kept in memory afterwards.
+   * Returns the nbr of words of machine code (more than capacity
+   *      if words is too small); -1 if there were errors.
+   */
+{
+    FILE *fp;
+    int errors;
+
+    /* Read the buffer as if it were a file. */
+    if ((fp = fmemopen((void *)source, length, "r")) == NULL)
+    {
+        clearResults(as);
+        if (as->printErrors)
+            printError("%s", ERROR0);
+        else
+            collect(as, ERROR0);
+        as->nbrErrors = 1;
+        return -1;
+    }
+    errors = assembleStream(as, fp);
+    (void)fclose(fp);
+    freeIncludeCache();
+
+    if (errors > 0)
+        return -1;
+    if (words != NULL && capacity > 0 && as->code.words != NULL)
+        memcpy(words, as->code.words,
+               (as->code.nbrWords < capacity ? as->code.nbrWords : capacity) * sizeof(uint32_t));
+    return as->code.nbrWords;
+}
+
+void assemblerFree(Assembler *as)
+/* Postcondition: all the memory used by the results in as has been
+   *      freed, and as has no results.
+   */
+{
+    clearResults(as);
+    memFree(as->diagnostics);
+    as->diagCapacity = 0;
+    as->diagnostics = NULL;
+}
+
+static void clearResults(Assembler *as)
+/* Postcondition: the machine code, labels, and error messages in as
+   *      have been freed (keeping the space for the messages).
+   */
+{
+    int i;
+
+    codeFree(&as->code);
+    tableFree(&as->symbols);
+    for (i = 0; i < as->nbrDiagnostics; i++)
+        memFree(as->diagnostics[i]);
+    as->nbrDiagnostics = 0;
+    as->nbrErrors = 0;
+}
+
+static void collect(void *arg, const char *message)
+/* Adds a copy of the error message to the diagnostics of the Assembler
+   * at arg (the error handler while it is assembling).  A message that
+   * there is no memory for is only counted (in nbrErrors).
+   */
+{
+    Assembler *as = arg;
+    char *copy;
+
+    if (as->nbrDiagnostics >= as->diagCapacity)
+    {
+        int newSize = as->diagCapacity == 0 ? 16 : as->diagCapacity * 2;
+        char **newList = memRealloc(MEM_OTHER, as->diagnostics, newSize * sizeof(char *));
+
+        if (newList == NULL)
+            return;
+        as->diagnostics = newList;
+        as->diagCapacity = newSize;
+    }
+
+    if ((copy = memStrdup(MEM_OTHER, message)) != NULL)
+        as->diagnostics[as->nbrDiagnostics++] = copy;
+}
+
+static void keep(void *arg, const char *message)
+/* Adds a copy of the error message, and the line it is about, to the
+   * ErrorLog at arg (the error handler while it is assembling).  A
+   * message that there is no memory for is reported at once.
+   */
+{
+    ErrorLog *log = arg;
+    Message *entry;
+
+    if (log->nbrMessages >= log->capacity)
+    {
+        int newSize = log->capacity == 0 ? 16 : log->capacity * 2;
+        Message *newList = memRealloc(MEM_OTHER, log->messages, newSize * sizeof(Message));
+
+        if (newList == NULL)
+        {
+            if (log->handler != NULL)
+                log->handler(log->arg, message);
+            else
+                fputs(message, stderr);
+            return;
+        }
+        log->messages = newList;
+        log->capacity = newSize;
+    }
+
+    entry = &log->messages[log->nbrMessages];
+    if ((entry->message = memStrdup(MEM_OTHER, message)) == NULL)
+    {
+        if (log->handler != NULL)
+            log->handler(log->arg, message);
+        else
+            fputs(message, stderr);
+        return;
+    }
+    entry->line = ERROR_LINE;
+    entry->order = log->nbrMessages++;
+}
+
+static void reportInOrder(ErrorLog *log, int errors)
+/* Postcondition: the messages in log have been passed on to its
+   *      handler (or printed, up to the first one past ERROR_LIMIT
+   *      errors, errors being the count before this assembly, as
+   *      printError does), in the order of the lines they are about,
+   *      and freed.  The messages that are about no line (e.g., a
+   *      duplicate label, as when the labels were collected in a pass
+   *      of their own) come first.  The program is never stopped here;
+   *      ERROR_COUNT tells the caller whether the limit was passed.
+   */
+{
+    int i;
+
+    ERROR_HANDLER = log->handler;
+    ERROR_HANDLER_ARG = log->arg;
+    ERROR_LINE = 0;
+
+    if (log->nbrMessages > 1)
+        qsort(log->messages, log->nbrMessages, sizeof(Message), compareMessages);
+    for (i = 0; i < log->nbrMessages; i++)
+    {
+        if (log->handler != NULL)
+            log->handler(log->arg, log->messages[i].message);
+        else if (ERROR_LIMIT <= 0 || errors + i <= ERROR_LIMIT)
+            fputs(log->messages[i].message, stderr);
+        memFree(log->messages[i].message);
+    }
+    memFree(log->messages);
+    log->capacity = log->nbrMessages = 0;
+    log->messages = NULL;
+}
+
+static int compareMessages(const void *a, const void *b)
+/* Compares two messages by line (a line of an included file goes with
+   * the .include), then in the order they were reported, for qsort.
+   */
+{
+    const Message *x = a, *y = b;
+
+    if (mainLine(x->line) != mainLine(y->line))
+        return mainLine(x->line) < mainLine(y->line) ? -1 : 1;
+    if (x->line != y->line)
+        return x->line < y->line ? -1 : 1;
+    return x->order < y->order ? -1 : x->order > y->order;
+}
+
+static void discardWord(uint32_t word, int address, int lineNum)
+/* Throws away a word of machine code (for --check). */
+{
+    (void)word;
+    (void)address;
+    (void)lineNum;
+}
@@ -0,0 +1,120 @@
+/*
+ * libassembler: the assembler as a library
+ *
+ * This file provides the data structure and declarations for using the
+ * assembler from another program (an IDE, a simulator, a test harness)
+ * without running it as a separate process.  An Assembler holds the
+ * options for an assembly and everything it produces: the machine code,
+ * the labels with their addresses, and the error messages, which are
+ * collected rather than printed, and never stop the program.
+ *
+ * The state that the modules of the assembler share is not kept in the
+ * Assembler, but in global variables that each thread has its own copy
+ * of (_Thread_local): OPTIONS, which assembleStream sets from
+ * as->options, the error state of printFuncs.h (ERROR_LIMIT,
+ * ERROR_COUNT, ...), the include cache (see Source.h), and the
+ * statistics (STATS).  So
+ *      - several threads can each assemble with their own Assembler at
+ *        the same time, but a thread can only run one assembly at a
+ *        time;
+ *      - the files included stay in the thread's include cache after
+ *        assembleStream, until freeIncludeCache (assembleBuffer frees
+ *        them itself);
+ *      - ERROR_COUNT goes on counting from one assembly to the next in
+ *        a thread; nbrErrors is the count for one.
+ * Tracing (--debug, see trace.h) and the memory counts and allocator of
+ * mem.h are shared by the whole process; tracing is meant for the
+ * command line only.  The outputs of the command line (emit.c,
+ * pipeline.c, watch.c) are not part of the library.
+ *
+ * No function of the library exits the program: with printErrors, the
+ * messages stop at ERROR_LIMIT, as printError's do, but it is up to the
+ * caller to stop (the command line does).
+ *
+ * The memory for all of it comes from malloc, unless the program sets
+ * an allocator of its own with memSetAllocator (see mem.h) before it
+ * assembles anything.  Either way, what each subsystem uses is counted,
+ * and can be printed with memPrint.
+ *
+ * E.g.,
+ *      Assembler as;
+ *      uint32_t words[1024];
+ *      int n;
+ *
+ *      assemblerInit(&as);
+ *      n = assembleBuffer(&as, source, strlen(source), words, 1024);
+ *      if (n < 0)
+ *          ... the errors are in as.diagnostics ...
+ *      else if (n > 1024)
+ *          ... only the first 1024 of the n words were stored ...
+ *      assemblerFree(&as);
+ *
+ * The command-line assembler (assembler.c) is a thin wrapper around
+ * assembleStream that prints the machine code.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *   Modified:	10/19/2026  Document what the thread-local state allows,
+ *                          and define SAME in the library.
+ *
+*/
+
+#ifndef LIBASSEMBLER_H
+#define LIBASSEMBLER_H
+
+#include "assembler.h"
+
+/* THE DATA STRUCTURES */
+
+typedef struct
+{
+	Options options;	/* the options (-O, -Idir, ...; none after
+				   assemblerInit) */
+	int printErrors;	/* 1 to print the error messages, up to
+				   ERROR_LIMIT, as the command line does; 0
+				   to collect them in diagnostics */
+	MachineCode code;	/* the machine code (text, then data), unless
+				   code.output is set */
+	LabelTable symbols;	/* the labels, with their addresses */
+	int nbrErrors;		/* nbr of errors found */
+	int diagCapacity;	/* capacity of diagnostics */
+	int nbrDiagnostics;	/* actual nbr of error messages collected */
+	char **diagnostics;	/* the error messages, as they would be
+				   printed */
+} Assembler;
+
+/* THE FUNCTIONS */
+
+void assemblerInit(Assembler *as);
+/* Postcondition: as is initialized with no options, to collect the
+         *       error messages, and with no results.
+         */
+
+int assembleStream(Assembler *as, FILE *fp);
+/* Postcondition: the program read from fp has been assembled (or,
+         *      with as->options.check, only checked for errors: every pass
+         *      runs, but no machine code is kept or output), and the
+         *      results of any earlier assembly in as have been replaced
+         *      by its machine code, labels, and error messages.  The
+         *      file is not closed.
+         * Returns the nbr of errors found.
+         */
+
+int assembleBuffer(Assembler *as, const char *source, size_t length,
+                   uint32_t *words, int capacity);
+/* Postcondition: the length characters of assembly source at source
+         *      have been assembled as by assembleStream, and the first
+         *      capacity words of machine code (at most) have been
+         *      stored in words, which may be NULL if capacity is 0.
+         *      The files included are not kept in memory afterwards.
+         * Returns the nbr of words of machine code (more than capacity
+         *      if words is too small); -1 if there were errors.
+         */
+
+void assemblerFree(Assembler *as);
+/* Postcondition: all the memory used by the results in as has been
+         *      freed, and as has no results.
+         */
+
+#endif
@@ -0,0 +1,230 @@
+/*
+ * Memory: functions to allocate memory and count what is used
+ *
+ * This file provides the definitions of the functions through which
+ * the assembler allocates its memory, and that count the allocations
+ * of each subsystem for --mem-stats.  See mem.h.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "assembler.h"
+
+/* The header in front of each block (aligned for any type, as the
+ * block must be).
+ */
+typedef union
+{
+    struct
+    {
+        size_t size;         /* bytes asked for */
+        Subsystem subsystem; /* whom the block is counted against */
+    } info;
+    max_align_t align;
+} BlockHeader;
+
+/* The counts for a subsystem. */
+typedef struct
+{
+    atomic_long allocations; /* blocks allocated (and reallocated) */
+    atomic_long bytes;       /* bytes allocated */
+    atomic_long live;        /* bytes in use */
+    atomic_long blocks;      /* blocks in use */
+    atomic_long peak;        /* the most bytes in use at once */
+} Usage;
+
+/* internal global variables (global to this file only)*/
+static const char *SUBSYSTEM_NAMES[NBR_SUBSYSTEMS] =
+    {"labels", "source", "program", "decode cache", "optimizer", "output", "other"};
+
+static Allocator allocator; /* all NULL: malloc, realloc, and free */
+static Usage usage[NBR_SUBSYSTEMS];
+static atomic_long live;    /* bytes in use, by all the subsystems */
+static atomic_long peak;
+
+/* internal functions (visible to this file only)*/
+static void *rawAlloc(size_t size);
+static void *rawRealloc(void *ptr, size_t size);
+static void rawFree(void *ptr);
+static void tally(Subsystem subsystem, long bytes, long blocks);
+static void raiseTo(atomic_long *max, long value);
+
+void memSetAllocator(const Allocator *newAllocator)
+/* Postcondition: the memory is allocated with newAllocator from now
+   *      on (with malloc, realloc, and free if it is NULL).
+   */
+{
+    if (newAllocator == NULL)
+        memset(&allocator, 0, sizeof(allocator));
+    else
+        allocator = *newAllocator;
+}
+
+void *memAlloc(Subsystem subsystem, size_t size)
+/* Returns a block of size bytes for subsystem (as malloc); NULL if
+   *      memory allocation error.
+   */
+{
+    BlockHeader *header;
+
+    if (size > (size_t)-1 - sizeof(BlockHeader) ||
+        (header = rawAlloc(sizeof(BlockHeader) + size)) == NULL)
+        return NULL;
+
+    header->info.size = size;
+    header->info.subsystem = subsystem;
+    tally(subsystem, (long)size, 1);
+    return header + 1;
+}
+
+void *memCalloc(Subsystem subsystem, size_t count, size_t size)
+/* Returns a block of count items of size bytes each, set to 0, for
+   *      subsystem (as calloc); NULL if memory allocation error.
+   */
+{
+    void *block;
+
+    if (size != 0 && count > (size_t)-1 / size)
+        return NULL; /* count * size would overflow */
+
+    if ((block = memAlloc(subsystem, count * size)) != NULL)
+        memset(block, 0, count * size);
+    return block;
+}
+
+void *memRealloc(Subsystem subsystem, void *ptr, size_t size)
+/* Returns the block ptr (from memAlloc, or NULL for a new block for
+   *      subsystem) resized to size bytes, as realloc; NULL if memory
+   *      allocation error (ptr is left as it was).
+   */
+{
+    BlockHeader *header;
+    size_t oldSize;
+
+    if (ptr == NULL)
+        return memAlloc(subsystem, size);
+
+    header = (BlockHeader *)ptr - 1;
+    oldSize = header->info.size;
+    subsystem = header->info.subsystem; /* it stays whose it was */
+    if (size > (size_t)-1 - sizeof(BlockHeader) ||
+        (header = rawRealloc(header, sizeof(BlockHeader) + size)) == NULL)
+        return NULL;
+
+    /* Count the new size as allocated again, and the old one as freed */
+    header->info.size = size;
+    tally(subsystem, -(long)oldSize, -1);
+    tally(subsystem, (long)size, 1);
+    return header + 1;
+}
+
+char *memStrdup(Subsystem subsystem, const char *s)
+/* Returns a copy of s for subsystem (as strdup); NULL if memory
+   *      allocation error.
+   */
+{
+    size_t size = strlen(s) + 1;
+    char *copy;
+
+    if ((copy = memAlloc(subsystem, size)) != NULL)
+        memcpy(copy, s, size);
+    return copy;
+}
+
+void memFree(void *ptr)
+/* Postcondition: the block ptr (from memAlloc, or NULL) has been freed. */
+{
+    BlockHeader *header;
+
+    if (ptr == NULL)
+        return;
+
+    header = (BlockHeader *)ptr - 1;
+    tally(header->info.subsystem, -(long)header->info.size, -1);
+    rawFree(header);
+}
+
+void memPrint(FILE *fp)
+/* Postcondition: the counts for each subsystem, and what is still in
+   *      use (leaked, if called at exit), have been printed to fp.
+   */
+{
+    long allocations = 0, bytes = 0, blocks = 0;
+    int s;
+
+    fprintf(fp, "%-13s %12s %14s %14s %16s\n", "subsystem", "allocations", "bytes",
+            "peak bytes", "leaked (blocks)");
+    for (s = 0; s < NBR_SUBSYSTEMS; s++)
+    {
+        fprintf(fp, "%-13s %12ld %14ld %14ld %9ld (%ld)\n", SUBSYSTEM_NAMES[s],
+                atomic_load(&usage[s].allocations), atomic_load(&usage[s].bytes),
+                atomic_load(&usage[s].peak), atomic_load(&usage[s].live),
+                atomic_load(&usage[s].blocks));
+        allocations += atomic_load(&usage[s].allocations);
+        bytes += atomic_load(&usage[s].bytes);
+        blocks += atomic_load(&usage[s].blocks);
+    }
+    fprintf(fp, "%-13s %12ld %14ld %14ld %9ld (%ld)\n", "total", allocations, bytes,
+            atomic_load(&peak), atomic_load(&live), blocks);
+}
+
+static void *rawAlloc(size_t size)
+/* Returns a block of size bytes from the allocator; NULL if memory
+   *      allocation error.
+   */
+{
+    if (allocator.allocate != NULL)
+        return allocator.allocate(size, allocator.arg);
+    return malloc(size);
+}
+
+static void *rawRealloc(void *ptr, size_t size)
+/* Returns ptr resized to size bytes by the allocator; NULL if memory
+   *      allocation error.
+   */
+{
+    if (allocator.reallocate != NULL)
+        return allocator.reallocate(ptr, size, allocator.arg);
+    return realloc(ptr, size);
+}
+
+static void rawFree(void *ptr)
+/* Postcondition: ptr has been given back to the allocator. */
+{
+    if (allocator.release != NULL)
+        allocator.release(ptr, allocator.arg);
+    else
+        free(ptr);
+}
+
+static void tally(Subsystem subsystem, long bytes, long blocks)
+/* Postcondition: bytes (freed, if negative) in blocks blocks have been
+   *      counted for subsystem, and for the total.
+   */
+{
+    Usage *u = &usage[subsystem];
+
+    if (blocks > 0)
+    {
+        atomic_fetch_add(&u->allocations, 1);
+        atomic_fetch_add(&u->bytes, bytes);
+    }
+    atomic_fetch_add(&u->blocks, blocks);
+    raiseTo(&u->peak, atomic_fetch_add(&u->live, bytes) + bytes);
+    raiseTo(&peak, atomic_fetch_add(&live, bytes) + bytes);
+}
+
+static void raiseTo(atomic_long *max, long value)
+/* Postcondition: *max is at least value. */
+{
+    long current = atomic_load(max);
+
+    while (value > current && !atomic_compare_exchange_weak(max, &current, value))
+        ;
+}
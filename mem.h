@@ -0,0 +1,99 @@
+/*
+ * Memory: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for a group
+ * of associated functions through which the assembler allocates all of
+ * its memory, so that what it uses can be counted and reported
+ * (--mem-stats) and so that a program that uses the library (see
+ * libassembler.h) can supply its own allocator.
+ *
+ * Each block is allocated for a subsystem (the label tables, the
+ * decoded program, ...), and is counted against it until it is freed:
+ * the nbr of allocations, the bytes allocated, the bytes still in use
+ * and the most that were in use at once (the peak).  What is still in
+ * use at exit has leaked.  The counts are kept for the whole process
+ * (not for each thread as in STATS), since a block may be freed by a
+ * thread other than the one that allocated it.
+ *
+ * To keep the counts, each block starts with a small header (its size
+ * and subsystem), which is why a block from memAlloc must be freed with
+ * memFree, and not with free (and vice versa).
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef MEM_H
+#define MEM_H
+
+#include <stdio.h>
+
+/* THE DATA STRUCTURES */
+
+typedef enum
+{
+	MEM_LABELS,		/* label tables (LabelTable.h) */
+	MEM_SOURCE,		/* macros, included files (Source.h) */
+	MEM_PROGRAM,		/* decoded instructions, data, constants,
+				   and machine code (Program.h) */
+	MEM_CACHE,		/* the decode cache (InstrCache.h) */
+	MEM_OPTIMIZER,		/* the optimizer's programs and CFGs */
+	MEM_OUTPUT,		/* output formats and the pipeline */
+	MEM_OTHER,		/* diagnostics, trace events, ... */
+	NBR_SUBSYSTEMS
+} Subsystem;
+
+/* An allocator, with the same contract as malloc, realloc, and free;
+ * arg is passed to each of its functions.
+ */
+typedef struct
+{
+	void *(*allocate)(size_t size, void *arg);
+	void *(*reallocate)(void *ptr, size_t size, void *arg);
+	void (*release)(void *ptr, void *arg);
+	void *arg;
+} Allocator;
+
+/* THE FUNCTIONS */
+
+void memSetAllocator(const Allocator *allocator);
+/* Postcondition: the memory is allocated with allocator from now on
+         *      (with malloc, realloc, and free if it is NULL).  It must
+         *      be set before anything is allocated, since each block is
+         *      freed by the allocator in use at the time.
+         */
+
+void *memAlloc(Subsystem subsystem, size_t size);
+/* Returns a block of size bytes for subsystem (as malloc); NULL if
+         *      memory allocation error.
+         */
+
+void *memCalloc(Subsystem subsystem, size_t count, size_t size);
+/* Returns a block of count items of size bytes each, set to 0, for
+         *      subsystem (as calloc); NULL if memory allocation error.
+         */
+
+void *memRealloc(Subsystem subsystem, void *ptr, size_t size);
+/* Returns the block ptr (from memAlloc, or NULL for a new block for
+         *      subsystem) resized to size bytes, as realloc; NULL if
+         *      memory allocation error (ptr is left as it was).
+         */
+
+char *memStrdup(Subsystem subsystem, const char *s);
+/* Returns a copy of s for subsystem (as strdup); NULL if memory
+         *      allocation error.
+         */
+
+void memFree(void *ptr);
+/* Postcondition: the block ptr (from memAlloc, or NULL) has been
+         *      freed.
+         */
+
+void memPrint(FILE *fp);
+/* Postcondition: the counts for each subsystem, and what is still in
+         *      use (leaked, if called at exit), have been printed to fp.
+         */
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Optimization passes
+ *
+ * This file provides the declarations for the passes that rewrite a
+ * decoded program between pass1 and pass2.  Each pass
+ * leaves the program laid out again, so that the addresses in the
+ * label table match the rewritten instructions.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+int inlineLeaves(Program *prog, LabelTable *table, int limit);
+/* Replaces every call to a leaf function of at most limit
+		 * instructions with a copy of its body, with its labels renamed
+		 * (see inline.c), and lays the program out again.
+		 * Returns the number of calls that were inlined.
+		 */
+
+int peephole(Program *prog, LabelTable *table);
+/* Applies the peephole rule table to the program until no rule
+		 * matches (see peephole.c for the rules), and lays the program
+		 * out again.
+		 * Returns the number of rewrites that were made.
+		 */
+
+int fillDelaySlots(Program *prog, LabelTable *table);
+/* Fills the delay slot of every branch and jump assembled in .set
+		 * reorder mode with an independent instruction from before it,
+		 * or a nop if there is none (see fillDelaySlots.c), and lays the
+		 * program out again.
+		 * Returns the number of slots filled with a moved instruction.
+		 */
+
+int removeUnreachable(Program *prog, LabelTable *table, int strip);
+/* Reports each run of code that can't be reached from the entry
+		 * (see unreachable.c) on stderr and, if strip is 1, deletes it
+		 * and lays the program out again.
+		 * Returns the number of instructions that can't be reached.
+		 */
+
+int scheduleLoads(Program *prog, LabelTable *table);
+/* Reorders the independent instructions inside each basic block so
+		 * that as few loads as possible are followed right away by a
+		 * use of the register they load (see schedule.c).  Labels,
+		 * branches, and delay slots stay where they are.
+		 * Returns the number of load-use stalls removed.
+		 */
+
+int layoutByProfile(Program *prog, LabelTable *table, char *profileName);
+/* Reorders the basic blocks of the program by the execution counts in
+		 * the file profileName, so that the hottest blocks are together
+		 * and fall through to each other, and the ones that never ran
+		 * are at the end, inverting branches and adding or deleting
+		 * jumps to keep the control flow (see profile.c), and lays the
+		 * program out again.
+		 * Returns the number of blocks moved.
+		 */
+
+int relaxBranches(Program *prog, LabelTable *table);
+/* Rewrites every beq or bne whose target is out of range as the
+		 * opposite branch over a j, and every j whose target is in
+		 * another 256 MB region as a jump through $at (see relax.c),
+		 * until there are none, and lays the program out again.
+		 * Returns the number of branches and jumps that were rewritten.
+		 */
+
+#endif
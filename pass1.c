@@ -1,37 +1,74 @@
 /**
- * LabelTable pass1 (FILE * fp)
- *      @param  fp  pointer to an open file (stdin or other file pointer)
- *                  from which to read lines of assembly source code
+ * LabelTable pass1 (FILE * fp, Program * prog)
+ *      @param  fp    pointer to an open file (stdin or other file pointer)
+ *                    from which to read lines of assembly source code
+ *      @param  prog  an initialized, empty program to which the decoded
+ *                    statements of the input file are added
  *      @return a newly-created table containing labels found in the
  *              input file, each with the address of the instruction
- *              containing it (assuming the first line of input
+ *              containing it (assuming the first instruction
  *              corresponds to address 0)
  *
  * This function reads the lines in an assembly source file and looks
  * for labeled statements.  It builds a table of labels and addresses.
- * It returns a copy of the table it created.  If an error occurs, the
- * function prints an error message and returns the table as it exists
- * at that point (possibly empty).
+ * It also decodes each instruction and adds it to prog, so that pass2
+ * does not need to read the file again.  Only valid instructions take
+ * up space; blank lines, comments, and lines containing only a label
+ * do not advance the program counter.  Directives (tokens starting
+ * with '.') are processed here too (see directives.c); they switch
+ * between the text and data segments, each with its own location
+ * counter, and fill the data segment of prog.  The lines are read
+ * through the front end (see Source.c), which strips off comments
+ * and expands included files, macros, and .rept blocks.
+ * It returns a copy of the table
+ * it created.  If an error occurs, the function prints an error message
+ * and returns the table as it exists at that point (possibly empty).
  *
  * Author: Alyce Brady
  * Date:   2/16/99
  *
  * Modified by:  Alyce Brady, 6/10/2014
  *      Take open file pointer as parameter, rather than filename.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Decode instructions into a Program for pass2 and the optimizer.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Support the .set reorder and .set noreorder directives.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Separate text and data segments; move directives to directives.c.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Read the lines through the front end, which expands macros.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Write a make rule for the included files if -MD is given.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Evaluate the operands that use constants defined later.
+ * Modified by:  Maria Katrantzi, 10/19/2026
+ *      Reuse the decoding of repeated statements (see InstrCache.h).
  *
  */
 
 #include "assembler.h"
+#include "pass1.h"
+#include "pass2.h"
+#include "InstrCache.h"
 
-LabelTable pass1 (FILE * fp)
+LabelTable pass1 (FILE * fp, Program * prog)
   /* returns a copy of the label table that was constructed */
 {
     LabelTable table;              /* the table of labels & addresses */
-    int    PC = 0;                 /* the program counter */
+    Source src;                    /* the lines of the source file */
+    Pass1State state;              /* location counters and mode */
+    InstrCache cache;              /* statements decoded so far */
+    Instruction instrs[MAX_EXPANSION];  /* the decoded instruction(s) */
+    int    lineNum;                /* line number */
+    int    n, k;                   /* nbr of decoded instructions */
+    char * label;                  /* label on the line, or NULL */
     char * tokBegin, * tokEnd;     /* used to step thru inst */
+    char * rest;                   /* the operands of the instruction */
     char   inst[BUFSIZ];           /* will hold instruction; BUFSIZ
                                       is max size of I/O buffer
                                       (defined in stdio.h) */
+    char   key[CACHE_KEY_SIZE];    /* the statement, as a cache key */
+    int    cached;                 /* 1 if the statement has a key */
 
     /* create a small label table to begin with */
     tableInit (&table);
@@ -41,18 +78,27 @@ LabelTable pass1 (FILE * fp)
         return table;
     }
 
+    state.prog = prog;
+    state.table = &table;
+    state.PC = 0;
+    state.inData = 0;
+    state.reorder = 0;
+    sourceInit (&src, fp, OPTIONS.fileName);
+    (void) cacheInit (&cache);     /* grows as statements are stored */
+
     /* Continuously read next line of input until EOF is encountered.
      * Check each line to see if it has a label; if it does, add it
-     * to the label table.
+     * to the label table.  Then process the directive or decode the
+     * instruction, if any.
      */
-    for (PC = 0; fgets (inst, BUFSIZ, fp); PC += 4)
+    while ( readLine (&src, inst, BUFSIZ) )
     {
-        /* If the line starts with a comment, move on to next line.
-         * If there's a comment later in the line, strip it off
-         *  (replace the '#' with a null byte).
+        /* Comments have already been stripped off, and macros
+         * expanded (see Source.c).
          */
-        if ( *inst == '#' ) continue;
-        (void) strtok (inst, "#");
+        lineNum = src.lineNum;
+        ERROR_LINE = lineNum;
+        STATS.lines++;
 
         /* Read the first token, skipping any leading whitespace. */
         tokBegin = inst;
@@ -63,22 +109,110 @@ LabelTable pass1 (FILE * fp)
              */
 
         /* Check each line to see if it has a label; if it does,
-         * process it.
+         * remember it until we know which address it marks.
          */
+        label = NULL;
         if ( *(tokEnd) == ':' )
         {
             /* Line has a label! */
-            *tokEnd = '\0';      /* truncate everything after label */
+            *tokEnd = '\0';      /* truncate label */
+            label = tokBegin;
+
+            /* Get new token! */
+            tokBegin = tokEnd + 1;
+            getToken (&tokBegin, &tokEnd);
+        }
+
+        if ( *tokBegin != '\0' )
+        {
+            /* Turn the token into a string; the operands start at
+             * the character after its end (if there is one).
+             */
+            rest = *tokEnd == '\0' ? tokEnd : tokEnd + 1;
+            *tokEnd = '\0';
+            TRACE(TRACE_LEXER, 2, "%s: first non-label token is %s.\n",
+                  lineName(lineNum), tokBegin);
 
-            /* Add label to table */
-            if (addLabel (&table, tokBegin, PC) == 0)
+            if ( *tokBegin == '.' )
+                processDirective (tokBegin, rest, lineNum, &label, &state);
+            else if ( state.inData )
+                printError ("Unexpected error on %s: instruction %s in the data segment.\n",
+                            lineName(lineNum), tokBegin);
+            else
             {
-                /* error message already printed */
-                continue;
+                /* The label marks the instruction, valid or not. */
+                if ( label != NULL )
+                    (void) defineLabel (&state, label, lineNum);
+                label = NULL;
+
+                /* Only valid instructions are kept and take up space.
+                 * A statement seen before needn't be decoded again.
+                 */
+                for (k = 0; k < MAX_EXPANSION; k++)
+                    memset (&instrs[k], 0, sizeof (Instruction));
+                cached = cacheKey (key, tokBegin, rest);
+                if ( cached && cacheLookup (&cache, key, &instrs[0]) )
+                {
+                    instrs[0].name = tokBegin;
+                    n = 1;
+                }
+                else
+                {
+                    n = parseInstruction (tokBegin, rest, lineNum, instrs, prog);
+                    if ( cached && n == 1 )
+                        cacheStore (&cache, key, &instrs[0]);
+                }
+                for (k = 0; k < n; k++)
+                {
+                    instrs[k].lineNum = lineNum;
+                    instrs[k].address = state.PC;
+                    instrs[k].reorder = state.reorder;
+                    if ( (instrs[k].name = memStrdup (MEM_PROGRAM, instrs[k].name)) == NULL )
+                    {
+                        printError ("Error: cannot allocate space in memory.\n");
+                        for ( ; k < n; k++)
+                        {
+                            memFree (instrs[k].target);
+                            memFree (instrs[k].expr);
+                        }
+                        break;
+                    }
+                    if ( addInstruction (prog, &instrs[k]) == 0 )
+                        break;  /* error message already printed */
+                    state.PC += 4;
+                }
             }
         }
+
+        /* A label on a line of its own (or on a directive that did not
+         * define it) marks the current address.
+         */
+        if ( label != NULL )
+            (void) defineLabel (&state, label, lineNum);
+    }
+
+    TRACE(TRACE_LEXER, 1, "%d lines read, %d statements, %d bytes of data.\n",
+          lineNum, prog->nbrInstrs, prog->data.size);
+
+    /* Now that all the constants are known, the operands that only
+     * use constants have values; the ones that use labels wait for
+     * pass2, since the optimizer may move the labels.
+     */
+    (void) resolveConstants (prog);
+
+    /* Write the make rule (-MD) now that all the included files are
+     * known.
+     */
+    if ( OPTIONS.dependencies )
+    {
+        if ( OPTIONS.fileName == NULL )
+            printError ("Error: -MD needs an input file.\n");
+        else
+            (void) writeDependencies (&src, OPTIONS.fileName);
     }
 
     /* EOF, but don't close the file here. */
+    cacheFree (&cache);
+    sourceFree (&src);
     return table;
 }
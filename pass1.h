@@ -0,0 +1,54 @@
+/*
+ * Pass 1: data structure and associated functions
+ *
+ * This file provides the state that pass1 keeps while it reads an
+ * assembly source file, and the declarations for the functions that
+ * process the directives and labels in it (see directives.c).
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef PASS1_H
+#define PASS1_H
+
+/* The largest n allowed in .align n (a 64K boundary). */
+#define MAX_ALIGN 16
+
+/* The struct Pass1State holds what pass1 knows about the source file
+ * read so far: the program and label table it is building, the location
+ * counters of the text and data segments, and the assembler mode.
+ */
+
+typedef struct
+{
+	Program *prog;		/* the program being built */
+	LabelTable *table;	/* labels in the text and data segments */
+	int PC;			/* location counter of the text segment */
+	int inData;		/* 1 after .data; 0 after .text (default) */
+	int reorder;		/* 1 in .set reorder mode; 0 otherwise */
+} Pass1State;
+
+/* THE FUNCTIONS */
+
+void processDirective(char *name, char *rest, int lineNum, char **label,
+		      Pass1State *state);
+/* Processes the directive name, whose operands are in rest, and
+         *      updates the state accordingly.  If *label is not NULL,
+         *      it is the label on the directive's line; a directive
+         *      that adds data defines it (after any alignment) and sets
+         *      *label to NULL.  Prints an error message if the directive
+         *      or its operands are invalid.
+         */
+
+int defineLabel(Pass1State *state, char *label, int lineNum);
+/* Postcondition: label has been added to the label table with the
+         *      current address in the current segment, and to the
+         *      program (text labels) or its data segment (data labels).
+         *      A duplicate label is reported and otherwise ignored.
+         * Returns 1 if everything went OK; 0 if memory allocation error.
+         */
+
+#endif
@@ -1,117 +1,243 @@
 /**
- * void pass2 (FILE * fp, LabelTable table)
- *      @param  fp  pointer to an open file (stdin or other file pointer)
- *                  from which to read lines of assembly source code
+ * void pass2 (Program * prog, LabelTable table, MachineCode * code)
+ *      @param  prog   the program decoded by pass1 (and possibly
+ *                     rewritten by the optimizer)
  *      @param  table  an existing Label Table
+ *      @param  code   the machine code, to which the words are added
  *
- * This function reads the lines in an assembly source file and 
- * translates each instruction from assembly to machine language 
- * by calling other functions that process each instruction and 
- * determine the right format type.
+ * This function translates each instruction in the program from
+ * assembly to machine language by calling other functions that
+ * encode each instruction according to its format type, and then
+ * adds the contents of the data segment.  printWord prints a word of
+ * machine code to standard output.  The
+ * functions that decode an instruction's operands are also defined
+ * here; pass1 calls them as it reads the source file.
  * 
  * Author: Maria Katrantzi
  *        with assistance from: Josh, Tim, Charlie
  *
  * Creation Date:  5/20/2019
  *   Modified:  5/25/2019   Completed functions and added documentation.
+ *   Modified:  10/19/2026  Decode instructions in pass1 (parse functions)
+ *                          and translate the decoded program here.
+ *   Modified:  10/19/2026  Added the data segment, la, and lw/ sw of a
+ *                          label.
+ *   Modified:  10/19/2026  Count the instructions and bytes written
+ *                          (--stats).
+ *   Modified:  10/19/2026  Encode into words (MachineCode), kept in
+ *                          memory or printed by printWord.
+ *   Modified:  10/19/2026  Immediates, shift amounts, and offsets are
+ *                          expressions (see expr.h), range-checked.
+ *   Modified:  10/19/2026  Look the labels up in a copy of the table
+ *                          sorted by name.
  *
  */
 
 #include "assembler.h"
 #include "pass2.h"
 
-void pass2(FILE *fp, LabelTable table)
-/*  Reads lines from a file pointer and translates each instruction
-		 * from assembly to machine language. The label table, which is 
-		 * constructed in pass1, is used from other functions to check if
-         * a given label exists in the table, and use its address.
+/* internal functions (visible to this file only)*/
+static int parseLoadAddress(char *restOfStmt, int lineNum, Instruction instrs[]);
+static int parseMemoryLabel(char *restOfStmt, int ntok, int lineNum, Instruction instrs[]);
+static int setExpansion(Instruction *instr, char *name, char opType, int code, char *target);
+static void clearOperands(Instruction *instr);
+static char *readRegisters(char *restOfStmt, int n, int regs[], int lineNum);
+static int setOperand(Instruction *instr, char *text, int lineNum, Program *prog);
+static int setImmediate(Instruction *instr, long value, int lineNum);
+static int resolveOperand(Program *prog, LabelTable *table, Instruction *instr);
+static int resolveFixup(Program *prog, LabelTable *table, DataFixup *fixup, long *value);
+static char *operandUse(Instruction *instr);
+static uint32_t field(int value, int high, int length);
+static void endLine(void);
+
+void pass2(Program *prog, LabelTable table, MachineCode *code)
+/*  Translates each instruction in the program from assembly to
+		 * machine language, adding the words to code. The label table,
+		 * which is constructed in pass1, is used from other functions
+		 * to check if a given label exists in the table, and use its
+		 * address.
 		 */
 
 {
-    int lineNum;             /* line number */
-    int PC;                  /* program counter */
-    char *tokBegin, *tokEnd; /* used to step thru inst */
-    char inst[BUFSIZ];       /* will hold instruction; BUFSIZ
-                                      is max size of I/O buffer
-                                      (defined in stdio.h) */
-    char *instrName;         /* instruction name (e.g., "add") */
-
-    /* Continuously read next line of input until EOF is encountered.*/
-    for (lineNum = 1, PC = 0; fgets(inst, BUFSIZ, fp); lineNum++, PC += 4)
-    {
-        /* If the line starts with a comment, move on to next line.
-         * If there's a comment later in the line, strip it off
-         *  (replace the '#' with a null byte).
-         */
-        if (*inst == '#')
-            continue;
-        (void)strtok(inst, "#");
+    LabelTable byName; /* the labels, sorted for the lookups */
+    uint32_t word;
+    int i;
 
-        /* Read the first token, skipping any leading whitespace. */
-        tokBegin = inst;
-        getToken(&tokBegin, &tokEnd);
-        /* tokBegin now points to 1st non-whitespace character
-             * in the token and tokEnd points to 1st punctuation mark
-             * or whitespace after the end of the token.
-             */
+    if (!tableSortedCopy(&byName, &table))
+        return; /* error message already printed */
 
-        /* Skip label, if any */
-        if (*(tokEnd) == ':')
-        {
-            /* Line has a label!  Get new token! */
-            tokBegin = tokEnd + 1;
-            getToken(&tokBegin, &tokEnd);
-        }
+    for (i = 0; i < prog->nbrInstrs; i++)
+    {
+        int k;
 
-        /* If empty line or line containing only a label, get next line */
-        if (*tokBegin == '\0')
-            continue;
+        ERROR_LINE = prog->instrs[i].lineNum;
 
-        /* We have a valid token; turn it into a string and set
-         * tokBegin to point to the character after the end.
+        /* Lines containing only a label have nothing to translate;
+         * .align pads the text segment with nops
          */
-        *tokEnd = '\0';
-        instrName = tokBegin;
-        tokBegin = tokEnd + 1;
-
-        printDebug("first non-label token is: %s.\n", instrName);
+        if (prog->instrs[i].name == NULL)
+        {
+            for (k = 0; k < prog->instrs[i].padding; k += 4)
+            {
+                if (!addWord(code, 0, prog->instrs[i].address + k, prog->instrs[i].lineNum))
+                {
+                    memFree(byName.entries);
+                    return; /* error message already printed */
+                }
+            }
+            continue;
+        }
 
-        /* Process instruction */
-        processInstruction(instrName, tokBegin, lineNum, table, PC);
+        /* Process instruction (nothing is added if it has an error);
+         * an operand that uses labels is evaluated first
+         */
+        TRACE(TRACE_ENCODER, 2, "%s: %s at 0x%x.\n", lineName(prog->instrs[i].lineNum),
+              prog->instrs[i].name, prog->instrs[i].address);
+        if (prog->instrs[i].expr != NULL && !resolveOperand(prog, &table, &prog->instrs[i]))
+            continue;
+        if (processInstruction(&prog->instrs[i], byName, &word) &&
+            !addWord(code, word, prog->instrs[i].address, prog->instrs[i].lineNum))
+        {
+            memFree(byName.entries);
+            return; /* error message already printed */
+        }
     }
+    memFree(byName.entries);
+    code->textWords = code->nbrWords;
+
+    /* The data segment follows the text segment */
+    assembleData(prog, table, code);
 }
 
-void processInstruction(char *instName, char *restOfInstruction, int lineNum, LabelTable table, int PC)
-/* Takes opcode (mnemonic name, e.g., "add"), pointer to the rest of 
-         * the statement, line number, label table, and PC. Calls the 
-         * getOpType function to get the opcode and, from that, determines
-         * the instruction format type.
+int parseInstruction(char *instName, char *restOfInstruction, int lineNum, Instruction instrs[],
+                     Program *prog)
+/* Takes opcode (mnemonic name, e.g., "add"), pointer to the rest of
+         * the statement, line number, and the program so far (for its
+         * constants). Calls the getOpType function
+         * to get the opcode and, from that, determines the instruction
+         * format type and decodes the operands into instrs, which must
+         * have room for MAX_EXPANSION instructions.  A pseudo-instruction
+         * (la, or lw/sw of a label) is expanded into the machine
+         * instructions that implement it.  The name of each instruction
+         * is set to a string that the caller must copy.
+         * Returns the nbr of instructions decoded; 0 if the instruction
+         * is not valid.
 		 */
 {
+    Format f;
+
+    clearOperands(&instrs[0]);
+    instrs[0].name = instName;
+
+    /* nop is shorthand for sll $zero, $zero, 0 */
+    if (strcmp(instName, "nop") == SAME)
+    {
+        char *tokBegin = restOfInstruction, *tokEnd;
+
+        getToken(&tokBegin, &tokEnd);
+        if (*tokBegin != '\0')
+        {
+            printError("Unexpected error on %s: Instruction contains more tokens than expected.\n", lineName(lineNum));
+            return 0;
+        }
+
+        instrs[0].f.code = 0;
+        instrs[0].f.opType = "R";
+        return 1;
+    }
+
+    /* la loads the address of a label */
+    if (strcmp(instName, "la") == SAME)
+        return parseLoadAddress(restOfInstruction, lineNum, instrs);
+
     /* Detrmine opcode or funct number */
-    Format f = getOpType(instName, lineNum);
+    f = getOpType(instName, lineNum);
 
     char *rformat = "R";
     char *iformat = "I";
     char *jformat = "J";
 
+    instrs[0].f = f;
+
     if (f.code != -1 && f.opType != NULL)
     {
         if (strcmp(f.opType, rformat) == SAME)
         {
-            assembleR(f.code, restOfInstruction, lineNum); /* R-format */
+            return parseR(f.code, restOfInstruction, lineNum, &instrs[0], prog); /* R-format */
         }
 
         else if (strcmp(f.opType, iformat) == SAME)
         {
-            assembleI(f.code, restOfInstruction, lineNum, table, PC); /* I-format */
+            return parseI(f.code, restOfInstruction, lineNum, instrs, prog); /* I-format */
         }
 
         else if (strcmp(f.opType, jformat) == SAME)
         {
-            assembleJ(f.code, restOfInstruction, lineNum, table); /* J-format */
+            return parseJ(f.code, restOfInstruction, lineNum, &instrs[0]); /* J-format */
+        }
+    }
+
+    return 0;
+}
+
+int resolveConstants(Program *prog)
+/* Sets the immediate of each instruction whose operand is an
+		 * expression that only uses constants (some of them defined
+		 * after the instruction), so that the optimizer knows it.  The
+		 * expressions that use labels are left to pass2.
+		 * Returns the nbr of expressions left.
+		 */
+{
+    char undefined[BUFSIZ];
+    long value;
+    int left = 0;
+    int i;
+
+    for (i = 0; i < prog->nbrInstrs; i++)
+    {
+        Instruction *instr = &prog->instrs[i];
+
+        if (instr->expr == NULL)
+            continue;
+        if (evaluateIn(prog, NULL, instr->expr, &value, undefined, sizeof(undefined)) != EXPR_OK)
+        {
+            left++;
+            continue; /* reported by pass2, if it has no value then */
         }
+
+        (void)setImmediate(instr, value, instr->lineNum); /* error message printed */
+        memFree(instr->expr);
+        instr->expr = NULL;
     }
+
+    return left;
+}
+
+int processInstruction(Instruction *instr, LabelTable table, uint32_t *word)
+/* Takes a decoded instruction and the label table (sorted by name;
+         * see tableSortedCopy), and calls the assemble function for the
+         * instruction's format type, which stores the machine code in
+         * word.
+         * Returns 1 if the instruction was encoded; 0 if it has an error.
+		 */
+{
+    switch (*instr->f.opType)
+    {
+    case 'R':
+        *word = assembleR(instr); /* R-format */
+        STATS.rFormat++;
+        return 1;
+
+    case 'I':
+        STATS.iFormat++;
+        return assembleI(instr, table, word); /* I-format */
+
+    case 'J':
+        STATS.jFormat++;
+        return assembleJ(instr, table, word); /* J-format */
+    }
+
+    return 0;
 }
 
 Format getOpType(char *instName, int lineNum)
@@ -175,7 +301,7 @@ Format getOpType(char *instName, int lineNum)
     }
 
     /* otherwise print an error message if the instruction name is invalid */
-    printError("Unexpected error on line %d: %s is an invalid Instruction Name.\n", lineNum, instName);
+    printError("Unexpected error on %s: %s is an invalid Instruction Name.\n", lineName(lineNum), instName);
 
     return f;
 }
@@ -200,7 +326,7 @@ int getRegNbr(char *regName, int lineNum)
 
     /* check if the input register name exists in the array, and return the index where it was found*/
     int k;
-    for (k = 0; k <= 32; k++)
+    for (k = 0; k < 32; k++)
     {
         if (strcmp(regArray[k], regName) == SAME)
         {
@@ -209,22 +335,24 @@ int getRegNbr(char *regName, int lineNum)
     }
 
     /* otherwise print an error message if the register name is invalid */
-    printError("Unexpected error on line %d: %s is an invalid Register Name.\n", lineNum, regName);
+    printError("Unexpected error on %s: %s is an invalid Register Name.\n", lineName(lineNum), regName);
 
     return -1;
 }
 
-void assembleR(int opcode, char *restOfStmt, int lineNum)
+int parseR(int opcode, char *restOfStmt, int lineNum, Instruction *instr, Program *prog)
 /* Takes opcode (actually funct number in most cases),
-		 * pointer to the rest of the statement, and line number for
-		 * printing error messages.
-		 * Prints R-format instruction to standard output.
+		 * pointer to the rest of the statement, line number for
+		 * printing error messages, and the program so far (for the
+		 * constants in the shift amount of sll and srl).
+		 * Decodes the R-format operands into instr; returns 1 if they
+		 * are valid, 0 otherwise.
 		 */
 {
     int ntok;
     char *parameters[3];
 
-    /* call getNtokens to determine the layout and print the corresponding machine language instruction */
+    /* call getNtokens to determine the layout and decode the operands */
     if (opcode == 8)
     {
         ntok = getNTokens(restOfStmt, 1, parameters);
@@ -232,7 +360,7 @@ void assembleR(int opcode, char *restOfStmt, int lineNum)
         if (ntok == 0)
         {
             /* parameters[0] contains error message */
-            printError("Unexpected error on line %d: %s\n", lineNum, parameters[0]);
+            printError("Unexpected error on %s: %s\n", lineName(lineNum), parameters[0]);
         }
 
         else
@@ -242,51 +370,23 @@ void assembleR(int opcode, char *restOfStmt, int lineNum)
             /* check if the register name is $ra */
             if (one == 31)
             {
-                printBin(0, 6);
-                printBin(one, 5);
-                printBin(0, 15);
-                printBin(opcode, 6);
-                printf("\n");
+                instr->rs = one;
+                return 1;
             }
         }
     }
 
     else if (opcode == 0 || opcode == 2)
     {
-        ntok = getNTokens(restOfStmt, 3, parameters);
-        if (ntok == 0)
-        {
-            /* parameters[0] contains error message */
-            printError("Unexpected error on line %d: %s\n", lineNum, parameters[0]);
-        }
+        /* the shift amount may be an expression */
+        int regs[2];
+        char *shamt = readRegisters(restOfStmt, 2, regs, lineNum);
 
-        else
+        if (shamt != NULL)
         {
-            int one = getRegNbr(parameters[0], lineNum);
-            int two = getRegNbr(parameters[1], lineNum);
-
-            char *str = parameters[2];
-            if (*(str) != '$')
-            {
-                /* convert string to integer */
-                int shamt = atoi(str);
-
-                if (one != -1 && two != -1)
-                {
-                    printBin(0, 11);
-                    printBin(two, 5);
-                    printBin(one, 5);
-                    printBin(shamt, 5);
-                    printBin(opcode, 6);
-                    printf("\n");
-                }
-            }
-
-            else
-            {
-                /* print error */
-                printError("Unexpected error on line %d: invalid token %s for sll/ srl instruction.\n", lineNum, parameters[2]);
-            }
+            instr->rt = regs[1];
+            instr->rd = regs[0];
+            return setOperand(instr, shamt, lineNum, prog);
         }
     }
 
@@ -297,7 +397,7 @@ void assembleR(int opcode, char *restOfStmt, int lineNum)
         if (ntok == 0)
         {
             /* parameters[0] contains error message */
-            printError("Unexpected error on line %d: %s\n", lineNum, parameters[0]);
+            printError("Unexpected error on %s: %s\n", lineName(lineNum), parameters[0]);
         }
 
         else
@@ -308,30 +408,32 @@ void assembleR(int opcode, char *restOfStmt, int lineNum)
 
             if (one != -1 && two != -1 && three != -1)
             {
-
-                printBin(0, 6);
-                printBin(two, 5);
-                printBin(three, 5);
-                printBin(one, 5);
-                printBin(0, 5);
-                printBin(opcode, 6);
-                printf("\n");
+                instr->rs = two;
+                instr->rt = three;
+                instr->rd = one;
+                return 1;
             }
         }
     }
+
+    return 0;
 }
 
-void assembleI(int opcode, char *restOfStmt, int lineNum, LabelTable table, int PC)
+int parseI(int opcode, char *restOfStmt, int lineNum, Instruction instrs[], Program *prog)
 /* Takes opcode, pointer to the rest of the statement, line number
-		 * (for printing error messages), label table, and PC.
-		 * Prints I-format instruction to standard output.
+		 * (for printing error messages), and the program so far (for the
+		 * constants in the immediate).
+		 * Decodes the I-format operands into instrs (more than one
+		 * instruction for lw or sw of a label); returns the nbr of
+		 * instructions if they are valid, 0 otherwise.
 		 */
 {
 
+    Instruction *instr = &instrs[0];
     int ntok;
     char *parameters[3];
 
-    /* call getNtokens to determine the layout and print the corresponding machine language instruction */
+    /* call getNtokens to determine the layout and decode the operands */
     if (opcode == 4 || opcode == 5)
     {
 
@@ -339,7 +441,7 @@ void assembleI(int opcode, char *restOfStmt, int lineNum, LabelTable table, int
         if (ntok == 0)
         {
             /* parameters[0] contains error message */
-            printError("Unexpected error on line %d: %s\n", lineNum, parameters[0]);
+            printError("Unexpected error on %s: %s\n", lineName(lineNum), parameters[0]);
         }
 
         else
@@ -349,264 +451,613 @@ void assembleI(int opcode, char *restOfStmt, int lineNum, LabelTable table, int
 
             if (one != -1 && two != -1)
             {
-                char *label = parameters[2];
-                int offset = 0;
-
-                /* create a pointer that stores the address of the input LabelTable */
-                LabelTable *tablep;
-                tablep = &table;
-
-                /* check if the label exists in the table  */
-                int add = findLabel(tablep, label);
-
-                /* label is not in the table */
-                if (add == -1)
+                /* the label is looked up in pass2, once all labels are known */
+                if ((instr->target = memStrdup(MEM_PROGRAM, parameters[2])) == NULL)
                 {
-                    /* print error */
-                    printError("Unexpected error on line %d: Label %s not found in the label table.\n", lineNum, label);
+                    printError("Error: cannot allocate space in memory.\n");
+                    return 0;
                 }
 
-                else
-                {
-                    /* calculate offset */
-                    int NPC = PC + 4;
-                    offset = (add - NPC) / 4;
-
-                    printBin(opcode, 6);
-                    printBin(one, 5);
-                    printBin(two, 5);
-                    printBin(offset, 16);
-                    printf("\n");
-                }
+                instr->rs = one;
+                instr->rt = two;
+                return 1;
             }
         }
     }
 
     else if (opcode == 15)
     {
-        ntok = getNTokens(restOfStmt, 2, parameters);
+        int regs[1];
+        char *imm = readRegisters(restOfStmt, 1, regs, lineNum);
 
-        if (ntok == 0)
+        if (imm != NULL)
         {
-            /* parameters[0] contains error message */
-            printError("Unexpected error on line %d: %s\n", lineNum, parameters[0]);
+            instr->rt = regs[0];
+            return setOperand(instr, imm, lineNum, prog);
         }
+    }
 
-        else
+    else if (opcode == 35 || opcode == 43)
+    {
+        /* lw rt, offset(rs), where offset is an expression (zero if
+         * it is left out), or lw rt, offset, from address 0; a label
+         * instead of an offset accesses the label's address
+         */
+        char operands[BUFSIZ];
+        char *offset, *open, *base = NULL;
+        int regs[1];
+        size_t n;
+
+        (void)snprintf(operands, sizeof(operands), "%s", restOfStmt);
+        if ((offset = readRegisters(operands, 1, regs, lineNum)) == NULL)
+            return 0;
+
+        /* the base register is the one in parentheses at the end */
+        n = strlen(offset);
+        if (offset[n - 1] == ')' && (open = strrchr(offset, '(')) != NULL)
         {
-            int one = getRegNbr(parameters[0], lineNum);
+            char *before = open;
 
-            if (one != -1)
+            while (before > offset && isspace((unsigned char)before[-1]))
+                before--;
+            if (open[1] == '$' || (before > offset && (isalnum((unsigned char)before[-1]) ||
+                                                       strchr("_.)", before[-1]) != NULL)))
             {
-                char *str = parameters[1];
+                *before = '\0';
+                offset[n - 1] = '\0';
+                base = open + 1;
+                while (isspace((unsigned char)*base))
+                    base++;
+                for (n = strlen(base); n > 0 && isspace((unsigned char)base[n - 1]); n--)
+                    base[n - 1] = '\0';
+            }
+        }
 
-                if (*(str) != '$')
-                {
+        if (isName(offset) && findEquate(prog, offset) == NULL)
+            return parseMemoryLabel(restOfStmt, base != NULL ? 3 : 2, lineNum, instrs);
 
-                    /* convert string to integer */
-                    int two = atoi(str);
+        if (base != NULL && (instr->rs = getRegNbr(base, lineNum)) == -1)
+            return 0;
+        instr->rt = regs[0];
+        if (*offset == '\0' && base != NULL)
+            return 1;
+        return setOperand(instr, offset, lineNum, prog);
+    }
 
-                    printBin(opcode, 6);
-                    printBin(0, 5);
-                    printBin(one, 5);
-                    printBin(two, 16);
-                    printf("\n");
-                }
+    else
+    {
+        int regs[2];
+        char *imm = readRegisters(restOfStmt, 2, regs, lineNum);
 
-                else
-                {
-                    /* print error */
-                    printError("Unexpected error on line %d: invalid token %s for lui instruction.\n", lineNum, parameters[2]);
-                }
-            }
+        if (imm != NULL)
+        {
+            instr->rs = regs[1];
+            instr->rt = regs[0];
+            return setOperand(instr, imm, lineNum, prog);
         }
     }
 
-    else if (opcode == 35 || opcode == 43)
+    return 0;
+}
+
+int parseJ(int opcode, char *restOfStmt, int lineNum, Instruction *instr)
+/* Takes opcode, pointer to the rest of the statement, and
+		 * line number (for printing error messages).
+		 * Decodes the J-format operand into instr; returns 1 if it
+		 * is valid, 0 otherwise.
+		 */
+{
+    int ntok;
+    char *parameters[1];
+
+    (void)opcode; /* every J-format instruction has the same layout */
+
+    /* call getNtokens to determine the layout and decode the operand */
+    ntok = getNTokens(restOfStmt, 1, parameters);
+
+    if (ntok == 0)
     {
-        ntok = getNTokens(restOfStmt, 3, parameters);
+        /* parameters[0] contains error message */
+        printError("Unexpected error on %s: %s\n", lineName(lineNum), parameters[0]);
+        return 0;
+    }
 
-        if (ntok == 0)
-        {
-            /* parameters[0] contains error message */
-            printError("Unexpected error on line %d: %s\n", lineNum, parameters[0]);
-        }
+    /* the label is looked up in pass2, once all labels are known */
+    if ((instr->target = memStrdup(MEM_PROGRAM, parameters[0])) == NULL)
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return 0;
+    }
 
-        else
-        {
-            int one = getRegNbr(parameters[0], lineNum);
-            int two = getRegNbr(parameters[2], lineNum);
+    return 1;
+}
 
-            if (one != -1 && two != -1)
-            {
-                char *str = parameters[1];
+int isLabelName(char *token)
+/* Returns 1 if token can be a label (it starts with a letter, an
+		 * underscore, or a period), rather than a number or a register;
+		 * 0 otherwise.
+		 */
+{
+    return isalpha((unsigned char)*token) || *token == '_' || *token == '.';
+}
 
-                if (*(str) != '$')
-                {
-                    /* convert string to integer */
-                    int offset = atoi(str);
-
-                    printBin(opcode, 6);
-                    printBin(two, 5);
-                    printBin(one, 5);
-                    printBin(offset, 16);
-                    printf("\n");
-                }
+static int parseLoadAddress(char *restOfStmt, int lineNum, Instruction instrs[])
+/* Decodes la rt, label into lui $at, %hi(label) followed by
+		 * addiu rt, $at, %lo(label).
+		 * Returns 2 if the operands are valid, 0 otherwise.
+		 */
+{
+    char *parameters[2];
+    int rt;
 
-                else
-                {
-                    /* print error */
-                    printError("Unexpected error on line %d: invalid token %s for lw/ sw instruction.\n", lineNum, parameters[2]);
-                }
-            }
-        }
+    if (getNTokens(restOfStmt, 2, parameters) == 0)
+    {
+        /* parameters[0] contains error message */
+        printError("Unexpected error on %s: %s\n", lineName(lineNum), parameters[0]);
+        return 0;
     }
-    else
+
+    if ((rt = getRegNbr(parameters[0], lineNum)) == -1)
+        return 0;
+    if (!isLabelName(parameters[1]))
     {
-        ntok = getNTokens(restOfStmt, 3, parameters);
+        printError("Unexpected error on %s: invalid token %s for la instruction.\n", lineName(lineNum), parameters[1]);
+        return 0;
+    }
 
-        if (ntok == 0)
+    if (!setExpansion(&instrs[0], "lui", 'I', 15, parameters[1]))
+        return 0;
+    if (!setExpansion(&instrs[1], "addiu", 'I', 9, parameters[1]))
+    {
+        memFree(instrs[0].target);
+        return 0;
+    }
+    instrs[0].rt = 1;
+    instrs[1].rs = 1;
+    instrs[1].rt = rt;
+    return 2;
+}
+
+static int parseMemoryLabel(char *restOfStmt, int ntok, int lineNum, Instruction instrs[])
+/* Decodes lw/ sw rt, label (ntok is 2) into lui $at, %hi(label)
+		 * followed by lw/ sw rt, %lo(label)($at), and lw/ sw rt,
+		 * label(rs) (ntok is 3) the same way, with addu $at, $at, rs in
+		 * between.  instrs[0] already holds the lw or sw format.
+		 * Returns the nbr of instructions if the operands are valid,
+		 * 0 otherwise.
+		 */
+{
+    Instruction access = instrs[0];
+    char *parameters[3];
+    int rt, base = 0;
+    int n = 0;
+
+    if (getNTokens(restOfStmt, ntok, parameters) == 0)
+    {
+        /* parameters[0] contains error message */
+        printError("Unexpected error on %s: %s\n", lineName(lineNum), parameters[0]);
+        return 0;
+    }
+
+    if ((rt = getRegNbr(parameters[0], lineNum)) == -1)
+        return 0;
+    if (ntok == 3 && (base = getRegNbr(parameters[2], lineNum)) == -1)
+        return 0;
+    if (!isLabelName(parameters[1]))
+    {
+        printError("Unexpected error on %s: invalid token %s for lw/ sw instruction.\n", lineName(lineNum), parameters[1]);
+        return 0;
+    }
+
+    /* the expansion overwrites $at */
+    if (base == 1 || (rt == 1 && access.f.code == 43))
+    {
+        printError("Unexpected error on %s: $at cannot be used with the address of a label.\n", lineName(lineNum));
+        return 0;
+    }
+
+    if (!setExpansion(&instrs[n++], "lui", 'I', 15, parameters[1]))
+        return 0;
+    instrs[0].rt = 1;
+
+    if (ntok == 3)
+    {
+        (void)setExpansion(&instrs[n++], "addu", 'R', 33, NULL);
+        instrs[1].rd = instrs[1].rs = 1;
+        instrs[1].rt = base;
+    }
+
+    if (!setExpansion(&instrs[n], access.name, 'I', access.f.code, parameters[1]))
+    {
+        memFree(instrs[0].target);
+        return 0;
+    }
+    instrs[n].rs = 1;
+    instrs[n].rt = rt;
+    return n + 1;
+}
+
+static int setExpansion(Instruction *instr, char *name, char opType, int code, char *target)
+/* Makes instr the instruction with the given name, format, and code,
+		 * with all operands zero, and a copy of target (unless it is NULL)
+		 * as its label operand.
+		 * Returns 1 if everything went OK; 0 if memory allocation error.
+		 */
+{
+    clearOperands(instr);
+    instr->name = name;
+    instr->f.code = code;
+    instr->f.opType = opType == 'R' ? "R" : "I";
+
+    if (target != NULL && (instr->target = memStrdup(MEM_PROGRAM, target)) == NULL)
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+static void clearOperands(Instruction *instr)
+/* Sets all the operands of instr to zero (and its label and expression
+		 * operands to NULL).
+		 */
+{
+    instr->rs = instr->rt = instr->rd = 0;
+    instr->shamt = instr->imm = 0;
+    instr->target = NULL;
+    instr->expr = NULL;
+}
+
+static char *readRegisters(char *restOfStmt, int n, int regs[], int lineNum)
+/* Reads the n register operands at the beginning of restOfStmt into
+		 * regs.
+		 * Returns the rest of the statement after them (the last
+		 * operand, which may be an expression), without the whitespace
+		 * around it; NULL if a register is not valid or nothing comes
+		 * after them (an error message is printed).
+		 */
+{
+    char *tokBegin = restOfStmt, *tokEnd;
+    size_t length;
+    int k;
+
+    for (k = 0; k < n; k++)
+    {
+        char delimiter;
+
+        getToken(&tokBegin, &tokEnd);
+        if (*tokBegin == '\0' || *tokEnd == '\0')
         {
-            /* parameters[0] contains error message */
-            printError("Unexpected error on line %d: %s\n", lineNum, parameters[0]);
+            printError("Unexpected error on %s: Instruction contains fewer tokens than expected.\n", lineName(lineNum));
+            return NULL;
         }
 
-        else
-        {
-            int one = getRegNbr(parameters[0], lineNum);
-            int two = getRegNbr(parameters[1], lineNum);
+        /* Turn the token into a string, and skip the comma after it */
+        delimiter = *tokEnd;
+        *tokEnd = '\0';
+        if ((regs[k] = getRegNbr(tokBegin, lineNum)) == -1)
+            return NULL;
+        for (tokBegin = tokEnd + 1; isspace((unsigned char)*tokBegin); tokBegin++)
+            ;
+        if (delimiter != ',' && *tokBegin == ',')
+            tokBegin++;
+    }
 
-            if (one != -1 && two != -1)
-            {
-                char *str = parameters[2];
+    while (isspace((unsigned char)*tokBegin))
+        tokBegin++;
+    for (length = strlen(tokBegin); length > 0 && isspace((unsigned char)tokBegin[length - 1]); length--)
+        tokBegin[length - 1] = '\0';
+    if (*tokBegin == '\0')
+    {
+        printError("Unexpected error on %s: Instruction contains fewer tokens than expected.\n", lineName(lineNum));
+        return NULL;
+    }
 
-                if (*(str) != '$')
-                {
+    return tokBegin;
+}
 
-                    /* convert string to integer */
-                    int offset = atoi(str);
+static int setOperand(Instruction *instr, char *text, int lineNum, Program *prog)
+/* Sets the immediate of instr (the shift amount of sll and srl) to the
+		 * value of the expression text, if it only uses numbers and the
+		 * constants defined so far; otherwise, keeps a copy of text to
+		 * be evaluated in pass2, once the labels are known.
+		 * Returns 1 if text is valid; 0 otherwise (an error message is
+		 * printed).
+		 */
+{
+    char undefined[BUFSIZ];
+    long value;
+    int status;
 
-                    printBin(opcode, 6);
-                    printBin(two, 5);
-                    printBin(one, 5);
-                    printBin(offset, 16);
-                    printf("\n");
-                }
+    if (strchr(text, ',') != NULL)
+    {
+        printError("Unexpected error on %s: Instruction contains more tokens than expected.\n", lineName(lineNum));
+        return 0;
+    }
 
-                else
-                {
-                    /* print error */
-                    printError("Unexpected error on line %d: invalid token %s for I-format instruction.\n", lineNum, parameters[2]);
-                }
-            }
-        }
+    status = evaluateIn(prog, NULL, text, &value, undefined, sizeof(undefined));
+    if (status == EXPR_OK)
+        return setImmediate(instr, value, lineNum);
+    if (status != EXPR_UNDEFINED)
+    {
+        expressionError(status, text, undefined, operandUse(instr), lineNum);
+        return 0;
     }
+
+    if ((instr->expr = memStrdup(MEM_PROGRAM, text)) == NULL)
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return 0;
+    }
+
+    return 1;
 }
 
-void assembleJ(int opcode, char *restOfStmt, int lineNum, LabelTable table)
-/* Takes opcode, pointer to the rest of the statement,
-		 * line number (for printing error messages), and label table.
-		 * Prints J-format instruction to standard output.
+static int setImmediate(Instruction *instr, long value, int lineNum)
+/* Sets the immediate of instr (the shift amount of sll and srl) to
+		 * value, which must fit in the field: 0 to 31 for a shift
+		 * amount, 0 to 65535 for andi, ori, and lui (which don't
+		 * sign-extend it), and -32768 to 32767 otherwise.
+		 * Returns 1 if value fits; 0 otherwise (an error message is
+		 * printed).
 		 */
 {
-    int ntok;
-    char *parameters[1];
+    long min = -32768, max = 32767;
 
-    /* call getNtokens to determine the layout and print the corresponding machine language instruction */
-    ntok = getNTokens(restOfStmt, 1, parameters);
+    if (*instr->f.opType == 'R')
+        min = 0, max = 31;
+    else if (instr->f.code == 12 || instr->f.code == 13 || instr->f.code == 15)
+        min = 0, max = 65535;
 
-    if (ntok == 0)
+    if (value < min || value > max)
     {
-        /* parameters[0] contains error message */
-        printError("Unexpected error on line %d: %s\n", lineNum, parameters[0]);
+        printError("Unexpected error on %s: %ld is out of range for %s.\n", lineName(lineNum), value, instr->name);
+        return 0;
     }
 
+    if (*instr->f.opType == 'R')
+        instr->shamt = (int)value;
     else
+        instr->imm = (int)value;
+    return 1;
+}
+
+static int resolveOperand(Program *prog, LabelTable *table, Instruction *instr)
+/* Sets the immediate of instr to the value of its expression, with the
+		 * addresses of the labels in table.
+		 * Returns 1 if the expression has a value that fits; 0 otherwise
+		 * (an error message is printed).
+		 */
+{
+    char undefined[BUFSIZ];
+    long value;
+    int status = evaluateIn(prog, table, instr->expr, &value, undefined, sizeof(undefined));
+
+    if (status != EXPR_OK)
     {
-        char *label = parameters[0];
-        int address = 0;
+        expressionError(status, instr->expr, undefined, operandUse(instr), instr->lineNum);
+        return 0;
+    }
 
-        /* create a pointer that stores the address of the input LabelTable */
-        LabelTable *tablep;
-        tablep = &table;
+    return setImmediate(instr, value, instr->lineNum);
+}
 
+static int resolveFixup(Program *prog, LabelTable *table, DataFixup *fixup, long *value)
+/* Works out the value of the expression of fixup into *value, with the
+		 * addresses of the labels in table.
+		 * Returns 1 if it has a value that fits in the item; 0 otherwise
+		 * (an error message is printed).
+		 */
+{
+    char undefined[BUFSIZ];
+    long min = -(1L << (8 * fixup->size - 1)); /* smallest signed value */
+    long max = (1L << (8 * fixup->size)) - 1;  /* largest unsigned value */
+    int status = evaluateIn(prog, table, fixup->expr, value, undefined, sizeof(undefined));
+
+    if (status == EXPR_OK && (*value < min || *value > max))
+        status = EXPR_INVALID;
+    if (status != EXPR_OK)
+    {
+        expressionError(status, fixup->expr, undefined, "data directive", fixup->lineNum);
+        return 0;
+    }
+
+    return 1;
+}
+
+static char *operandUse(Instruction *instr)
+/* Returns what the expression operand of instr is for, in the words
+		 * of the error messages (e.g., "lui instruction").
+		 */
+{
+    if (*instr->f.opType == 'R')
+        return "sll/ srl instruction";
+    if (instr->f.code == 15)
+        return "lui instruction";
+    if (instr->f.code == 35 || instr->f.code == 43)
+        return "lw/ sw instruction";
+    return "I-format instruction";
+}
+
+uint32_t assembleR(Instruction *instr)
+/* Takes a decoded R-format instruction.
+		 * Returns the R-format machine code.
+		 */
+{
+    return field(0, 31, 6) | field(instr->rs, 25, 5) | field(instr->rt, 20, 5) |
+           field(instr->rd, 15, 5) | field(instr->shamt, 10, 5) | field(instr->f.code, 5, 6);
+}
+
+int assembleI(Instruction *instr, LabelTable table, uint32_t *word)
+/* Takes a decoded I-format instruction and the label table (sorted
+		 * by name; see tableSortedCopy).
+		 * Stores the I-format machine code in word.
+		 * Returns 1 if the instruction was encoded; 0 if its label is
+		 * not in the table or out of range.
+		 */
+{
+    int imm = instr->imm;
+
+    /* beq and bne branch to a label; lui and the other instructions
+     * of an expanded la, lw, or sw use half of its address
+     */
+    if (instr->target != NULL)
+    {
         /* check if the label exists in the table  */
-        int add = findLabel(tablep, label);
+        int add = findSortedLabel(&table, instr->target);
+
+        TRACE(TRACE_LABELS, 2, "%s: %s is 0x%x.\n", lineName(instr->lineNum), instr->target, add);
 
         /* label is not in the table */
         if (add == -1)
         {
             /* print error */
-            printError("Unexpected error on line %d: Label %s not found in the label table.\n", lineNum, label);
+            printError("Unexpected error on %s: Label %s not found in the label table.\n", lineName(instr->lineNum), instr->target);
+            return 0;
         }
 
-        else
+        if (instr->f.code == 4 || instr->f.code == 5)
         {
-            /* calculate address */
-            address = add / 4;
+            /* calculate offset */
+            int NPC = instr->address + 4;
+            imm = (add - NPC) / 4;
 
-            printBin(opcode, 6);
-            printBin(address, 26);
-            printf("\n");
+            /* relaxBranches rewrites the branches that can't reach */
+            if (imm < -32768 || imm > 32767)
+            {
+                printError("Unexpected error on %s: branch to %s is out of range.\n",
+                           lineName(instr->lineNum), instr->target);
+                return 0;
+            }
+        }
+        else if (instr->f.code == 15)
+        {
+            /* %hi: the upper half, adjusted for the sign of the lower half */
+            imm = (int)(((unsigned int)add + 0x8000) >> 16);
+        }
+        else
+        {
+            /* %lo: the lower half, which the instruction sign-extends */
+            imm = (int)(short)(add & 0xFFFF);
         }
     }
+
+    *word = field(instr->f.code, 31, 6) | field(instr->rs, 25, 5) | field(instr->rt, 20, 5) |
+            field(imm, 15, 16);
+    return 1;
 }
 
-void printBin(int n, int length)
-/* Takes a numeric value and prints the binary format to
-		 * standard output as characters.  The length specifies how
-		 * many binary digits to print.
-		 * E.g., printBin (3, 5) would print 00011 to stdout (the binary
-		 * representation for the number 3, expressed using 5 characters).
+int assembleJ(Instruction *instr, LabelTable table, uint32_t *word)
+/* Takes a decoded J-format instruction and the label table (sorted
+		 * by name; see tableSortedCopy).
+		 * Stores the J-format machine code in word.
+		 * Returns 1 if the instruction was encoded; 0 if its label is
+		 * not in the table or out of range.
 		 */
 {
-    /* use malloc function to allocate space for the string */
-    char *dest = (char *)malloc(sizeof(char) * (length + 1));
+    /* check if the label exists in the table  */
+    int add = findSortedLabel(&table, instr->target);
 
-    /* create a count to keep track of the pointer's dest position */
-    int count = 0;
+    TRACE(TRACE_LABELS, 2, "%s: %s is 0x%x.\n", lineName(instr->lineNum), instr->target, add);
 
-    while (n > 0)
+    /* label is not in the table */
+    if (add == -1)
     {
-        /* calculate remainder */
-        int rem = n % 2;
+        /* print error */
+        printError("Unexpected error on %s: Label %s not found in the label table.\n", lineName(instr->lineNum), instr->target);
+        return 0;
+    }
 
-        /* write appropriate character */
-        if (rem == 0)
-            *dest = '0';
-        else
-            *dest = '1';
+    /* the target must be in the same 256 MB region as the next instruction */
+    if ((((unsigned int)instr->address + 4) ^ (unsigned int)add) & 0xF0000000u)
+    {
+        printError("Unexpected error on %s: %s to %s is out of range.\n",
+                   lineName(instr->lineNum), instr->name, instr->target);
+        return 0;
+    }
 
-        /* divide integer by 2 */
-        n = n / 2;
+    /* calculate address */
+    int address = add / 4;
 
-        /* dest points to the next position in the string */
-        dest++;
+    *word = field(instr->f.code, 31, 6) | field(address, 25, 26);
+    return 1;
+}
 
-        /* increment count */
-        count++;
+void assembleData(Program *prog, LabelTable table, MachineCode *code)
+/* Takes the program, the label table, and the machine code.
+		 * Fills in the items of the data segment that use labels, then
+		 * adds the data segment to the machine code.
+		 */
+{
+    DataSegment *data = &prog->data;
+    long value;
+    int i, k;
+
+    for (i = 0; i < data->nbrFixups; i++)
+    {
+        DataFixup *fixup = &data->fixups[i];
+
+        ERROR_LINE = fixup->lineNum;
+        if (!resolveFixup(prog, &table, fixup, &value))
+            continue; /* error message already printed */
+
+        /* store the value, most significant byte first */
+        for (k = 0; k < fixup->size; k++)
+            data->bytes[fixup->offset + k] =
+                (unsigned char)((unsigned long)value >> (8 * (fixup->size - 1 - k)));
     }
 
-    /* fill up any empty spaces at the end of the string with '0' characters */
-    while (count < length)
+    for (i = 0; i < data->size; i += 4)
     {
-        *dest = '0';
-        dest++;
-        count++;
+        if (!addWord(code, (uint32_t)dataWord(data, i), DATA_BASE + i, 0))
+            return; /* error message already printed */
     }
+}
 
-    /* add the null byte to end of the string */
-    *dest = '\0';
+void printWord(uint32_t word, int address, int lineNum)
+/* Prints a word of machine code to standard output, in binary, on a
+		 * line of its own.  Its address and source line are not
+		 * printed.
+		 */
+{
+    (void)address;
+    (void)lineNum;
 
-    /* dest points to the character before the null byte */
-    dest--;
+    printBin((int)word, 32);
+    endLine();
+}
 
+void printBin(int n, int length)
+/* Takes a numeric value and prints the binary format to
+		 * standard output as characters.  The length specifies how
+		 * many binary digits to print.
+		 * E.g., printBin (3, 5) would print 00011 to stdout (the binary
+		 * representation for the number 3, expressed using 5 characters).
+		 * Negative values are printed in two's complement, and only the
+		 * lowest length bits are printed.
+		 */
+{
+    unsigned int bits = (unsigned int)n;
     int k;
 
-    /* print the characters in reverse order */
-    for (k = 1; k <= length; k++)
-    {
-        printf("%c", *dest);
-        dest--;
-    }
-}
\ No newline at end of file
+    /* print the bits from the most significant one down */
+    for (k = length - 1; k >= 0; k--)
+        putchar((bits >> k) & 1 ? '1' : '0');
+    STATS.bytesWritten += length;
+}
+
+static void endLine(void)
+/* Ends the line of machine code being printed to standard output. */
+{
+    putchar('\n');
+    STATS.bytesWritten++;
+}
+
+static uint32_t field(int value, int high, int length)
+/* Returns the lowest length bits of value (in two's complement),
+   * shifted so that the highest of them is bit number high of a word.
+   */
+{
+    return ((uint32_t)value & ((1u << length) - 1)) << (high - length + 1);
+}
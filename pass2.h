@@ -1,46 +1,71 @@
 /*
  * Pass 2: data structure and associated functions
  *
- * This file provides the data structure and declarations for a group
- * of associated functions useful for translating an instruction from
- * assembly to machine language.
+ * This file provides the declarations for a group of associated
+ * functions useful for translating an instruction from assembly to
+ * machine language.  The Format and Instruction data structures they
+ * share with pass1 are defined in Program.h.
  *
  * Author: Maria Katrantzi
  *
  * Creation Date:	5/20/2019
  *   Modified:	5/25/2019   Updated functions' description.
+ *   Modified:	10/19/2026  Split decoding (parse functions, used by
+ *                          pass1) from encoding (assemble functions).
+ *   Modified:	10/19/2026  Added pseudo-instruction expansion and the
+ *                          data segment.
+ *   Modified:	10/19/2026  Encode into words (MachineCode).
+ *   Modified:	10/19/2026  Operands that are expressions (see expr.h).
  *
 */
 
 #ifndef PASS2_H
 #define PASS2_H
 
-/* THE DATA STRUCTURES */
-
-/* The struct Format is used to store the code(opcode or funct number)
- *  and the format('R', 'I', 'J') of an instruction.
+/* The largest nbr of instructions that one source instruction expands
+ * into (lw $t0, label($t1) becomes lui, addu, and lw).
  */
-
-typedef struct
-{
-	int code;	 /* instruction code */
-	char *opType; /* instruction format */
-} Format;
+#define MAX_EXPANSION 3
 
 /* THE FUNCTIONS */
 
-void pass2(FILE *fp, LabelTable table);
-/*  Reads lines from a file pointer and translates each instruction
-		 * from assembly to machine language. The label table, which is 
-		 * constructed in pass1, is used from other functions to check if
-         * a given label exists in the table, and use its address.
+void pass2(Program *prog, LabelTable table, MachineCode *code);
+/*  Translates each instruction in the program from assembly to
+		 * machine language, adding the words to code. The label table,
+		 * which is constructed in pass1, is used from other functions
+		 * to check if a given label exists in the table, and use its
+		 * address.
 		 */
 
-void processInstruction(char *instName, char *restOfInstruction, int lineNum, LabelTable table, int PC);
-/* Takes opcode (mnemonic name, e.g., "add"), pointer to the rest of 
-         * the statement, line number, label table, and PC. Calls the 
-         * getOpType function to get the opcode and, from that, determines
-         * the instruction format type.
+int parseInstruction(char *instName, char *restOfInstruction, int lineNum, Instruction instrs[],
+                     Program *prog);
+/* Takes opcode (mnemonic name, e.g., "add"), pointer to the rest of
+         * the statement, line number, and the program so far (for its
+         * constants). Calls the getOpType function
+         * to get the opcode and, from that, determines the instruction
+         * format type and decodes the operands into instrs, which must
+         * have room for MAX_EXPANSION instructions.  A pseudo-instruction
+         * (la, or lw/sw of a label) is expanded into the machine
+         * instructions that implement it.  The name of each instruction
+         * is set to a string that the caller must copy.
+         * Returns the nbr of instructions decoded; 0 if the instruction
+         * is not valid.
+		 */
+
+int resolveConstants(Program *prog);
+/* Sets the immediate of each instruction whose operand is an
+		 * expression that only uses constants (some of them defined
+		 * after the instruction), so that the optimizer knows it.  The
+		 * expressions that use labels are left to pass2.
+		 * Returns the nbr of expressions left.
+		 */
+
+int processInstruction(Instruction *instr, LabelTable table, uint32_t *word);
+/* Takes a decoded instruction and the label table (sorted by name;
+         * see tableSortedCopy), and calls the assemble function for the
+         * instruction's format type, which stores the machine code in
+         * word.
+         * Returns 1 if the instruction was encoded; 0 if it has an error.
 		 */
 
 Format getOpType(char *instName, int lineNum);
@@ -54,23 +79,68 @@ int getRegNbr(char *regName, int lineNum);
 		 *	Takes line number as input for printing error messages.
 		 */
 
-void assembleR(int opcode, char *restOfStmt, int line);
+int isLabelName(char *token);
+/* Returns 1 if token can be a label (it starts with a letter, an
+		 * underscore, or a period), rather than a number or a register;
+		 * 0 otherwise.
+		 */
+
+int parseR(int opcode, char *restOfStmt, int line, Instruction *instr, Program *prog);
 /* Takes opcode (actually funct number in most cases),
-		 * pointer to the rest of the statement, and line number for
-		 * printing error messages.
-		 * Prints R-format instruction to standard output.
+		 * pointer to the rest of the statement, line number for
+		 * printing error messages, and the program so far (for the
+		 * constants in the shift amount of sll and srl).
+		 * Decodes the R-format operands into instr; returns 1 if they
+		 * are valid, 0 otherwise.
 		 */
 
-void assembleI(int opcode, char *restOfStmt, int lineNum, LabelTable table, int PC);
+int parseI(int opcode, char *restOfStmt, int lineNum, Instruction instrs[], Program *prog);
 /* Takes opcode, pointer to the rest of the statement, line number
-		 * (for printing error messages), label table, and PC.
-		 * Prints I-format instruction to standard output.
+		 * (for printing error messages), and the program so far (for the
+		 * constants in the immediate).
+		 * Decodes the I-format operands into instrs (more than one
+		 * instruction for lw or sw of a label); returns the nbr of
+		 * instructions if they are valid, 0 otherwise.
+		 */
+
+int parseJ(int opcode, char *restOfStmt, int line, Instruction *instr);
+/* Takes opcode, pointer to the rest of the statement, and
+		 * line number (for printing error messages).
+		 * Decodes the J-format operand into instr; returns 1 if it
+		 * is valid, 0 otherwise.
+		 */
+
+uint32_t assembleR(Instruction *instr);
+/* Takes a decoded R-format instruction.
+		 * Returns the R-format machine code.
+		 */
+
+int assembleI(Instruction *instr, LabelTable table, uint32_t *word);
+/* Takes a decoded I-format instruction and the label table (sorted
+		 * by name; see tableSortedCopy).
+		 * Stores the I-format machine code in word.
+		 * Returns 1 if the instruction was encoded; 0 if its label is
+		 * not in the table or out of range.
+		 */
+
+int assembleJ(Instruction *instr, LabelTable table, uint32_t *word);
+/* Takes a decoded J-format instruction and the label table (sorted
+		 * by name; see tableSortedCopy).
+		 * Stores the J-format machine code in word.
+		 * Returns 1 if the instruction was encoded; 0 if its label is
+		 * not in the table or out of range.
+		 */
+
+void assembleData(Program *prog, LabelTable table, MachineCode *code);
+/* Takes the program, the label table, and the machine code.
+		 * Fills in the items of the data segment that use labels, then
+		 * adds the data segment to the machine code.
 		 */
 
-void assembleJ(int opcode, char *restOfStmt, int line, LabelTable table);
-/* Takes opcode, pointer to the rest of the statement,
-		 * line number (for printing error messages), and label table.
-		 * Prints J-format instruction to standard output.
+void printWord(uint32_t word, int address, int lineNum);
+/* Prints a word of machine code to standard output, in binary, on a
+		 * line of its own.  Its address and source line are not
+		 * printed.
 		 */
 
 void printBin(int value, int length);
@@ -79,6 +149,8 @@ void printBin(int value, int length);
 		 * many binary digits to print.
 		 * E.g., printBin (3, 5) would print 00011 to stdout (the binary
 		 * representation for the number 3, expressed using 5 characters).
+		 * Negative values are printed in two's complement, and only the
+		 * lowest length bits are printed.
 		 */
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,376 @@
+/*
+ * This file contains the peephole optimizer, an optional pass (-O)
+ * that runs between pass1 and pass2 and applies a table of local
+ * rewrite rules to the decoded program:
+ *      drop no-op:        removes instructions that have no effect,
+ *                         e.g., add $x, $x, $zero
+ *      jump chain:        retargets a branch or jump whose target is
+ *                         an unconditional jump to that jump's target
+ *      tail call:         turns jal f; nop; jr $ra; nop into j f; nop
+ *                         (jal f; jr $ra into j f in .set reorder mode)
+ *      redundant load:    removes (or turns into a register move) a
+ *                         load of the address that the instruction
+ *                         just before it loaded from or stored to
+ *
+ * Outside of .set reorder mode the source manages MIPS delay slots
+ * itself, so the instruction after a branch or jump is never removed,
+ * and rules that skip over a jump only do so when its delay slot is a
+ * no-op.  In reorder mode the source has no delay slots (they are
+ * filled later, by fillDelaySlots), so these restrictions do not apply.
+ * An instruction with a label is never rewritten together with the
+ * instruction before it, since it may also be reached by a jump.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include "assembler.h"
+#include "optimize.h"
+
+/* Limits that guarantee the optimizer stops on every input. */
+#define MAX_SWEEPS 10   /* passes over the program */
+#define MAX_CHAIN 16    /* jumps followed in one jump chain */
+
+/* Each rule looks at the instruction at index and the ones after it;
+ * it returns 1 if it rewrote the program and 0 otherwise.
+ */
+typedef struct
+{
+    char *name;                                               /* rule name (for debugging) */
+    int (*apply)(Program *prog, LabelTable *table, int index); /* the rewrite */
+} PeepholeRule;
+
+static int dropNoOp(Program *prog, LabelTable *table, int index);
+static int collapseJumpChain(Program *prog, LabelTable *table, int index);
+static int tailCall(Program *prog, LabelTable *table, int index);
+static int dropRedundantLoad(Program *prog, LabelTable *table, int index);
+
+static PeepholeRule rules[] =
+    {
+        {"drop no-op", dropNoOp},
+        {"jump chain", collapseJumpChain},
+        {"tail call", tailCall},
+        {"redundant load", dropRedundantLoad}};
+
+static const int NBR_RULES = sizeof(rules) / sizeof(rules[0]);
+
+/* internal functions (visible to this file only)*/
+static int isNoOp(Instruction *instr);
+static int nextInstr(Program *prog, int index, int *labeled);
+static int inDelaySlot(Program *prog, int index);
+static int delaySlot(Program *prog, int index, int *labeled);
+static int setName(Instruction *instr, char *name, char *opType, int code);
+
+int peephole(Program *prog, LabelTable *table)
+/* Applies the peephole rule table to the program until no rule
+   * matches, and lays the program out again.
+   * Returns the number of rewrites that were made.
+   */
+{
+    int total = 0; /* rewrites made so far */
+    int changes;   /* rewrites made in this sweep */
+    int sweeps = 0;
+    int i, r;
+
+    do
+    {
+        changes = 0;
+        for (i = 0; i < prog->nbrInstrs; i++)
+        {
+            for (r = 0; r < NBR_RULES; r++)
+            {
+                /* the instruction may have been deleted by an earlier rule */
+                if (prog->instrs[i].name != NULL && rules[r].apply(prog, table, i))
+                {
+                    TRACE(TRACE_OPTIMIZER, 2, "%s: peephole %s.\n",
+                          lineName(prog->instrs[i].lineNum), rules[r].name);
+                    changes++;
+                }
+            }
+        }
+
+        /* Deleted instructions keep their place (and address) until
+         * the end of the sweep, so that labels can still be looked up.
+         */
+        if (changes > 0 && layoutProgram(prog, table) == 0)
+            break; /* error message already printed */
+
+        total += changes;
+    } while (changes > 0 && ++sweeps < MAX_SWEEPS);
+
+    return total;
+}
+
+static int dropNoOp(Program *prog, LabelTable *table, int index)
+/* Deletes the instruction at index if it has no effect, unless it
+   * may be filling the delay slot of a branch or jump.
+   */
+{
+    (void)table;
+
+    if (!isNoOp(&prog->instrs[index]) || inDelaySlot(prog, index))
+        return 0;
+
+    deleteInstruction(prog, index);
+    return 1;
+}
+
+static int collapseJumpChain(Program *prog, LabelTable *table, int index)
+/* If the instruction at index branches or jumps to an unconditional
+   * jump (whose delay slot is a no-op), retargets it to the end of the
+   * chain of jumps.
+   */
+{
+    Instruction *instr = &prog->instrs[index];
+    char *target = instr->target;
+    int hops;
+
+    if (target == NULL || !isControlTransfer(instr))
+        return 0;
+
+    for (hops = 0; hops < MAX_CHAIN; hops++)
+    {
+        int k = findInstruction(prog, table, target);
+        int slot, labeled;
+        Instruction *next;
+
+        if (k == -1 || k == index)
+            break;
+
+        /* only follow j instructions whose delay slot does nothing */
+        next = &prog->instrs[k];
+        if (*next->f.opType != 'J' || next->f.code != 2)
+            break;
+        slot = delaySlot(prog, k, &labeled);
+        if (slot != k && (slot == -1 || !isNoOp(&prog->instrs[slot])))
+            break;
+
+        target = next->target;
+    }
+
+    /* no chain, or a chain that loops back on itself */
+    if (target == instr->target || hops == MAX_CHAIN)
+        return 0;
+
+    if ((target = memStrdup(MEM_OPTIMIZER, target)) == NULL)
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return 0;
+    }
+    memFree(instr->target);
+    instr->target = target;
+    return 1;
+}
+
+static int tailCall(Program *prog, LabelTable *table, int index)
+/* Turns jal f; nop; jr $ra; nop into j f; nop (or, in reorder mode,
+   * jal f; jr $ra into j f).  Neither the jr nor the instructions
+   * around it may have labels.
+   */
+{
+    Instruction *instr = &prog->instrs[index];
+    int slot1, ret, slot2;
+    int labeled1, labeled2, labeled3;
+
+    (void)table;
+
+    if (*instr->f.opType != 'J' || instr->f.code != 3)
+        return 0;
+
+    slot1 = delaySlot(prog, index, &labeled1);
+    if (slot1 == -1 || labeled1 || (slot1 != index && !isNoOp(&prog->instrs[slot1])))
+        return 0;
+
+    ret = nextInstr(prog, slot1, &labeled2);
+    if (ret == -1 || labeled2 || *prog->instrs[ret].f.opType != 'R' ||
+        prog->instrs[ret].f.code != 8 || prog->instrs[ret].rs != 31 ||
+        prog->instrs[ret].reorder != instr->reorder)
+        return 0;
+
+    slot2 = delaySlot(prog, ret, &labeled3);
+    if (slot2 == -1 || labeled3 || (slot2 != ret && !isNoOp(&prog->instrs[slot2])))
+        return 0;
+
+    if (!setName(instr, "j", "J", 2))
+        return 0;
+    deleteInstruction(prog, ret);
+    if (slot2 != ret)
+        deleteInstruction(prog, slot2);
+    return 1;
+}
+
+static int dropRedundantLoad(Program *prog, LabelTable *table, int index)
+/* If the instruction at index is a load or store and the instruction
+   * after it loads from the same address, deletes the load or turns it
+   * into a register move.
+   */
+{
+    Instruction *first = &prog->instrs[index];
+    Instruction *load;
+    int next, labeled;
+
+    (void)table;
+
+    /* lw or sw, followed by an lw without a label */
+    if (*first->f.opType != 'I' || (first->f.code != 35 && first->f.code != 43))
+        return 0;
+    next = nextInstr(prog, index, &labeled);
+    if (next == -1 || labeled)
+        return 0;
+    load = &prog->instrs[next];
+    if (*load->f.opType != 'I' || load->f.code != 35)
+        return 0;
+
+    /* same address, and the first instruction didn't change the base */
+    if (load->rs != first->rs || load->imm != first->imm)
+        return 0;
+    if ((load->target == NULL) != (first->target == NULL) ||
+        (load->target != NULL && strcmp(load->target, first->target) != SAME))
+        return 0; /* the lower halves of different labels */
+    if ((load->expr == NULL) != (first->expr == NULL) ||
+        (load->expr != NULL && strcmp(load->expr, first->expr) != SAME))
+        return 0; /* offsets that are not known yet */
+    if (first->f.code == 35 && (first->rt == first->rs || first->rt == 0))
+        return 0;
+
+    /* the value is already in first->rt */
+    if (load->rt == first->rt)
+    {
+        deleteInstruction(prog, next);
+        return 1;
+    }
+
+    /* addu load->rt, first->rt, $zero */
+    if (!setName(load, "addu", "R", 33))
+        return 0;
+    load->rd = load->rt;
+    load->rs = first->rt;
+    load->rt = 0;
+    load->shamt = 0;
+    load->imm = 0;
+    memFree(load->expr);
+    load->expr = NULL;
+    return 1;
+}
+
+static int isNoOp(Instruction *instr)
+/* Returns 1 if instr has no effect (it only writes a register with the
+   * value it already has, or writes $zero); 0 otherwise.
+   */
+{
+    int code = instr->f.code;
+
+    if (instr->name == NULL)
+        return 0;
+
+    if (*instr->f.opType == 'R')
+    {
+        if (code == 8) /* jr */
+            return 0;
+        if ((code == 0 || code == 2) && instr->rd == instr->rt && instr->shamt == 0 &&
+            instr->expr == NULL)
+            return 1; /* sll, srl by 0 (including nop) */
+        if ((code == 32 || code == 33 || code == 37) &&
+            ((instr->rd == instr->rs && instr->rt == 0) ||
+             (instr->rd == instr->rt && instr->rs == 0)))
+            return 1; /* add, addu, or with $zero */
+        if ((code == 34 || code == 35) && instr->rd == instr->rs && instr->rt == 0)
+            return 1; /* sub, subu $zero */
+
+        /* writes to $zero, except by add and sub, which may trap */
+        return instr->rd == 0 && code != 32 && code != 34;
+    }
+
+    if (*instr->f.opType == 'I')
+    {
+        if (instr->target != NULL && instr->rt != 0)
+            return 0; /* the immediate is half of a label's address */
+        if (instr->expr != NULL && instr->rt != 0)
+            return 0; /* the immediate is not known yet */
+
+        if ((code == 8 || code == 9 || code == 13) && instr->rt == instr->rs && instr->imm == 0)
+            return 1; /* addi, addiu, ori with 0 */
+
+        /* writes to $zero by addiu, slti, sltiu, andi, ori, lui */
+        return instr->rt == 0 && code >= 9 && code <= 15;
+    }
+
+    return 0;
+}
+
+static int nextInstr(Program *prog, int index, int *labeled)
+/* Returns the index of the first instruction after index, or -1 if
+   * there is none.  Sets *labeled to 1 if that instruction has a label
+   * (on a line of its own or on the instruction's line) or .align
+   * padding before it, and to 0 otherwise.
+   */
+{
+    int i;
+
+    *labeled = 0;
+    for (i = index + 1; i < prog->nbrInstrs; i++)
+    {
+        if (prog->instrs[i].label != NULL || prog->instrs[i].align > 0)
+            *labeled = 1;
+        if (prog->instrs[i].name != NULL)
+            return i;
+    }
+
+    return -1;
+}
+
+static int inDelaySlot(Program *prog, int index)
+/* Returns 1 if the instruction before index is a branch or jump whose
+   * delay slot the source fills, so that the instruction at index may
+   * be filling it.
+   */
+{
+    int i;
+
+    for (i = index - 1; i >= 0; i--)
+    {
+        if (prog->instrs[i].name != NULL)
+            return !prog->instrs[i].reorder && isControlTransfer(&prog->instrs[i]);
+    }
+
+    return 0;
+}
+
+static int delaySlot(Program *prog, int index, int *labeled)
+/* Returns the index of the instruction in the delay slot of the branch
+   * or jump at index, or -1 if there is none.  In reorder mode the slot
+   * is not filled yet, so the branch's own index is returned instead.
+   * Sets *labeled like nextInstr.
+   */
+{
+    if (prog->instrs[index].reorder)
+    {
+        *labeled = 0;
+        return index;
+    }
+
+    return nextInstr(prog, index, labeled);
+}
+
+static int setName(Instruction *instr, char *name, char *opType, int code)
+/* Turns instr into the instruction with the given name, format, and
+   * code, leaving its operands unchanged.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    char *newName;
+
+    if ((newName = memStrdup(MEM_OPTIMIZER, name)) == NULL)
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return 0;
+    }
+
+    memFree(instr->name);
+    instr->name = newName;
+    instr->f.opType = opType;
+    instr->f.code = code;
+    return 1;
+}
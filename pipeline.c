@@ -0,0 +1,387 @@
+/*
+ * This file contains pipelined mode (--pipeline), in which one thread
+ * reads the source and splits it into lines, the main thread decodes
+ * and encodes the program, and another thread formats the machine code
+ * and writes it out.
+ *
+ * pass2 can only encode once pass1 has seen every label, so the three
+ * stages never all run at once: reading overlaps with decoding (pass1),
+ * and formatting and writing overlap with encoding (pass2).  Each pair
+ * of stages is connected by a Pipe, which holds a fixed number of
+ * batches.  The producer takes an empty batch from the free ring,
+ * fills it, and puts it on the full ring; the consumer takes it from
+ * the full ring, uses it, and gives it back on the free ring.  Each
+ * ring has only one thread putting and one thread taking, so it needs
+ * no lock, only the order of its two counters, and a stage that gets
+ * ahead waits for a batch instead of using more memory.  A batch with
+ * nothing in it marks the end of the stream.
+ *
+ * The decoding stage reads the lines through a stream (fopencookie),
+ * so pass1 reads them just as it reads a file.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#define _GNU_SOURCE /* for fopencookie */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "assembler.h"
+#include "pass2.h"
+#include "pipeline.h"
+
+/* The nbr of batches in a pipe (a power of 2), and the size of each. */
+#define NBR_BATCHES 8
+#define BATCH_BYTES 65536
+#define BATCH_WORDS (BATCH_BYTES / 4)
+
+/* The length of a line of machine code (32 bits and a newline). */
+#define WORD_LINE 33
+
+/* The struct Batch holds the text of whole lines, or words of machine
+ * code; one with a length of 0 marks the end of the stream.
+ */
+typedef struct
+{
+    size_t length; /* nbr of bytes of text, or of words */
+    union
+    {
+        char text[BATCH_BYTES];
+        uint32_t words[BATCH_WORDS];
+    } u;
+} Batch;
+
+/* The struct Ring holds the batches passed from one thread to another.
+ * Only the producer changes tail, and only the consumer changes head.
+ */
+typedef struct
+{
+    Batch *slots[NBR_BATCHES];
+    atomic_uint head; /* nbr of batches taken so far */
+    atomic_uint tail; /* nbr of batches put so far */
+} Ring;
+
+/* The struct Pipe connects two stages: the full batches go one way,
+ * and the empty ones come back the other.
+ */
+typedef struct
+{
+    Ring full;                   /* filled by the producer */
+    Ring free;                   /* emptied by the consumer */
+    Batch batches[NBR_BATCHES];
+    Batch *current;              /* batch being filled or used, or NULL */
+    size_t offset;               /* how much of current has been used */
+    int ended;                   /* 1 once the end has been taken */
+    pthread_t thread;            /* the thread at the other end */
+    FILE *fp;                    /* the source file (for the reader) */
+    long bytes;                  /* bytes written (for the writer) */
+} Pipe;
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+static Pipe *output = NULL;      /* the pipe to the writer, once started */
+
+/* internal functions (visible to this file only)*/
+static Pipe *newPipe(void);
+static void put(Ring *ring, Batch *batch);
+static Batch *take(Ring *ring);
+static void waitABit(int *waits);
+static void *readLines(void *arg);
+static ssize_t readBatch(void *cookie, char *buffer, size_t size);
+static int closeInput(void *cookie);
+static void *writeWords(void *arg);
+
+FILE *pipelineOpen(FILE *fp)
+/* Starts a thread that reads fp and splits it into batches of lines.
+   * Returns a stream from which the lines can be read, as from fp
+   * (closing it also closes fp); NULL if the thread can't be started
+   * (fp is left open).
+   */
+{
+    cookie_io_functions_t functions = {readBatch, NULL, NULL, closeInput};
+    Pipe *input = newPipe();
+    FILE *stream;
+
+    if (input == NULL)
+        return NULL; /* error message already printed */
+    if ((stream = fopencookie(input, "r", functions)) == NULL)
+    {
+        memFree(input);
+        printError("%s", ERROR0);
+        return NULL;
+    }
+
+    input->fp = fp;
+    if (pthread_create(&input->thread, NULL, readLines, input) != 0)
+    {
+        input->fp = NULL; /* there is no reader to wait for */
+        (void)fclose(stream);
+        printError("Error: cannot start the thread that reads the source.\n");
+        return NULL;
+    }
+    return stream;
+}
+
+void pipelineWord(uint32_t word, int address, int lineNum)
+/* Passes word to the thread that formats the machine code and writes
+   * it to standard output (starting the thread, if it hasn't been
+   * started).  Its address and source line are not written.  Used as
+   * the output function of a MachineCode.
+   */
+{
+    if (output == NULL)
+    {
+        if ((output = newPipe()) == NULL)
+        {
+            printWord(word, address, lineNum); /* write it here instead */
+            return;
+        }
+        if (pthread_create(&output->thread, NULL, writeWords, output) != 0)
+        {
+            memFree(output);
+            output = NULL;
+            printWord(word, address, lineNum);
+            return;
+        }
+    }
+
+    if (output->current == NULL)
+    {
+        output->current = take(&output->free);
+        output->current->length = 0;
+    }
+    output->current->u.words[output->current->length++] = word;
+    if (output->current->length == BATCH_WORDS)
+    {
+        put(&output->full, output->current);
+        output->current = NULL;
+    }
+}
+
+long pipelineFinish(void)
+/* Postcondition: the words passed to pipelineWord have all been
+   *      written, and the thread that writes them has ended.
+   * Returns the nbr of bytes written.
+   */
+{
+    long bytes;
+
+    if (output == NULL)
+        return 0;
+
+    /* the last (partial) batch, then the end of the stream */
+    if (output->current != NULL)
+        put(&output->full, output->current);
+    output->current = take(&output->free);
+    output->current->length = 0;
+    put(&output->full, output->current);
+
+    (void)pthread_join(output->thread, NULL);
+    bytes = output->bytes;
+    memFree(output);
+    output = NULL;
+    return bytes;
+}
+
+static Pipe *newPipe(void)
+/* Returns a new pipe, with all of its batches on the free ring; NULL
+   * if memory allocation error.
+   */
+{
+    Pipe *pipe = memAlloc(MEM_OUTPUT, sizeof(Pipe));
+    int i;
+
+    if (pipe == NULL)
+    {
+        printError("%s", ERROR0);
+        return NULL;
+    }
+
+    atomic_init(&pipe->full.head, 0);
+    atomic_init(&pipe->full.tail, 0);
+    atomic_init(&pipe->free.head, 0);
+    atomic_init(&pipe->free.tail, NBR_BATCHES);
+    for (i = 0; i < NBR_BATCHES; i++)
+        pipe->free.slots[i] = &pipe->batches[i];
+    pipe->current = NULL;
+    pipe->offset = 0;
+    pipe->ended = 0;
+    pipe->fp = NULL;
+    pipe->bytes = 0;
+    return pipe;
+}
+
+static void put(Ring *ring, Batch *batch)
+/* Postcondition: batch is the last one on ring (waiting for room, if
+   *      it is full).  Only one thread may put batches on a ring.
+   */
+{
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    int waits = 0;
+
+    while (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == NBR_BATCHES)
+        waitABit(&waits);
+    ring->slots[tail % NBR_BATCHES] = batch;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+static Batch *take(Ring *ring)
+/* Returns the first batch on ring, which is removed (waiting for one,
+   * if it is empty).  Only one thread may take batches from a ring.
+   */
+{
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    Batch *batch;
+    int waits = 0;
+
+    while (atomic_load_explicit(&ring->tail, memory_order_acquire) == head)
+        waitABit(&waits);
+    batch = ring->slots[head % NBR_BATCHES];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return batch;
+}
+
+static void waitABit(int *waits)
+/* Lets the other threads run, briefly at first, and then for longer,
+   * so that a stage that waits long (e.g., the writer, while pass1
+   * runs) doesn't keep a processor busy.
+   */
+{
+    struct timespec pause = {0, 100000}; /* 0.1 ms */
+
+    if ((*waits)++ < 100)
+        (void)sched_yield();
+    else
+        (void)nanosleep(&pause, NULL);
+}
+
+static void *readLines(void *arg)
+/* The reading stage: reads the lines of the source file and passes
+   * them on in batches of whole lines, then an empty batch.
+   */
+{
+    Pipe *input = arg;
+    Batch *batch = take(&input->free);
+    char line[BUFSIZ];
+
+    batch->length = 0;
+    while (fgets(line, sizeof(line), input->fp) != NULL)
+    {
+        size_t length = strlen(line);
+
+        if (batch->length + length > BATCH_BYTES)
+        {
+            put(&input->full, batch);
+            batch = take(&input->free);
+            batch->length = 0;
+        }
+        memcpy(batch->u.text + batch->length, line, length);
+        batch->length += length;
+    }
+
+    if (batch->length > 0)
+    {
+        put(&input->full, batch);
+        batch = take(&input->free);
+        batch->length = 0;
+    }
+    put(&input->full, batch);
+    return NULL;
+}
+
+static ssize_t readBatch(void *cookie, char *buffer, size_t size)
+/* Reads up to size bytes of the source, from the batches of lines,
+   * into buffer (for the stream returned by pipelineOpen).
+   * Returns the nbr of bytes read; 0 at the end of the source.
+   */
+{
+    Pipe *input = cookie;
+    size_t length;
+
+    if (input->current == NULL)
+    {
+        if (input->ended)
+            return 0;
+        input->current = take(&input->full);
+        input->offset = 0;
+        if (input->current->length == 0)
+        {
+            input->ended = 1;
+            put(&input->free, input->current);
+            input->current = NULL;
+            return 0;
+        }
+    }
+
+    length = input->current->length - input->offset;
+    if (length > size)
+        length = size;
+    memcpy(buffer, input->current->u.text + input->offset, length);
+    input->offset += length;
+    if (input->offset == input->current->length)
+    {
+        put(&input->free, input->current);
+        input->current = NULL;
+    }
+    return (ssize_t)length;
+}
+
+static int closeInput(void *cookie)
+/* Waits for the reading stage (if it was started) to end, reading and
+   * dropping the rest of the source, closes the source file, and frees
+   * the pipe (for the stream returned by pipelineOpen).
+   * Returns 0.
+   */
+{
+    Pipe *input = cookie;
+    char rest[BUFSIZ];
+
+    if (input->fp != NULL)
+    {
+        while (readBatch(input, rest, sizeof(rest)) > 0)
+            ;
+        (void)pthread_join(input->thread, NULL);
+        (void)fclose(input->fp);
+    }
+    memFree(input);
+    return 0;
+}
+
+static void *writeWords(void *arg)
+/* The writing stage: formats the words of each batch as lines of
+   * binary digits and writes them to standard output, until an empty
+   * batch.
+   */
+{
+    static char text[BATCH_WORDS * WORD_LINE];
+    Pipe *pipe = arg;
+    Batch *batch;
+
+    while ((batch = take(&pipe->full))->length > 0)
+    {
+        size_t i;
+        char *next = text;
+
+        for (i = 0; i < batch->length; i++)
+        {
+            uint32_t word = batch->u.words[i];
+            int k;
+
+            for (k = 31; k >= 0; k--)
+                *next++ = (word >> k) & 1 ? '1' : '0';
+            *next++ = '\n';
+        }
+        put(&pipe->free, batch);
+
+        pipe->bytes += fwrite(text, 1, next - text, stdout);
+    }
+
+    put(&pipe->free, batch);
+    return NULL;
+}
@@ -0,0 +1,46 @@
+/*
+ * Pipelined mode (--pipeline)
+ *
+ * This file provides the declarations for pipelined mode, in which
+ * reading the source and writing the machine code are done by threads
+ * of their own, alongside the thread that decodes and encodes.  The
+ * threads pass each other batches of lines or words through bounded
+ * single-producer, single-consumer rings, so the buffers for reading
+ * and writing stay the same size however large the input is (the
+ * decoded program is still kept whole until it has been encoded).
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+FILE *pipelineOpen(FILE *fp);
+/* Starts a thread that reads fp and splits it into batches of lines.
+		 * Returns a stream from which the lines can be read, as from
+		 * fp (closing it also closes fp); NULL if the thread can't be
+		 * started (fp is left open).
+		 */
+
+void pipelineWord(uint32_t word, int address, int lineNum);
+/* Passes word to the thread that formats the machine code and writes
+		 * it to standard output (starting the thread, if it hasn't
+		 * been started).  Its address and source line are not
+		 * written.  Used as the output function of a MachineCode.
+		 */
+
+long pipelineFinish(void);
+/* Postcondition: the words passed to pipelineWord have all been
+		 *      written, and the thread that writes them has ended
+		 *      and its pipe has been freed.  Must be called once the
+		 *      program has been encoded (nothing calls it at exit).
+		 * Returns the nbr of bytes written.
+		 */
+
+#endif
@@ -23,13 +23,13 @@
 
 /* Define the internal DEBUG variable shared by functions in this file. */
 static const char DEBUG_DEFAULT_VALUE = 0;
-static char OVERRIDE_DEBUG_CHANGES = 0;
-static char DEBUG = 0; /* Not all compilers will accept DEBUG_DEFAULT_VALUE. */
+static _Thread_local char OVERRIDE_DEBUG_CHANGES = 0;
+static _Thread_local char DEBUG = 0; /* Not all compilers will accept DEBUG_DEFAULT_VALUE. */
 
 /* Define the internal DEBUG stack and the functions that operate on it. */
-static char * debugStack = NULL;
-static unsigned debugStackCapacity = 0;
-static unsigned debugStackNumEntries = 0;
+static _Thread_local char * debugStack = NULL;
+static _Thread_local unsigned debugStackCapacity = 0;
+static _Thread_local unsigned debugStackNumEntries = 0;
 static void debug_push(void);
 static char debug_pop(void);
 static int resizeDebugStack (void);
@@ -3,8 +3,19 @@
 #include <stdlib.h>
 #include "printFuncs.h"
 
-/** Define the global ERROR_LIMIT variable. **/
-int ERROR_LIMIT = 20;
+/** Define the global ERROR_LIMIT variable (one for each thread). **/
+_Thread_local int ERROR_LIMIT = 20;
+
+/** Define the global ERROR_COUNT and ERROR_PREFIX variables. **/
+_Thread_local int ERROR_COUNT = 0;
+_Thread_local const char * ERROR_PREFIX = NULL;
+
+/** Define the global ERROR_LINE variable. **/
+_Thread_local int ERROR_LINE = 0;
+
+/** Define the global ERROR_HANDLER and ERROR_HANDLER_ARG variables. **/
+_Thread_local ErrorHandler ERROR_HANDLER = NULL;
+_Thread_local void * ERROR_HANDLER_ARG = NULL;
 
 /**
  * printError(const char * restrict_format, ...)
@@ -20,6 +31,19 @@ int ERROR_LIMIT = 20;
  * continue (and continue to generate error messages) until it stops on
  * its own.
  *
+ * The number of error messages printed so far is kept in the global
+ * variable ERROR_COUNT.  If the global variable ERROR_PREFIX is not
+ * NULL, each message is preceded by it and a colon (e.g., the name of
+ * the file being read, when there is more than one).  The global
+ * variable ERROR_LINE, the line of the source that the message is
+ * about, is not printed; it is there for the error handler.
+ *
+ * If the global variable ERROR_HANDLER is not NULL, the message (with
+ * its prefix) is passed to it, along with ERROR_HANDLER_ARG, instead
+ * of being printed, and the program never exits (e.g., a program that
+ * uses the assembler as a library collects the messages, and decides
+ * for itself what to do about them).
+ *
  * Parameters:
  *  The parameters to printError are modeled on those to printf,
  *  consisting of a format and various other arguments as specified
@@ -27,23 +51,44 @@ int ERROR_LIMIT = 20;
  *
  * Exit Value:
  *  If ERROR_LIMIT is greater than zero and the program has reached the
- *  limit, printError will exit the program with an error code of 1.
+ *  limit, printError will exit the program with an error code of 1
+ *  (unless there is an error handler).
  */
 void printError(const char * restrict_format, ...)
 {
-    static int error_count = 0;
-
     /* The following code allows us to call fprintf with the variable
      * parameters that were passed to printError.
      */
     va_list ap;
+
+    if ( ERROR_HANDLER != NULL )
+    {
+        char message[BUFSIZ];
+        int length = 0;
+
+        if ( ERROR_PREFIX != NULL )
+            length = snprintf(message, sizeof(message), "%s: ", ERROR_PREFIX);
+        if ( length < 0 || length >= (int) sizeof(message) )
+            length = 0;
+        va_start(ap, restrict_format);
+        (void) vsnprintf(message + length, sizeof(message) - length,
+                         restrict_format, ap);
+        va_end(ap);
+
+        ERROR_COUNT++;
+        ERROR_HANDLER(ERROR_HANDLER_ARG, message);
+        return;
+    }
+
+    if ( ERROR_PREFIX != NULL )
+        (void) fprintf(stderr, "%s: ", ERROR_PREFIX);
     va_start(ap, restrict_format);
     (void) vfprintf(stderr, restrict_format, ap);
     va_end(ap);
 
     /* Keep track of the error count, and exit if it goes too high. */
-    error_count++;
-    if ( ERROR_LIMIT > 0 && error_count > ERROR_LIMIT )
+    ERROR_COUNT++;
+    if ( ERROR_LIMIT > 0 && ERROR_COUNT > ERROR_LIMIT )
     {
         exit(1);
     }
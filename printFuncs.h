@@ -12,6 +12,25 @@
  *      to change the number of errors that get printed before the
  *      programs stops execution.
  *
+ * ERROR_COUNT is a global variable holding the number of errors that
+ *      have been printed so far.
+ *
+ * ERROR_PREFIX is a global variable that, if it is not NULL, is printed
+ *      (followed by a colon) before each error message.
+ *
+ * ERROR_LINE is a global variable holding the line of the source that
+ *      the messages being printed are about (0 if none); it is not
+ *      printed, but an error handler can use it (e.g., to report the
+ *      messages in the order of the lines).
+ *
+ * ERROR_HANDLER is a global variable that, if it is not NULL, is called
+ *      with ERROR_HANDLER_ARG and each error message (including the
+ *      prefix) instead of printing it.  The program never stops
+ *      execution while there is an error handler, whatever the limit.
+ *
+ *      These variables are thread-local: each thread has its own, so
+ *      that several threads can assemble at once (see libassembler.h).
+ *
  * printDebug will print a debugging message to stdout, but only if
  *      debugging has been turned on.
  *      printDebug takes a variable number of arguments, the first of
@@ -46,7 +65,14 @@
 
 void printError(const char * restrict_format, ...);
 
-extern int ERROR_LIMIT;
+typedef void (*ErrorHandler)(void * arg, const char * message);
+
+extern _Thread_local int ERROR_LIMIT;
+extern _Thread_local int ERROR_COUNT;
+extern _Thread_local const char * ERROR_PREFIX;
+extern _Thread_local int ERROR_LINE;
+extern _Thread_local ErrorHandler ERROR_HANDLER;
+extern _Thread_local void * ERROR_HANDLER_ARG;
 
 void printDebug(const char * restrict_format, ...);
 
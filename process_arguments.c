@@ -1,19 +1,64 @@
 /*
  * The process_arguments function parses the command-line arguments for
- * an optional filename and an optional choice (1 or 0) to turn all
+ * optional filenames and an optional choice (1 or 0) to turn all
  * debugging messages on or off.  It returns a FILE pointer to an open
- * file (stdin if no filename was passed in) or NULL if process_arguments
- * encounters a fatal error.
+ * file (the first file named, or stdin if no filename was passed in) or
+ * NULL if process_arguments encounters a fatal error.  The open_input
+ * function opens the other files named, one at a time.
  *
  * Usage:
- *      programName  [filename] [0|1]
- * If both a filename and a debugging choice are provided, they may
- * be in either order.
+ *      programName  [options] [filename ...] [0|1]
+ * The filenames and the debugging choice may be in any order.
  *
- * The optional filename indicates the input file; if it is provided,
- * process_arguments opens the file and returns it after also processing
- * the debugging option.  If it is not provided, the program reads its
- * input from stdin.
+ * Options start with '-' and may appear anywhere on the command line.
+ * They are recorded in the global OPTIONS structure:
+ *      -O      run the peephole optimizer between pass1 and pass2
+ *      -MD     write a make rule listing the files that filename
+ *              includes to filename.d
+ *      -Idir   look for .include files in dir (may be repeated)
+ *      --check check each file for errors only, without writing its
+ *              machine code
+ *      --watch keep running, and assemble each file into filename.out
+ *              again whenever it (or a file it includes) changes
+ *      --emit=format:path
+ *              write the machine code (bin or hex), the labels (sym),
+ *              a listing (lst), or the line table (lines) to path
+ *              ("-" for stdout) instead of binary to stdout; may be
+ *              repeated (see emit.h)
+ *      --unreachable=report|strip
+ *              report the code that can't be reached from main (and,
+ *              with strip, delete it)
+ *      --schedule
+ *              reorder the instructions in each basic block to hide
+ *              load-use stalls
+ *      --inline[=n]
+ *              replace the calls to leaf functions of at most n
+ *              instructions (8 by default) with their bodies
+ *      --profile=counts.txt
+ *              reorder the basic blocks by the execution counts in
+ *              counts.txt, hot ones together and cold ones last
+ *      --pipeline
+ *              read the source and write the machine code in threads
+ *              of their own, alongside decoding and encoding
+ *      --stats print the time spent in each phase, and counts of
+ *              lines, instructions, labels, etc., to stderr
+ *      --mem-stats
+ *              print the allocations, bytes, peak bytes in use, and
+ *              leaks of each subsystem (see mem.h) to stderr at exit
+ *      --trace=file.json
+ *              write the time spent in each phase to file.json as
+ *              Chrome trace events
+ *      --debug=category[:level],...
+ *              trace the given parts of the assembler (see trace.h);
+ *              only available if the assembler was built with
+ *              make TRACE=1 (otherwise a warning is printed)
+ *
+ * The optional filenames indicate the input files, which are recorded
+ * in OPTIONS; if any are provided, process_arguments opens the first
+ * one and returns it after also processing the debugging option.  If
+ * none is provided, the program reads its input from stdin.  Input that
+ * is compressed with gzip (or zstd) is decompressed as it is read (see
+ * decompress.h).
  *
  * A debugging choice argument of 0 or 1 indicates a choice to globally
  * turn debugging off or on, overriding any calls to debug_on,
@@ -25,91 +70,164 @@
  * debug_off, and debug_restore functions.
  */
 
+#include <stdlib.h>
+
 #include "process_arguments.h"
+#include "trace.h"
+#include "decompress.h"
 
 /* SAME is defined in disUtil.c and should be defined in other main files also. */
 
+/* Define the global OPTIONS structure; every option is off by default.
+ * Each thread has its own (see libassembler.h).
+ */
+_Thread_local Options OPTIONS = {0};
+
+/* internal global variable (global to this file only)*/
+static const char * USAGE =
+    "Usage:  %s [-O] [-MD] [-Idir] [--check] [--watch] [--pipeline] [--stats]\n"
+    "                [--emit=format:path ...] [--unreachable=report|strip]\n"
+    "                [--schedule] [--inline[=n]] [--profile=counts.txt]\n"
+    "                [--mem-stats] [--trace=file.json]\n"
+    "                [--debug=category[:level],...] [filename ...] [0|1]\n";
+
+/* internal function (visible to this file only)*/
+static int process_option(char * option);
+
 FILE * process_arguments(int argc, char * argv[])
 {
-    FILE * fptr;               /* file pointer */
+    int i, j;                  /* used to step thru argv */
+    int debugChoices = 0;      /* nbr of debugging choices seen */
 
     /* Implementation notes:
-     * The arguments are both optional and may be provided in either
-     * order, which makes the logic more complicated.  This function
-     * processes the debugging choice first, if one was specified, then
-     * "erases" it from the argument list so that when we come to process
-     * the filename we can assume that it is the first and only argument
-     * (if provided at all).  If two arguments are provided but neither
-     * is a debugging choice, or if more than two arguments are provided,
-     * then a usage error message is printed.
-     * The valid combinations are:
-     *   program               no arguments are provided
-     *   program 0|1           process debugging choice and decrement
-     *                         argc so it looks like there were no arguments
-     *   program filename      no debugging choice; process filename
-     *   program 0|1 filename  process debugging choice and shift
-     *                         filename into first argument; now it looks
-     *                         like there was just one argument, filename
-     *   program filename 0|1  process debugging choice and decrement
-     *                         argc; now it looks like there was just
-     *                         one argument, filename
+     * The options, the debugging choice, and the filenames may be
+     * provided in any order.  This function processes the options
+     * first, then "erases" them from the argument list, so that what
+     * is left is a mix of filenames and at most one debugging choice
+     * ("0" or "1").  The filenames are recorded in OPTIONS, and the
+     * first one is opened.  If more than one debugging choice is
+     * provided, then a usage error message is printed.
      */
 
-    /* Process debugging choice and then "erase" this argument by
-     * shifting the filename into its place or just by reducing the
-     * argument count, argc, whichever is appropriate (see above for details).
+    /* Process the options first, "erasing" each one by shifting the
+     * arguments after it down, so that the rest of this function only
+     * sees the filenames and debugging choice.
      */
-    if ( argc > 1 )
+    for ( i = 1; i < argc; )
     {
-        if ( strcmp(argv[1], "0") == SAME )
+        if ( argv[i][0] != '-' || argv[i][1] == '\0' )
         {
-            debug_off();  override_debug_changes();
-            /* Done processing; move filename down (if it's there). */
-            argv[1] = argc > 2 ? argv[2] : argv[1];
-            argc--;
+            i++;
+            continue;
         }
-        else if ( strcmp(argv[1], "1") == SAME )
+        if ( ! process_option(argv[i]) )
         {
-            debug_on();  override_debug_changes();
-            /* Done processing; move filename down (if it's there). */
-            argv[1] = argc > 2 ? argv[2] : argv[1];
-            argc--;
-        }
-        else if ( argc > 2 && strcmp(argv[2], "0") == SAME )
-        {
-            debug_off();  override_debug_changes();
-            argc--;
-        }
-        else if ( argc > 2 && strcmp(argv[2], "1") == SAME )
-        {
-            debug_on();  override_debug_changes();
-            argc--;
+            printError(USAGE, argv[0]);
+            return NULL;
         }
+        for ( j = i; j < argc - 1; j++ )
+            argv[j] = argv[j + 1];
+        argc--;
     }
 
-    /* At this point, we have handled/erased the debugging choice, so
-     * argc should be 0 or 1, depending on whether a filename was
-     * provided.  Check the argument count now, since there's no need to
-     * open the file if the argument count is wrong.
+    /* Process the debugging choice and record the filenames, which
+     * are shifted down over the debugging choice.
      */
-    if ( argc > 2 )
+    for ( i = 1, j = 0; i < argc; i++ )
     {
-        printError("Usage:  %s [filename] [0|1]\n", argv[0]);
-        return 0;
+        if ( strcmp(argv[i], "0") == SAME || strcmp(argv[i], "1") == SAME )
+        {
+            if ( debugChoices++ > 0 )
+            {
+                printError(USAGE, argv[0]);
+                return NULL;
+            }
+            if ( argv[i][0] == '0' )
+                debug_off();
+            else
+                debug_on();
+            override_debug_changes();
+        }
+        else
+            argv[1 + j++] = argv[i];
     }
+    OPTIONS.fileNames = argv + 1;
+    OPTIONS.nbrFiles = j;
 
-    /* Process the filename, if one was passed in. */
-    if ( argc > 1 )
+    /* Open the first file, if one was passed in. */
+    if ( OPTIONS.nbrFiles > 0 )
+        return open_input(0);
+
+    /* No file passed in; use standard input. */
+    OPTIONS.fileName = NULL;
+    return decompressOpen(stdin, NULL);
+}
+
+FILE * open_input(int index)
+  /* Opens the input file OPTIONS.fileNames[index], and records its name
+   * in OPTIONS.fileName.
+   * Returns a FILE pointer to the open file (decompressed as it is
+   * read, if it is compressed); NULL if it can't be opened or
+   * decompressed.
+   */
+{
+    FILE * fptr;               /* file pointer */
+
+    /* Open the file for reading */
+    if ((fptr = fopen (OPTIONS.fileNames[index], "r")) == NULL)
     {
-        /* Open the file for reading */
-        if ((fptr = fopen (argv[1], "r")) == NULL)
-        {
-            printError("Error: Cannot open file %s.\n", argv[1]);
-            return NULL;
-        }
+        printError("Error: Cannot open file %s.\n", OPTIONS.fileNames[index]);
+        return NULL;
     }
-    else  /* No file passed in; use standard input. */
-        fptr = stdin;
+    OPTIONS.fileName = OPTIONS.fileNames[index];
+
+    return decompressOpen(fptr, OPTIONS.fileName);   /* Everything was OK! */
+}
+
+static int process_option(char * option)
+  /* Records option in the OPTIONS structure.
+   * Returns 1 if the option is valid; 0 otherwise.
+   */
+{
+    if ( strcmp(option, "-O") == SAME )
+        OPTIONS.optimize = 1;
+    else if ( strcmp(option, "--check") == SAME )
+        OPTIONS.check = 1;
+    else if ( strcmp(option, "--watch") == SAME )
+        OPTIONS.watch = 1;
+    else if ( strcmp(option, "--unreachable=report") == SAME )
+        OPTIONS.unreachable = 1;
+    else if ( strcmp(option, "--unreachable=strip") == SAME )
+        OPTIONS.unreachable = 2;
+    else if ( strcmp(option, "--schedule") == SAME )
+        OPTIONS.schedule = 1;
+    else if ( strcmp(option, "--inline") == SAME )
+        OPTIONS.inlineLimit = INLINE_LIMIT;
+    else if ( strncmp(option, "--inline=", 9) == SAME && option[9] != '\0' &&
+              strspn(option + 9, "0123456789") == strlen(option + 9) && atoi(option + 9) > 0 )
+        OPTIONS.inlineLimit = atoi(option + 9);
+    else if ( strcmp(option, "--pipeline") == SAME )
+        OPTIONS.pipeline = 1;
+    else if ( strcmp(option, "--stats") == SAME )
+        OPTIONS.stats = 1;
+    else if ( strcmp(option, "--mem-stats") == SAME )
+        OPTIONS.memStats = 1;
+    else if ( strncmp(option, "--emit=", 7) == SAME && OPTIONS.nbrEmits < MAX_EMITS &&
+              strchr(option + 7, ':') != NULL && strchr(option + 7, ':')[1] != '\0' )
+        OPTIONS.emits[OPTIONS.nbrEmits++] = option + 7;
+    else if ( strncmp(option, "--profile=", 10) == SAME && option[10] != '\0' )
+        OPTIONS.profile = option + 10;
+    else if ( strncmp(option, "--trace=", 8) == SAME && option[8] != '\0' )
+        OPTIONS.traceFile = option + 8;
+    else if ( strncmp(option, "--debug=", 8) == SAME )
+        return trace_set(option + 8);
+    else if ( strcmp(option, "-MD") == SAME )
+        OPTIONS.dependencies = 1;
+    else if ( strncmp(option, "-I", 2) == SAME && option[2] != '\0' &&
+              OPTIONS.nbrIncludeDirs < MAX_INCLUDE_DIRS )
+        OPTIONS.includeDirs[OPTIONS.nbrIncludeDirs++] = option + 2;
+    else
+        return 0;
 
-    return fptr;   /* Everything was OK! */
+    return 1;
 }
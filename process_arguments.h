@@ -1,5 +1,7 @@
 /*
- * This file provides the signature for the process_arguments function.
+ * This file provides the signatures for the process_arguments and
+ * open_input functions, and the Options structure in which it records any options (arguments
+ * starting with '-') that were passed on the command line.
  */
 
 #ifndef _PROCESS_ARGUMENTS_H
@@ -11,6 +13,51 @@
 #include "printFuncs.h"
 #include "same.h"
 
+/* The largest nbr of -I options, and of --emit options. */
+#define MAX_INCLUDE_DIRS 16
+#define MAX_EMITS 8
+
+/* The most instructions a leaf function may have to be inlined by
+ * --inline (see inline.c), unless --inline=n says otherwise.
+ */
+#define INLINE_LIMIT 8
+
+typedef struct
+{
+    int optimize;       /* 1 if -O was given: run the peephole optimizer */
+    int dependencies;   /* 1 if -MD was given: write a make rule */
+    int check;          /* 1 if --check was given: only check for errors */
+    int stats;          /* 1 if --stats was given: print timings and counts */
+    int memStats;       /* 1 if --mem-stats was given: print the memory
+                           used by each subsystem (see mem.h) */
+    char * traceFile;   /* file named by --trace=, for the phase timings */
+    int watch;          /* 1 if --watch was given: assemble again on
+                           every change */
+    int unreachable;    /* 1 if --unreachable=report was given, 2 if
+                           --unreachable=strip: find (and delete)
+                           code that can't run */
+    int schedule;       /* 1 if --schedule was given: hide load-use
+                           stalls */
+    int inlineLimit;    /* the most instructions of a leaf function
+                           inlined at its calls (--inline[=n]); 0 if
+                           none are */
+    char * profile;     /* file named by --profile=, of execution counts
+                           to lay the blocks out by */
+    int pipeline;       /* 1 if --pipeline was given: read and write in
+                           threads of their own */
+    int nbrEmits;       /* nbr of --emit options */
+    char * emits[MAX_EMITS];  /* their format:path (see emit.h) */
+    int nbrIncludeDirs; /* nbr of -I options */
+    char * includeDirs[MAX_INCLUDE_DIRS];  /* directories searched for
+                                              .include files */
+    int nbrFiles;       /* nbr of input files named */
+    char ** fileNames;  /* their names */
+    char * fileName;    /* the input file being read (NULL for stdin) */
+} Options;
+
+extern _Thread_local Options OPTIONS;
+
 FILE * process_arguments(int argc, char * argv[]);
+FILE * open_input(int index);
 
 #endif
@@ -0,0 +1,730 @@
+/*
+ * This file contains profile-guided code layout, an optional pass
+ * (--profile=counts.txt) that reorders the basic blocks of the program
+ * (see CFG.h) by how often they ran, as counted by a simulator, so that
+ * the code that runs most is together and falls through from block to
+ * block.  The count file has a line for each label or instruction
+ * address that was counted:
+ *
+ *          # label or address  count
+ *          main                1
+ *          loop:               1000
+ *          0x0000002c          999
+ *
+ * (a colon after the label or address is allowed, and # starts a
+ * comment).  The count of a block is the largest of the counts of its
+ * labels and instructions.  The addresses are those of the program as
+ * it is laid out without --profile, which is how the simulator ran it.
+ * If the file has no addresses, a block without a count of its own has
+ * that of the block before it (a label counts the code up to the next
+ * label); if it has addresses, an instruction that isn't there never ran.
+ *
+ * The blocks are joined into chains, one edge at a time, the edge most
+ * often taken first (an edge is counted as the smaller of the counts of
+ * its two blocks): a block is followed by the successor it goes to most
+ * often, unless that one already follows another block.  A block that
+ * must be followed by the next one (the return point of its jal, or a
+ * labeled delay slot of its branch) always is.  The chain of the first
+ * block comes first, then the others, hottest first, and then the ones
+ * that never ran, in source order; the labels at the end of the program
+ * stay at the end.  Then
+ *      - a beq or bne whose target now follows it is inverted (into a bne
+ *        or beq) to go to the block that followed it before, so the path
+ *        most often taken falls through,
+ *      - a block that ran on into a block that no longer follows it gets
+ *        a j to that block (with a nop in its delay slot), and
+ *      - a j to the block that now follows it, with a nop in its delay
+ *        slot, is deleted along with the nop.
+ * The labels that are made up for them (layout:1, ...) contain a colon,
+ * so they can't be the same as a label in the source.  The program is
+ * laid out again, so every label gets its new address, and pass2 then
+ * encodes every branch and jump from it.
+ *
+ * The pass runs after the delay slots of .set reorder mode are filled,
+ * so that every branch and jump has its delay slot after it, and the
+ * addresses are those of the program that the simulator ran.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <limits.h>
+
+#include "assembler.h"
+#include "optimize.h"
+#include "decompress.h"
+
+/* The count of an instruction address in the profile. */
+typedef struct
+{
+    int address;
+    int count;
+} AddressCount;
+
+/* The struct Profile holds the counts read from the count file. */
+typedef struct
+{
+    LabelTable labels;          /* the count of each label (as its address) */
+    int capacity;               /* capacity of addresses */
+    int nbrAddresses;           /* actual nbr of addresses */
+    AddressCount *addresses;    /* sorted by address */
+} Profile;
+
+/* An edge from a block to one it can go to next. */
+typedef struct
+{
+    int from, to;
+    int weight;         /* the smaller count of the two blocks */
+    int fallThrough;    /* 1 if to comes right after from in the source */
+} Edge;
+
+/* A chain of blocks, and the count of its hottest block. */
+typedef struct
+{
+    int head;
+    int count;
+} Chain;
+
+/* The struct Layout holds the blocks of the program being laid out,
+ * and the chains they are in.
+ */
+typedef struct
+{
+    Program *prog;
+    LabelTable *table;
+    CFG cfg;
+    int end;        /* the block of the labels at the end of the program,
+                       or nbrBlocks if there is none */
+    char *endLabel; /* the label made up for the end of the program, or
+                       NULL if none is needed */
+    int *counts;    /* the count of each block */
+    int *next;      /* the block after each one in its chain, or -1 */
+    int *prev;      /* the block before each one in its chain, or -1 */
+    int *chainOf;   /* a block in the same chain (see findChain) */
+    int *jumps;     /* the block each block gets a jump to, or -1 */
+    int nbrLabels;  /* nbr of labels made up */
+} Layout;
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+
+/* internal functions (visible to this file only)*/
+static int readProfile(Profile *profile, char *fileName);
+static int addAddressCount(Profile *profile, int address, int count);
+static int addressCount(Profile *profile, int address);
+static void profileFree(Profile *profile);
+static void countBlocks(Layout *l, Profile *profile);
+static void successors(Layout *l, int b, int *fall, int *target);
+static int mustFollow(Layout *l, int b);
+static int isRemovableJump(Layout *l, int index);
+static int isNop(Instruction *instr);
+static int findChain(Layout *l, int b);
+static void joinChains(Layout *l, int from, int to);
+static int appendChain(Layout *l, int head, int *order, int nbrOrdered);
+static char *labelOf(Layout *l, int b);
+static int rewrite(Layout *l, int *order, int nbrOrdered);
+static int addJump(Program *out, Instruction *model, char *target);
+static int compareEdges(const void *a, const void *b);
+static int compareChains(const void *a, const void *b);
+static int compareAddressCounts(const void *a, const void *b);
+
+int layoutByProfile(Program *prog, LabelTable *table, char *profileName)
+/* Reorders the basic blocks of the program by the counts in the file
+   * profileName, and lays the program out again.
+   * Returns the number of blocks that no longer follow the block they
+   * followed in the source.
+   */
+{
+    Profile profile;
+    Layout l;
+    Edge *edges = NULL;
+    Chain *chains = NULL;
+    int *order = NULL;
+    int nbrEdges = 0, nbrChains = 0, nbrOrdered = 0, moved = 0;
+    int n, b, k, first, last;
+
+    if (!readProfile(&profile, profileName))
+    {
+        profileFree(&profile);
+        return 0; /* error message already printed */
+    }
+    memset(&l, 0, sizeof(l));
+    l.prog = prog;
+    l.table = table;
+    if (!buildCFG(&l.cfg, prog, table))
+    {
+        profileFree(&profile);
+        return 0; /* error message already printed */
+    }
+
+    n = l.cfg.nbrBlocks;
+    l.counts = memAlloc(MEM_OPTIMIZER, (n + 1) * sizeof(int));
+    l.next = memAlloc(MEM_OPTIMIZER, (n + 1) * sizeof(int));
+    l.prev = memAlloc(MEM_OPTIMIZER, (n + 1) * sizeof(int));
+    l.chainOf = memAlloc(MEM_OPTIMIZER, (n + 1) * sizeof(int));
+    l.jumps = memAlloc(MEM_OPTIMIZER, (n + 1) * sizeof(int));
+    edges = memAlloc(MEM_OPTIMIZER, (2 * n + 1) * sizeof(Edge));
+    chains = memAlloc(MEM_OPTIMIZER, (n + 1) * sizeof(Chain));
+    order = memAlloc(MEM_OPTIMIZER, (n + 1) * sizeof(int));
+    if (l.counts == NULL || l.next == NULL || l.prev == NULL || l.chainOf == NULL ||
+        l.jumps == NULL || edges == NULL || chains == NULL || order == NULL)
+    {
+        printError("%s", ERROR0);
+        n = 0; /* nothing is laid out */
+    }
+
+    /* The labels at the end of the program (with no instruction after
+     * them) are a block of their own, which stays at the end.
+     */
+    l.end = n;
+    if (n > 0)
+    {
+        BasicBlock *block = &l.cfg.blocks[n - 1];
+
+        l.end = n - 1;
+        for (k = block->first; k <= block->last; k++)
+            if (prog->instrs[k].name != NULL)
+                l.end = n;
+    }
+    for (b = 0; b < n; b++)
+    {
+        l.next[b] = l.prev[b] = l.jumps[b] = -1;
+        l.chainOf[b] = b;
+    }
+    if (n > 0)
+        countBlocks(&l, &profile);
+    profileFree(&profile);
+
+    /* Join the blocks that must follow each other, then the others by
+     * the edges between them, the edge most often taken first.  Only
+     * the edges between blocks that ran count, so a block that never
+     * ran doesn't join a hot chain; those go last, in source order.
+     */
+    for (b = 0; b + 1 < l.end; b++)
+        if (mustFollow(&l, b))
+            joinChains(&l, b, b + 1);
+    for (b = 0; b < l.end; b++)
+    {
+        int fall, target, branch = l.cfg.blocks[b].branch;
+
+        successors(&l, b, &fall, &target);
+        if (fall != -1 && fall < l.end && l.counts[b] > 0 && l.counts[fall] > 0)
+        {
+            edges[nbrEdges].from = b;
+            edges[nbrEdges].to = fall;
+            edges[nbrEdges].weight = l.counts[b] < l.counts[fall] ? l.counts[b] : l.counts[fall];
+            edges[nbrEdges++].fallThrough = 1;
+        }
+        if (target != -1 && target < l.end && l.counts[b] > 0 && l.counts[target] > 0 &&
+            (*prog->instrs[branch].f.opType == 'I' || isRemovableJump(&l, branch)))
+        {
+            edges[nbrEdges].from = b;
+            edges[nbrEdges].to = target;
+            edges[nbrEdges].weight = l.counts[b] < l.counts[target] ? l.counts[b] : l.counts[target];
+            edges[nbrEdges++].fallThrough = 0;
+        }
+    }
+    qsort(edges, nbrEdges, sizeof(Edge), compareEdges);
+    for (k = 0; k < nbrEdges; k++)
+    {
+        Edge *edge = &edges[k];
+
+        if (l.next[edge->from] == -1 && l.prev[edge->to] == -1 && edge->to != 0 &&
+            findChain(&l, edge->from) != findChain(&l, edge->to))
+            joinChains(&l, edge->from, edge->to);
+    }
+
+    /* The chain of the first block goes first, and the chain that must
+     * run on into the end of the program goes last; the others go in
+     * between, hottest first.
+     */
+    if (l.end > 0)
+    {
+        first = findChain(&l, 0);
+        last = l.end > 1 && mustFollow(&l, l.end - 1) ? findChain(&l, l.end - 1) : -1;
+        if (last == first)
+            last = -1;
+        for (b = 1; b < l.end; b++)
+        {
+            if (l.prev[b] != -1 || findChain(&l, b) == first || findChain(&l, b) == last)
+                continue;
+            chains[nbrChains].head = b;
+            chains[nbrChains].count = 0;
+            for (k = b; k != -1; k = l.next[k])
+                if (l.counts[k] > chains[nbrChains].count)
+                    chains[nbrChains].count = l.counts[k];
+            nbrChains++;
+        }
+        qsort(chains, nbrChains, sizeof(Chain), compareChains);
+
+        nbrOrdered = appendChain(&l, 0, order, nbrOrdered);
+        for (k = 0; k < nbrChains; k++)
+            nbrOrdered = appendChain(&l, chains[k].head, order, nbrOrdered);
+        if (last != -1)
+        {
+            for (b = l.end - 1; l.prev[b] != -1; b = l.prev[b])
+                ;
+            nbrOrdered = appendChain(&l, b, order, nbrOrdered);
+        }
+        if (l.end < n)
+            order[nbrOrdered++] = l.end;
+    }
+
+    for (k = 1; k < nbrOrdered; k++)
+        moved += order[k] != order[k - 1] + 1;
+    if (moved > 0)
+        (void)rewrite(&l, order, nbrOrdered); /* error message already printed */
+    TRACE(TRACE_OPTIMIZER, 1, "profile layout: %d blocks moved.\n", moved);
+
+    memFree(l.counts);
+    memFree(l.next);
+    memFree(l.prev);
+    memFree(l.chainOf);
+    memFree(l.jumps);
+    memFree(l.endLabel);
+    memFree(edges);
+    memFree(chains);
+    memFree(order);
+    cfgFree(&l.cfg);
+    return moved;
+}
+
+static int readProfile(Profile *profile, char *fileName)
+/* Postcondition: the counts in the file fileName are in profile, the
+   *      addresses sorted.
+   * Returns 1 if everything went OK; 0 if the file can't be read, has
+   *      a line that isn't a label or address and its count, or memory
+   *      allocation error (an error message is printed).
+   */
+{
+    char line[BUFSIZ];
+    FILE *fp;
+    int lineNum = 0, ok = 1;
+
+    tableInit(&profile->labels);
+    profile->capacity = profile->nbrAddresses = 0;
+    profile->addresses = NULL;
+    if ((fp = fopen(fileName, "r")) == NULL)
+    {
+        printError("Error: Cannot open file %s.\n", fileName);
+        return 0;
+    }
+    if ((fp = decompressOpen(fp, fileName)) == NULL)
+        return 0; /* error message already printed */
+
+    while (ok && fgets(line, sizeof(line), fp) != NULL)
+    {
+        char *name = line + strspn(line, " \t");
+        size_t length = strcspn(name, " \t:#\r\n");
+        char *rest = name + length + (name[length] == ':');
+        int isAddress = isdigit((unsigned char)*name);
+        char *end, *addressEnd = name;
+        long count, address = 0;
+
+        lineNum++;
+        if (length == 0 && (*name == '#' || *name == '\r' || *name == '\n' || *name == '\0'))
+            continue; /* a comment or a blank line */
+
+        count = strtol(rest, &end, 10);
+        if (end != rest)
+            end += strspn(end, " \t\r\n");
+        name[length] = '\0';
+        if (isAddress)
+            address = strtol(name, &addressEnd, 0);
+        if (length == 0 || end == rest || count < 0 || (*end != '\0' && *end != '#') ||
+            (isAddress && *addressEnd != '\0'))
+        {
+            printError("Error: %s, line %d: expected a label or address, and its count.\n",
+                       fileName, lineNum);
+            ok = 0;
+        }
+        else if (!isAddress && findLabel(&profile->labels, name) != -1)
+        {
+            printError("Error: %s, line %d: %s is counted twice.\n", fileName, lineNum, name);
+            ok = 0;
+        }
+        else if (isAddress)
+            ok = addAddressCount(profile, (int)address, count > INT_MAX ? INT_MAX : (int)count);
+        else
+            ok = addLabel(&profile->labels, name, count > INT_MAX ? INT_MAX : (int)count);
+    }
+    (void)fclose(fp);
+
+    if (profile->nbrAddresses > 0)
+        qsort(profile->addresses, profile->nbrAddresses, sizeof(AddressCount),
+              compareAddressCounts);
+    return ok;
+}
+
+static int addAddressCount(Profile *profile, int address, int count)
+/* Postcondition: the count of the instruction at address has been
+   *      added to profile.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    if (profile->nbrAddresses >= profile->capacity)
+    {
+        int capacity = profile->capacity == 0 ? 256 : profile->capacity * 2;
+        AddressCount *addresses = memRealloc(MEM_OPTIMIZER, profile->addresses,
+                                             capacity * sizeof(AddressCount));
+
+        if (addresses == NULL)
+        {
+            printError("%s", ERROR0);
+            return 0; /* fatal error: couldn't allocate memory */
+        }
+        profile->addresses = addresses;
+        profile->capacity = capacity;
+    }
+    profile->addresses[profile->nbrAddresses].address = address;
+    profile->addresses[profile->nbrAddresses++].count = count;
+
+    return 1;
+}
+
+static int addressCount(Profile *profile, int address)
+/* Returns the count of the instruction at address; -1 if it is not in
+   * profile.
+   */
+{
+    AddressCount key, *found;
+
+    if (profile->nbrAddresses == 0)
+        return -1;
+    key.address = address;
+    found = bsearch(&key, profile->addresses, profile->nbrAddresses, sizeof(AddressCount),
+                    compareAddressCounts);
+    return found == NULL ? -1 : found->count;
+}
+
+static void profileFree(Profile *profile)
+/* Postcondition: all the memory used by profile has been freed. */
+{
+    tableFree(&profile->labels);
+    memFree(profile->addresses);
+    profile->addresses = NULL;
+    profile->capacity = profile->nbrAddresses = 0;
+}
+
+static void countBlocks(Layout *l, Profile *profile)
+/* Postcondition: the count of each block in l is the largest count in
+   *      profile of its labels and instructions; if it has none, that
+   *      of the block before it if profile has labels only, and 0
+   *      otherwise.
+   */
+{
+    int b, i;
+
+    for (b = 0; b < l->cfg.nbrBlocks; b++)
+    {
+        BasicBlock *block = &l->cfg.blocks[b];
+        int count = -1, c;
+
+        for (i = block->first; i <= block->last; i++)
+        {
+            Instruction *instr = &l->prog->instrs[i];
+
+            if (instr->label != NULL && (c = findLabel(&profile->labels, instr->label)) > count)
+                count = c;
+            if (instr->name != NULL && (c = addressCount(profile, instr->address)) > count)
+                count = c;
+        }
+        if (count == -1)
+            count = b > 0 && profile->nbrAddresses == 0 ? l->counts[b - 1] : 0;
+        l->counts[b] = count;
+    }
+}
+
+static void successors(Layout *l, int b, int *fall, int *target)
+/* Postcondition: fall is the block that block b runs on into (the
+   *      end, if it is the last), or -1 if it can't; target is the
+   *      block that its branch or jump goes to, or -1 if there is
+   *      none, it is not known, or it is a call (jal).
+   */
+{
+    int branch = l->cfg.blocks[b].branch;
+    Instruction *br;
+    int index;
+
+    *fall = b + 1;
+    *target = -1;
+    if (branch == -1)
+        return;
+    br = &l->prog->instrs[branch];
+    if (br->target != NULL && (index = findInstruction(l->prog, l->table, br->target)) != -1)
+        *target = l->cfg.blockOf[index];
+
+    if (*br->f.opType == 'J' && br->f.code == 3)
+        *target = -1; /* the function returns after the jal */
+    else if (*br->f.opType != 'I' || (br->f.code == 4 && br->rs == br->rt))
+        *fall = -1;   /* j, jr, or a beq that is always taken */
+}
+
+static int mustFollow(Layout *l, int b)
+/* Returns 1 if block b must be followed by the next block: if it ends
+   * in a jal, which returns to the next block, or the next block is
+   * the labeled delay slot of its branch; 0 otherwise.
+   */
+{
+    int branch = l->cfg.blocks[b].branch;
+    BasicBlock *next = b + 1 < l->cfg.nbrBlocks ? &l->cfg.blocks[b + 1] : NULL;
+
+    if (branch != -1 && *l->prog->instrs[branch].f.opType == 'J' &&
+        l->prog->instrs[branch].f.code == 3)
+        return 1;
+    return next != NULL && next->branch != -1 && next->branch < next->first;
+}
+
+static int isRemovableJump(Layout *l, int index)
+/* Returns 1 if the statement at index is a j whose delay slot is an
+   * unlabeled nop, so that both can be deleted if its target comes
+   * right after it; 0 otherwise.
+   */
+{
+    Instruction *instr, *slot;
+
+    if (index == -1 || index + 1 >= l->prog->nbrInstrs)
+        return 0;
+    instr = &l->prog->instrs[index];
+    slot = &l->prog->instrs[index + 1];
+    return *instr->f.opType == 'J' && instr->f.code == 2 && slot->label == NULL && isNop(slot);
+}
+
+static int isNop(Instruction *instr)
+/* Returns 1 if instr is a nop (sll $zero, $zero, 0); 0 otherwise. */
+{
+    return instr->name != NULL && *instr->f.opType == 'R' && instr->f.code == 0 &&
+           instr->rd == 0 && instr->rt == 0 && instr->shamt == 0 && instr->expr == NULL;
+}
+
+static int findChain(Layout *l, int b)
+/* Returns the block that names the chain of block b (the same for
+   * every block in the chain).
+   */
+{
+    while (l->chainOf[b] != b)
+    {
+        l->chainOf[b] = l->chainOf[l->chainOf[b]];
+        b = l->chainOf[b];
+    }
+    return b;
+}
+
+static void joinChains(Layout *l, int from, int to)
+/* Postcondition: block to, the head of its chain, follows block from,
+   *      the tail of another, so the two chains are one.
+   */
+{
+    l->next[from] = to;
+    l->prev[to] = from;
+    l->chainOf[findChain(l, to)] = findChain(l, from);
+}
+
+static int appendChain(Layout *l, int head, int *order, int nbrOrdered)
+/* Postcondition: the blocks of the chain that starts at head have been
+   *      added to the nbrOrdered blocks in order.
+   * Returns the new nbr of blocks in order.
+   */
+{
+    int b;
+
+    for (b = head; b != -1; b = l->next[b])
+        order[nbrOrdered++] = b;
+    return nbrOrdered;
+}
+
+static char *labelOf(Layout *l, int b)
+/* Returns a label of block b (the end of the program if b is past the
+   * last block), making one up if it has none; NULL if memory
+   * allocation error (an error message is printed).
+   */
+{
+    char label[32];
+    char **place;
+
+    if (b < l->cfg.nbrBlocks)
+        place = &l->prog->instrs[l->cfg.blocks[b].first].label;
+    else
+        place = &l->endLabel;
+    if (*place != NULL)
+        return *place;
+
+    sprintf(label, "layout:%d", ++l->nbrLabels);
+    if ((*place = memStrdup(MEM_OPTIMIZER, label)) == NULL)
+        printError("%s", ERROR0);
+    return *place;
+}
+
+static int rewrite(Layout *l, int *order, int nbrOrdered)
+/* Postcondition: the blocks of the program are in the given order,
+   *      with branches inverted and jumps added or deleted so that
+   *      each block still goes where it went, and the program has been
+   *      laid out again.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    Program *prog = l->prog;
+    Program out; /* the program with its blocks in order */
+    int k, i;
+
+    /* Decide how each block gets to the block that it ran on into,
+     * making up the labels this needs before the blocks are moved.
+     */
+    for (k = 0; k < nbrOrdered; k++)
+    {
+        int b = order[k], after = k + 1 < nbrOrdered ? order[k + 1] : l->end;
+        int branch = b < l->end ? l->cfg.blocks[b].branch : -1;
+        int fall, target;
+
+        if (b >= l->end)
+            continue;
+        successors(l, b, &fall, &target);
+
+        if (fall != -1 && fall != after && target == after && *prog->instrs[branch].f.opType == 'I')
+        {
+            /* the opposite branch, to the block it ran on into */
+            Instruction *br = &prog->instrs[branch];
+            char *label = labelOf(l, fall);
+            char *name, *to;
+
+            if (label == NULL)
+                return 0; /* error message already printed */
+            name = memStrdup(MEM_OPTIMIZER, br->f.code == 4 ? "bne" : "beq");
+            to = memStrdup(MEM_OPTIMIZER, label);
+            if (name == NULL || to == NULL)
+            {
+                memFree(to);
+                memFree(name);
+                printError("%s", ERROR0);
+                return 0;
+            }
+            TRACE(TRACE_OPTIMIZER, 2, "%s: %s to %s inverted.\n",
+                  lineName(br->lineNum), br->name, br->target);
+            memFree(br->name);
+            memFree(br->target);
+            br->name = name;
+            br->target = to;
+            br->f.code = br->f.code == 4 ? 5 : 4;
+        }
+        else if (fall != -1 && fall != after)
+        {
+            if (labelOf(l, fall) == NULL)
+                return 0; /* error message already printed */
+            l->jumps[b] = fall;
+        }
+        else if (fall == -1 && target == after && isRemovableJump(l, branch))
+        {
+            /* the j and its nop are left as empty statements */
+            TRACE(TRACE_OPTIMIZER, 2, "%s: j to %s deleted.\n",
+                  lineName(prog->instrs[branch].lineNum), prog->instrs[branch].target);
+            memFree(prog->instrs[branch].name);
+            memFree(prog->instrs[branch].target);
+            memFree(prog->instrs[branch + 1].name);
+            prog->instrs[branch].name = prog->instrs[branch].target = NULL;
+            prog->instrs[branch + 1].name = NULL;
+        }
+    }
+
+    /* Copy the blocks in order, each followed by its jump, if any. */
+    programInit(&out);
+    if (!programResize(&out, prog->nbrInstrs + 2 * nbrOrdered + 1))
+        return 0; /* error message already printed */
+    for (k = 0; k < nbrOrdered; k++)
+    {
+        BasicBlock *block = &l->cfg.blocks[order[k]];
+
+        for (i = block->first; i <= block->last; i++)
+            if (!addInstruction(&out, &prog->instrs[i]))
+                break; /* error message already printed */
+        if (l->jumps[order[k]] != -1 &&
+            !addJump(&out, &prog->instrs[block->last], labelOf(l, l->jumps[order[k]])))
+            break; /* error message already printed */
+    }
+    if (l->endLabel != NULL)
+    {
+        Instruction end;
+
+        memset(&end, 0, sizeof(end));
+        end.lineNum = prog->nbrInstrs > 0 ? prog->instrs[prog->nbrInstrs - 1].lineNum : 0;
+        end.label = l->endLabel;
+        if (addInstruction(&out, &end))
+            l->endLabel = NULL; /* now belongs to out */
+    }
+
+    /* The statements (and the strings they own) now belong to out;
+     * the data segment is unchanged.
+     */
+    memFree(prog->instrs);
+    prog->instrs = out.instrs;
+    prog->capacity = out.capacity;
+    prog->nbrInstrs = out.nbrInstrs;
+    tableFree(&out.data.labels);
+
+    return layoutProgram(prog, l->table);
+}
+
+static int addJump(Program *out, Instruction *model, char *target)
+/* Adds a j to target, and a nop in its delay slot, to out, with the
+   * line number of model.  The target is copied.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    Instruction jump, nop;
+
+    memset(&jump, 0, sizeof(jump));
+    jump.lineNum = model->lineNum;
+    jump.f.code = 2;
+    jump.f.opType = "J";
+    nop = jump;
+    nop.f.code = 0;
+    nop.f.opType = "R";
+    if ((jump.name = memStrdup(MEM_OPTIMIZER, "j")) == NULL ||
+        (jump.target = memStrdup(MEM_OPTIMIZER, target)) == NULL ||
+        (nop.name = memStrdup(MEM_OPTIMIZER, "nop")) == NULL)
+    {
+        memFree(jump.name);
+        memFree(jump.target);
+        printError("%s", ERROR0);
+        return 0;
+    }
+
+    return addInstruction(out, &jump) && addInstruction(out, &nop);
+}
+
+static int compareEdges(const void *a, const void *b)
+/* Compares two edges for qsort: the one most often taken first, then
+   * the one that falls through, then in source order.
+   */
+{
+    const Edge *x = a, *y = b;
+
+    if (x->weight != y->weight)
+        return x->weight > y->weight ? -1 : 1;
+    if (x->fallThrough != y->fallThrough)
+        return y->fallThrough - x->fallThrough;
+    if (x->from != y->from)
+        return x->from - y->from;
+    return x->to - y->to;
+}
+
+static int compareChains(const void *a, const void *b)
+/* Compares two chains for qsort: the hottest first, then in source
+   * order.
+   */
+{
+    const Chain *x = a, *y = b;
+
+    if (x->count != y->count)
+        return x->count > y->count ? -1 : 1;
+    return x->head - y->head;
+}
+
+static int compareAddressCounts(const void *a, const void *b)
+/* Compares two address counts by address, for qsort and bsearch. */
+{
+    const AddressCount *x = a, *y = b;
+
+    return (x->address > y->address) - (x->address < y->address);
+}
@@ -0,0 +1,241 @@
+/*
+ * This file contains branch relaxation, the pass that rewrites the
+ * branches and jumps whose target is too far away to be encoded.
+ *
+ * A beq or bne holds the distance to its target in 16 bits, counted
+ * in instructions from the one after the branch, so it can only reach
+ * 32768 instructions back or 32767 forward.  One that goes further is
+ * rewritten as the opposite branch over a jump to the target:
+ *
+ *          beq $rs, $rt, far           bne $rs, $rt, relax:1
+ *          <delay slot>        =>      <delay slot>
+ *                                      j far
+ *                                      nop
+ *                              relax:1:
+ *
+ * The delay slot still executes whether the branch is taken or not.  A
+ * j holds only the low 28 bits of its target, so it can only reach the
+ * 256 MB region that the instruction after it is in.  One that goes
+ * further is rewritten as a jump through $at, which it may use:
+ *
+ *          j far                       lui $at, %hi(far)
+ *          <delay slot>        =>      addiu $at, $at, %lo(far)
+ *                                      jr $at
+ *                                      <delay slot>
+ *
+ * A jal that goes further can't be rewritten, since there is no jalr,
+ * and neither can a branch whose delay slot is labeled (other code
+ * would run the jump added after it); pass2 reports them.  Rewriting
+ * makes the program longer, which can push other branches out of range,
+ * so the program is laid out again and checked again until no branch
+ * needs rewriting.  The labels that are made up (relax:1, ...) contain
+ * a colon, so they can't be the same as a label in the source.  The
+ * program is only copied and laid out again if a branch or jump needs
+ * rewriting; most don't, so a first look finds nothing to do.  It looks
+ * the targets up in a copy of the label table sorted by name, rather
+ * than one by one in the table.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include "assembler.h"
+#include "optimize.h"
+
+/* The range of a branch offset, in instructions. */
+#define MIN_OFFSET (-32768)
+#define MAX_OFFSET 32767
+
+/* The bits of an address that a j or jal can't change. */
+#define REGION_MASK 0xF0000000u
+
+/* The register the assembler may use ($at). */
+#define AT 1
+
+/* The kinds of rewriting an instruction needs. */
+enum {IN_RANGE, FAR_BRANCH, FAR_JUMP};
+
+/* internal functions (visible to this file only)*/
+static int relaxKind(Program *prog, int i, LabelTable *sorted);
+static int needsRelaxing(Instruction *instr, LabelTable *sorted);
+static int addSynthetic(Program *out, Instruction *model, char *name, char *opType,
+                        int code, int rs, int rt, char *target);
+
+int relaxBranches(Program *prog, LabelTable *table)
+/* Rewrites every branch and jump whose target is out of its reach,
+   * until there are none, and lays the program out again.
+   * Returns the number of branches and jumps that were rewritten.
+   */
+{
+    int relaxed = 0; /* rewrites made so far (also numbers the labels) */
+    int changes;     /* rewrites made in this sweep */
+
+    do
+    {
+        Program out; /* the program with its far branches rewritten */
+        LabelTable sorted; /* the labels, by name */
+        int i;
+
+        /* Only copy the program if something needs rewriting. */
+        if (!tableSortedCopy(&sorted, table))
+            break; /* error message already printed */
+        for (i = 0; i < prog->nbrInstrs; i++)
+            if (relaxKind(prog, i, &sorted) != IN_RANGE)
+                break;
+        if (i == prog->nbrInstrs)
+        {
+            memFree(sorted.entries);
+            break;
+        }
+
+        changes = 0;
+        programInit(&out);
+        if (!programResize(&out, prog->nbrInstrs + 1))
+        {
+            memFree(sorted.entries);
+            return relaxed; /* error message already printed */
+        }
+
+        for (i = 0; i < prog->nbrInstrs; i++)
+        {
+            Instruction *instr = &prog->instrs[i];
+            Instruction *slot = &prog->instrs[i + 1];
+            int kind = relaxKind(prog, i, &sorted);
+            char over[32];
+
+            if (kind == IN_RANGE)
+            {
+                if (!addInstruction(&out, instr))
+                    break; /* error message already printed */
+                continue;
+            }
+
+            TRACE(TRACE_OPTIMIZER, 2, "%s: %s to %s relaxed.\n",
+                  lineName(instr->lineNum), instr->name, instr->target);
+            changes++;
+            if (kind == FAR_BRANCH)
+            {
+                /* the opposite branch over the delay slot and a jump */
+                sprintf(over, "relax:%d", relaxed + changes);
+                if (!addSynthetic(&out, instr, instr->f.code == 4 ? "bne" : "beq", "I",
+                                  instr->f.code == 4 ? 5 : 4, instr->rs, instr->rt, over) ||
+                    !addInstruction(&out, slot) ||
+                    !addSynthetic(&out, instr, "j", "J", 2, 0, 0, instr->target) ||
+                    !addSynthetic(&out, instr, "nop", "R", 0, 0, 0, NULL) ||
+                    !addSynthetic(&out, instr, NULL, NULL, 0, 0, 0, NULL))
+                    break; /* error message already printed */
+                if ((out.instrs[out.nbrInstrs - 1].label = memStrdup(MEM_OPTIMIZER, over)) == NULL)
+                {
+                    printError("Error: cannot allocate space in memory.\n");
+                    break;
+                }
+            }
+            else
+            {
+                /* a jump through $at, keeping the delay slot after it */
+                if (!addSynthetic(&out, instr, "lui", "I", 15, 0, AT, instr->target) ||
+                    !addSynthetic(&out, instr, "addiu", "I", 9, AT, AT, instr->target) ||
+                    !addSynthetic(&out, instr, "jr", "R", 8, AT, 0, NULL) ||
+                    !addInstruction(&out, slot))
+                    break; /* error message already printed */
+            }
+
+            /* The delay slot has been copied; the branch has been
+             * replaced (but its label still marks the first of the new
+             * instructions).
+             */
+            out.instrs[out.nbrInstrs - (kind == FAR_BRANCH ? 5 : 4)].label = instr->label;
+            memFree(instr->name);
+            memFree(instr->target);
+            i++;
+        }
+
+        /* The statements (and the strings they own) now belong to out;
+         * the data segment is unchanged.
+         */
+        memFree(sorted.entries);
+        memFree(prog->instrs);
+        prog->instrs = out.instrs;
+        prog->capacity = out.capacity;
+        prog->nbrInstrs = out.nbrInstrs;
+        tableFree(&out.data.labels);
+
+        if (!layoutProgram(prog, table))
+            break; /* error message already printed */
+        relaxed += changes;
+    } while (changes > 0);
+
+    TRACE(TRACE_OPTIMIZER, 1, "branch relaxation: %d rewritten.\n", relaxed);
+    return relaxed;
+}
+
+static int relaxKind(Program *prog, int i, LabelTable *sorted)
+/* Returns the kind of rewriting that the statement at index i needs
+   * (see needsRelaxing), or IN_RANGE if it can't be rewritten: a jal,
+   * or a branch or jump whose delay slot is missing or labeled (left
+   * for pass2 to report).
+   */
+{
+    Instruction *slot = i + 1 < prog->nbrInstrs ? &prog->instrs[i + 1] : NULL;
+    int kind = needsRelaxing(&prog->instrs[i], sorted);
+
+    if (slot == NULL || slot->name == NULL || (kind == FAR_JUMP && prog->instrs[i].f.code == 3))
+        return IN_RANGE;
+    return kind;
+}
+
+static int needsRelaxing(Instruction *instr, LabelTable *sorted)
+/* Returns FAR_BRANCH if instr is a beq or bne whose target is out of
+   * range, FAR_JUMP if it is a j or jal whose target is in another
+   * region, and IN_RANGE otherwise (including when the target is not
+   * defined, which pass2 reports).  The labels are in sorted, by name.
+   */
+{
+    int address;
+
+    if (instr->name == NULL || instr->target == NULL ||
+        (address = findSortedLabel(sorted, instr->target)) == -1)
+        return IN_RANGE;
+
+    if (*instr->f.opType == 'I' && (instr->f.code == 4 || instr->f.code == 5))
+    {
+        int offset = (address - (instr->address + 4)) / 4;
+        return offset < MIN_OFFSET || offset > MAX_OFFSET ? FAR_BRANCH : IN_RANGE;
+    }
+    if (*instr->f.opType == 'J')
+    {
+        unsigned int next = (unsigned int)instr->address + 4;
+        return (next & REGION_MASK) != ((unsigned int)address & REGION_MASK) ? FAR_JUMP : IN_RANGE;
+    }
+    return IN_RANGE;
+}
+
+static int addSynthetic(Program *out, Instruction *model, char *name, char *opType,
+                        int code, int rs, int rt, char *target)
+/* Adds an instruction made up by the assembler to out, with the line
+   * number and mode of model.  A NULL name adds an empty statement (for
+   * a label).  The name and target are copied.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    Instruction instr;
+
+    memset(&instr, 0, sizeof(instr));
+    instr.lineNum = model->lineNum;
+    instr.reorder = model->reorder;
+    instr.f.code = code;
+    instr.f.opType = opType;
+    instr.rs = rs;
+    instr.rt = rt;
+    if ((name != NULL && (instr.name = memStrdup(MEM_OPTIMIZER, name)) == NULL) ||
+        (target != NULL && (instr.target = memStrdup(MEM_OPTIMIZER, target)) == NULL))
+    {
+        memFree(instr.name);
+        printError("Error: cannot allocate space in memory.\n");
+        return 0;
+    }
+
+    return addInstruction(out, &instr);
+}
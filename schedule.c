@@ -0,0 +1,219 @@
+/*
+ * This file contains the instruction scheduler, an optional pass
+ * (--schedule) that reorders the instructions inside each basic block
+ * (see CFG.h) to hide load-use stalls.  On the classic 5-stage
+ * pipeline, the value loaded by an lw is only ready after its MEM
+ * stage, so an instruction that uses it right after the lw stalls for
+ * a cycle; with another instruction in between, it doesn't.
+ *
+ * The scheduler is a list scheduler.  It finds which instructions of a
+ * block depend on which from the registers they read and write (and
+ * keeps loads and stores in order around a store), then places them
+ * one at a time, picking from the instructions whose predecessors are
+ * all placed:
+ *      - one that can start without a stall, if any,
+ *      - then the one with the longest chain of dependent instructions
+ *        after it (so loads at the head of a chain go first),
+ *      - then the one that came first in the source.
+ * An instruction that uses a loaded register can only start two
+ * cycles after the load; any other dependent instruction, one.
+ *
+ * Labels stay where they are: a block can only be entered at its
+ * first instruction, whose label stays on the first one after
+ * scheduling.  The branch or jump that ends a block, and its delay
+ * slot, stay at the end of the block, and only the instructions before
+ * them move, so the addresses of the labels don't change.  Long blocks
+ * are scheduled MAX_WINDOW instructions at a time.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include "assembler.h"
+#include "optimize.h"
+
+/* The most instructions scheduled together. */
+#define MAX_WINDOW 32
+
+/* The cycles from the start of an instruction to the start of one that
+ * depends on it: two from a load to a use of its register, one else.
+ */
+#define LOAD_USE_LATENCY 2
+#define LATENCY 1
+
+/* internal functions (visible to this file only)*/
+static void scheduleWindow(Program *prog, int first, int n, Instruction *branch,
+                           Instruction *window);
+static int latency(Instruction *first, Instruction *second);
+static int countStalls(Program *prog, int first, int last);
+
+int scheduleLoads(Program *prog, LabelTable *table)
+/* Reorders the instructions inside each basic block so that as few
+   * loads as possible are followed right away by a use of the register
+   * they load.
+   * Returns the number of load-use stalls removed.
+   */
+{
+    Instruction window[MAX_WINDOW]; /* the instructions being placed */
+    CFG cfg;
+    int before = 0, after = 0; /* stalls before and after scheduling */
+    int b, i;
+
+    if (!buildCFG(&cfg, prog, table))
+        return 0; /* error message already printed */
+
+    for (b = 0; b < cfg.nbrBlocks; b++)
+    {
+        BasicBlock *block = &cfg.blocks[b];
+        int first = block->first, end = block->last + 1;
+
+        /* Skip the labels at the start of the block, and leave the
+         * branch and its delay slot at the end (a labeled delay slot
+         * is a block of its own, which must stay first).
+         */
+        while (first < end && prog->instrs[first].name == NULL)
+            first++;
+        if (block->branch != -1)
+            end = block->branch < first ? first : block->branch;
+
+        before += countStalls(prog, block->first, block->last);
+        for (i = first; i < end; i += MAX_WINDOW)
+        {
+            int n = end - i < MAX_WINDOW ? end - i : MAX_WINDOW;
+            Instruction *branch = i + n == end && block->branch >= end ?
+                                      &prog->instrs[block->branch] : NULL;
+
+            scheduleWindow(prog, i, n, branch, window);
+        }
+        after += countStalls(prog, block->first, block->last);
+    }
+    cfgFree(&cfg);
+
+    TRACE(TRACE_OPTIMIZER, 1, "scheduling: %d load-use stalls, %d removed.\n",
+          before, before - after);
+    return before - after;
+}
+
+static void scheduleWindow(Program *prog, int first, int n, Instruction *branch,
+                           Instruction *window)
+/* Reorders the n instructions starting at index first, which are all
+   * in one basic block, using window (room for n instructions) to hold
+   * them.  branch, if not NULL, is the branch or jump that comes after
+   * them, which they may be loading a register for.
+   */
+{
+    Instruction *instrs = prog->instrs + first;
+    uint32_t preds[MAX_WINDOW];    /* the instructions each depends on */
+    int height[MAX_WINDOW];        /* cycles from its start to the end */
+    int start[MAX_WINDOW];         /* cycle it was placed at, or -1 */
+    char *label = instrs[0].label; /* stays on the first instruction */
+    int cycle = 0;
+    int i, j, k;
+
+    /* Find the dependences, and how long the chain after each
+     * instruction is (the branch after them counts too).
+     */
+    for (j = n - 1; j >= 0; j--)
+    {
+        preds[j] = 0;
+        start[j] = -1;
+        height[j] = branch != NULL ? latency(&instrs[j], branch) : LATENCY;
+        for (i = j + 1; i < n; i++)
+        {
+            if (dependsOn(&instrs[i], &instrs[j]))
+            {
+                preds[i] |= (uint32_t)1 << j;
+                if (latency(&instrs[j], &instrs[i]) + height[i] > height[j])
+                    height[j] = latency(&instrs[j], &instrs[i]) + height[i];
+            }
+        }
+    }
+
+    /* Place the instructions one cycle after another. */
+    for (k = 0; k < n; k++)
+    {
+        int best = -1, bestStart = 0;
+
+        for (i = 0; i < n; i++)
+        {
+            int earliest = cycle;
+
+            if (start[i] != -1)
+                continue;
+            for (j = 0; j < i; j++)
+            {
+                if (!(preds[i] >> j & 1))
+                    continue;
+                if (start[j] == -1)
+                    break;
+                if (start[j] + latency(&instrs[j], &instrs[i]) > earliest)
+                    earliest = start[j] + latency(&instrs[j], &instrs[i]);
+            }
+            if (j < i)
+                continue; /* a predecessor isn't placed yet */
+
+            /* the instruction before the window may be a load too */
+            if (k == 0 && first > 0 && latency(&prog->instrs[first - 1], &instrs[i]) > LATENCY)
+                earliest = cycle + LOAD_USE_LATENCY - LATENCY;
+
+            if (best == -1 || earliest < bestStart ||
+                (earliest == bestStart && height[i] > height[best]))
+            {
+                best = i;
+                bestStart = earliest;
+            }
+        }
+
+        start[best] = bestStart;
+        window[k] = instrs[best];
+        cycle = bestStart + 1;
+    }
+
+    /* Put them back in their new order; the addresses are the same. */
+    for (k = 0; k < n; k++)
+    {
+        if (window[k].name != instrs[k].name)
+            TRACE(TRACE_OPTIMIZER, 2, "%s: scheduled at %d.\n",
+                  lineName(window[k].lineNum), instrs[k].address);
+        window[k].address = instrs[k].address;
+        window[k].label = NULL;
+    }
+    memcpy(instrs, window, n * sizeof(Instruction));
+    instrs[0].label = label;
+}
+
+static int latency(Instruction *first, Instruction *second)
+/* Returns the cycles needed from the start of first to the start of
+   * second, which comes after it: LOAD_USE_LATENCY if first is a load
+   * of a register that second reads; LATENCY otherwise.
+   */
+{
+    int dest = destRegister(first);
+
+    if (isMemoryAccess(first) == 1 && dest > 0 && readsRegister(second, dest))
+        return LOAD_USE_LATENCY;
+    return LATENCY;
+}
+
+static int countStalls(Program *prog, int first, int last)
+/* Returns the nbr of instructions from index first to last that use
+   * the register loaded by the instruction right before them.
+   */
+{
+    Instruction *prev = NULL;
+    int stalls = 0;
+    int i;
+
+    for (i = first; i <= last; i++)
+    {
+        if (prog->instrs[i].name == NULL)
+            continue;
+        if (prev != NULL && latency(prev, &prog->instrs[i]) > LATENCY)
+            stalls++;
+        prev = &prog->instrs[i];
+    }
+
+    return stalls;
+}
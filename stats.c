@@ -0,0 +1,210 @@
+/*
+ * Stats: functions to time the phases of the assembler and report them
+ *
+ * This file provides the definitions of the functions that time the
+ * phases of the assembler, print the times and counters (--stats), and
+ * write the timed phases as Chrome trace events (--trace=file.json).
+ * See stats.h.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <time.h>
+#include "assembler.h"
+
+/* Define the global STATS structure; every counter starts at 0 (as
+ * for any global variable).  Each thread has its own, and times its
+ * own phases.
+ */
+_Thread_local Stats STATS;
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+static const char *ERROR1 = "Error: cannot write the trace to %s.\n";
+
+static const char *PHASE_NAMES[NBR_PHASES] =
+    {"args", "pass1", "optimize", "pass2", "output"};
+
+/* A trace event records one timed phase (microseconds since the first
+ * phase began) and the file being read at the time.
+ */
+typedef struct
+{
+    Phase phase;
+    double start;
+    double duration;
+    const char *fileName;
+} TraceEvent;
+
+static _Thread_local double wallStart[NBR_PHASES]; /* clocks read by statsBegin */
+static _Thread_local double cpuStart[NBR_PHASES];
+static _Thread_local double origin = -1;           /* time the first phase began */
+static _Thread_local int capacity = 0;             /* capacity of events */
+static _Thread_local int nbrEvents = 0;            /* actual nbr of events recorded */
+static _Thread_local TraceEvent *events = NULL;
+
+/* internal functions (visible to this file only)*/
+static double readClock(clockid_t clock);
+static void writeString(FILE *fp, const char *s);
+
+void statsBegin(Phase phase)
+/* Postcondition: the clocks have been read at the start of phase. */
+{
+    wallStart[phase] = readClock(CLOCK_MONOTONIC);
+    cpuStart[phase] = readClock(CLOCK_PROCESS_CPUTIME_ID);
+    if (origin < 0)
+        origin = wallStart[phase];
+}
+
+void statsEnd(Phase phase)
+/* Postcondition: the time since the matching statsBegin has been added
+   *      to the totals for phase, and recorded as a trace event for the
+   *      input file being read (OPTIONS.fileName).
+   */
+{
+    double wall = readClock(CLOCK_MONOTONIC) - wallStart[phase];
+
+    STATS.wall[phase] += wall;
+    STATS.cpu[phase] += readClock(CLOCK_PROCESS_CPUTIME_ID) - cpuStart[phase];
+
+    /* Trace events are only kept if they are going to be written. */
+    if (OPTIONS.traceFile == NULL)
+        return;
+    if (nbrEvents == capacity)
+    {
+        int newCapacity = capacity == 0 ? 16 : 2 * capacity;
+        TraceEvent *newEvents = memRealloc(MEM_OTHER, events, newCapacity * sizeof(TraceEvent));
+
+        if (newEvents == NULL)
+        {
+            printError("%s", ERROR0);
+            return;
+        }
+        events = newEvents;
+        capacity = newCapacity;
+    }
+    events[nbrEvents].phase = phase;
+    events[nbrEvents].start = (wallStart[phase] - origin) * 1e6;
+    events[nbrEvents].duration = wall * 1e6;
+    events[nbrEvents].fileName = OPTIONS.fileName;
+    nbrEvents++;
+}
+
+void statsPrint(FILE *fp)
+/* Postcondition: the time spent in each phase and the counters have
+   *      been printed to fp.
+   */
+{
+    double wall = 0, cpu = 0;
+    long instrs = STATS.rFormat + STATS.iFormat + STATS.jFormat;
+    int p;
+
+    fprintf(fp, "%-10s %12s %12s\n", "phase", "wall (ms)", "cpu (ms)");
+    for (p = 0; p < NBR_PHASES; p++)
+    {
+        fprintf(fp, "%-10s %12.3f %12.3f\n", PHASE_NAMES[p],
+                STATS.wall[p] * 1e3, STATS.cpu[p] * 1e3);
+        wall += STATS.wall[p];
+        cpu += STATS.cpu[p];
+    }
+    fprintf(fp, "%-10s %12.3f %12.3f\n", "total", wall * 1e3, cpu * 1e3);
+
+    fprintf(fp, "lines:          %ld (%.0f lines/sec)\n", STATS.lines,
+            wall > 0 ? STATS.lines / wall : 0.0);
+    fprintf(fp, "instructions:   %ld (R %ld, I %ld, J %ld)\n", instrs,
+            STATS.rFormat, STATS.iFormat, STATS.jFormat);
+    fprintf(fp, "labels:         %ld\n", STATS.labels);
+    fprintf(fp, "findLabel:      %ld calls, %ld probes (%.1f per call)\n",
+            STATS.findLabelCalls, STATS.findLabelProbes,
+            STATS.findLabelCalls > 0 ? (double)STATS.findLabelProbes / STATS.findLabelCalls : 0.0);
+    fprintf(fp, "decode cache:   %ld lookups, %ld hits (%.1f%% hit rate)\n",
+            STATS.cacheLookups, STATS.cacheHits,
+            STATS.cacheLookups > 0 ? 100.0 * STATS.cacheHits / STATS.cacheLookups : 0.0);
+    fprintf(fp, "errors:         %d\n", ERROR_COUNT);
+    fprintf(fp, "bytes written:  %ld\n", STATS.bytesWritten);
+}
+
+int statsWriteTrace(const char *fileName)
+/* Postcondition: the phases timed so far have been written to fileName
+   *      in the Chrome trace-event JSON format.
+   * Returns 1 if everything went OK; 0 if the file can't be written.
+   */
+{
+    FILE *fp = fopen(fileName, "w");
+    double end = 0;
+    int i;
+
+    if (fp == NULL)
+    {
+        printError(ERROR1, fileName);
+        return 0;
+    }
+
+    /* One complete ("X") event per phase, and the counters at the end */
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (i = 0; i < nbrEvents; i++)
+    {
+        fprintf(fp, "{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\","
+                    "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1",
+                PHASE_NAMES[events[i].phase], events[i].start, events[i].duration);
+        if (events[i].fileName != NULL)
+        {
+            fprintf(fp, ",\"args\":{\"file\":");
+            writeString(fp, events[i].fileName);
+            fprintf(fp, "}");
+        }
+        fprintf(fp, "},\n");
+        if (events[i].start + events[i].duration > end)
+            end = events[i].start + events[i].duration;
+    }
+    fprintf(fp, "{\"name\":\"counters\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,"
+                "\"args\":{\"lines\":%ld,\"instructions\":%ld,\"labels\":%ld,"
+                "\"findLabelProbes\":%ld,\"bytesWritten\":%ld}}\n",
+            end, STATS.lines, STATS.rFormat + STATS.iFormat + STATS.jFormat,
+            STATS.labels, STATS.findLabelProbes, STATS.bytesWritten);
+    fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+
+    if (fclose(fp) != 0)
+    {
+        printError(ERROR1, fileName);
+        return 0;
+    }
+    return 1;
+}
+
+void statsFree(void)
+/* Postcondition: the memory used for the trace events has been freed. */
+{
+    memFree(events);
+    events = NULL;
+    capacity = nbrEvents = 0;
+}
+
+static double readClock(clockid_t clock)
+/* Returns the time on clock, in seconds. */
+{
+    struct timespec now;
+
+    if (clock_gettime(clock, &now) != 0)
+        return 0;
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void writeString(FILE *fp, const char *s)
+/* Postcondition: s has been written to fp as a JSON string. */
+{
+    putc('"', fp);
+    for (; *s != '\0'; s++)
+    {
+        if (*s == '"' || *s == '\\')
+            fprintf(fp, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            fprintf(fp, "\\u%04x", *s);
+        else
+            putc(*s, fp);
+    }
+    putc('"', fp);
+}
@@ -0,0 +1,83 @@
+/*
+ * Stats: phase timings and counters (--stats and --trace=file.json)
+ *
+ * This file provides the data structure and declarations for measuring
+ * where the assembler spends its time.  Each phase (argument processing,
+ * pass1, the optimizer, pass2, and flushing the output) is timed with
+ * statsBegin and statsEnd, and the counters in the global STATS
+ * structure are updated by the modules that do the counting.  The
+ * totals are printed by statsPrint (--stats) and the timed phases can be
+ * written as Chrome trace events by statsWriteTrace (--trace=file.json),
+ * to be opened in a trace viewer such as chrome://tracing or Perfetto.
+ *
+ * The counters are plain increments, so they are always kept; only
+ * printing them is optional.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+/* THE DATA STRUCTURES */
+
+typedef enum
+{
+	PHASE_ARGS,		/* processing the command-line arguments */
+	PHASE_PASS1,		/* reading and decoding the source */
+	PHASE_OPTIMIZE,		/* peephole optimizer and delay slots */
+	PHASE_PASS2,		/* encoding (or, with --check, checking) */
+	PHASE_OUTPUT,		/* flushing the machine code written */
+	NBR_PHASES
+} Phase;
+
+typedef struct
+{
+	double wall[NBR_PHASES];	/* wall-clock seconds in each phase */
+	double cpu[NBR_PHASES];		/* CPU seconds in each phase */
+	long lines;			/* source lines read (after expansion) */
+	long rFormat;			/* instructions encoded, by format */
+	long iFormat;
+	long jFormat;
+	long labels;			/* labels defined */
+	long findLabelCalls;		/* label lookups */
+	long findLabelProbes;		/* entries compared by the lookups */
+	long cacheLookups;		/* statements looked up in the
+					   instruction cache (InstrCache.h) */
+	long cacheHits;			/* the ones found there */
+	long bytesWritten;		/* bytes of machine code written */
+} Stats;
+
+extern _Thread_local Stats STATS;
+
+/* THE FUNCTIONS */
+
+void statsBegin(Phase phase);
+/* Postcondition: the clocks have been read at the start of phase. */
+
+void statsEnd(Phase phase);
+/* Postcondition: the time since the matching statsBegin has been added
+         *      to the totals for phase, and recorded as a trace event
+         *      for the input file being read (OPTIONS.fileName).
+         */
+
+void statsPrint(FILE *fp);
+/* Postcondition: the time spent in each phase and the counters have
+         *      been printed to fp.
+         */
+
+int statsWriteTrace(const char *fileName);
+/* Postcondition: the phases timed so far have been written to fileName
+         *      in the Chrome trace-event JSON format.
+         * Returns 1 if everything went OK; 0 if the file can't be written.
+         */
+
+void statsFree(void);
+/* Postcondition: the memory used for the trace events has been freed. */
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Test Driver to test the assembler as a library (see libassembler.h).
+ * It is linked with libassembler.a and nothing else of the assembler,
+ * so that it fails to link if the library needs something that is only
+ * in the command-line assembler.
+ *
+ * The main method assembles a small program once, and prints its
+ * machine code.  It then assembles the same program ROUNDS times in
+ * each of NBR_THREADS threads at once, and prints how many of those
+ * assemblies gave different machine code or labels (none should).
+ * Lastly, it assembles a program with more errors than ERROR_LIMIT,
+ * with the messages printed (up to the limit) and then collected,
+ * which must return with every error counted rather than stop the
+ * program.  See TestCases.md.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <pthread.h>
+
+#include "libassembler.h"
+
+#define NBR_THREADS 8
+#define ROUNDS 50
+#define MAX_WORDS 64
+
+/* The program that every thread assembles. */
+static const char *PROGRAM =
+    "main:   la $t0, table\n"
+    "        addi $t1, $zero, 3\n"
+    "loop:   lw $t2, 0($t0)\n"
+    "        add $v0, $v0, $t2\n"
+    "        addi $t0, $t0, 4\n"
+    "        addi $t1, $t1, -1\n"
+    "        bne $t1, $zero, loop\n"
+    "        nop\n"
+    "        jr $ra\n"
+    "        nop\n"
+    "        .data\n"
+    "table:  .word 1, 2, 3\n";
+
+/* The machine code of PROGRAM, assembled before the threads start. */
+static uint32_t expected[MAX_WORDS];
+static int nbrExpected;
+
+static void *assembleRounds(void *arg);
+static void testErrors(int printErrors);
+
+int main(void)
+{
+    pthread_t threads[NBR_THREADS];
+    int different[NBR_THREADS];
+    int total = 0;
+    Assembler as;
+    int i;
+
+    assemblerInit(&as);
+    nbrExpected = assembleBuffer(&as, PROGRAM, strlen(PROGRAM), expected, MAX_WORDS);
+    printf("===== %d words, %d labels =====\n", nbrExpected, as.symbols.nbrLabels);
+    for (i = 0; i < nbrExpected && i < MAX_WORDS; i++)
+        printf("%08x\n", (unsigned int)expected[i]);
+    assemblerFree(&as);
+
+    for (i = 0; i < NBR_THREADS; i++)
+    {
+        different[i] = 0;
+        if (pthread_create(&threads[i], NULL, assembleRounds, &different[i]) != 0)
+        {
+            printError("Error: cannot start a thread.\n");
+            return 1;
+        }
+    }
+    for (i = 0; i < NBR_THREADS; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+        total += different[i];
+    }
+    printf("\n%d threads, %d assemblies each: %d different\n", NBR_THREADS, ROUNDS, total);
+
+    testErrors(1);
+    testErrors(0);
+
+    return 0;
+}
+
+static void *assembleRounds(void *arg)
+/* Assembles PROGRAM ROUNDS times, and counts in *arg the assemblies
+   * whose machine code or labels differ from the expected ones.
+   */
+{
+    int *different = arg;
+    uint32_t words[MAX_WORDS];
+    Assembler as;
+    int round;
+
+    assemblerInit(&as);
+    for (round = 0; round < ROUNDS; round++)
+    {
+        int n = assembleBuffer(&as, PROGRAM, strlen(PROGRAM), words, MAX_WORDS);
+
+        if (n != nbrExpected || memcmp(words, expected, n * sizeof(uint32_t)) != 0 ||
+            findLabel(&as.symbols, "loop") != 12 || findLabel(&as.symbols, "table") != DATA_BASE)
+            (*different)++;
+    }
+    assemblerFree(&as);
+    return NULL;
+}
+
+static void testErrors(int printErrors)
+/* Assembles a program with ERROR_LIMIT + 5 invalid instructions, with
+   * the messages collected (printErrors is 0) or printed (1), and
+   * prints what came back.
+   */
+{
+    char source[BUFSIZ];
+    int nbrBad = ERROR_LIMIT + 5;
+    int length = 0;
+    Assembler as;
+    int n, i;
+
+    for (i = 0; i < nbrBad; i++)
+        length += snprintf(source + length, sizeof(source) - length, "        frob $t%d\n", i % 8);
+
+    assemblerInit(&as);
+    as.printErrors = printErrors;
+    n = assembleBuffer(&as, source, length, NULL, 0);
+    printf("\n%s: returned %d, with %d errors and %d messages\n",
+           printErrors ? "printed" : "collected", n, as.nbrErrors, as.nbrDiagnostics);
+    if (as.nbrDiagnostics > 0)
+        printf("first: %s", as.diagnostics[0]);
+    assemblerFree(&as);
+}
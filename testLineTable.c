@@ -0,0 +1,93 @@
+/*
+ * Test Driver to test the lookups in a line table file written by the
+ * assembler (--emit=lines:path; see LineTable.h).
+ *
+ * The main method reads the line table file named on the command line
+ * and prints, for every word address from 0 to a little past the last
+ * one in the table, the source line that lineTableLookup finds for it,
+ * one run of addresses on the same line at a time ("no line" for the
+ * addresses that no instruction is at: a gap, or past the end).  It
+ * then looks up an address in the data segment, and looks addresses up
+ * in tables that are not valid: one cut short, one with the wrong first
+ * bytes, and one with no rows.  See TestCases.md.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include "assembler.h"
+#include "LineTable.h"
+
+const int SAME = 0; /* useful for making strcmp readable */
+                    /* e.g., if (strcmp (str1, str2) == SAME) */
+
+/* How far past the last address with a line to look. */
+#define PAST_END 16
+
+static void printRun(uint32_t first, uint32_t last, int line);
+
+int main(int argc, char *argv[])
+{
+    static char table[1 << 16]; /* the line table file */
+    LineTableHeader *header = (LineTableHeader *)table;
+    LineTableHeader empty;
+    size_t size;
+    uint32_t address, first = 0, end = 0;
+    int line, runLine;
+    FILE *fp;
+
+    if (argc != 2 || (fp = fopen(argv[1], "rb")) == NULL)
+    {
+        printError("Usage: %s file.lines\n", argv[0]);
+        return 1;
+    }
+    size = fread(table, 1, sizeof(table), fp);
+    fclose(fp);
+
+    printf("===== %u rows, %u checkpoints, every %u rows =====\n",
+           header->nbrRows, header->nbrCheckpoints, header->interval);
+
+    /* the last address that has a line */
+    for (address = 0; address < 0x10000; address += 4)
+        if (lineTableLookup(table, size, address) != -1)
+            end = address;
+
+    /* each run of addresses on the same line */
+    runLine = lineTableLookup(table, size, 0);
+    for (address = 4; address <= end + PAST_END; address += 4)
+    {
+        line = lineTableLookup(table, size, address);
+        if (line != runLine)
+        {
+            printRun(first, address - 4, runLine);
+            first = address;
+            runLine = line;
+        }
+    }
+    printRun(first, end + PAST_END, runLine);
+
+    printf("\n");
+    printf("data segment: %d\n", lineTableLookup(table, size, 0x10010000));
+    printf("table cut short: %d\n", lineTableLookup(table, size - 1, 0));
+    printf("table with no header: %d\n", lineTableLookup(table, sizeof(LineTableHeader) - 1, 0));
+    memcpy(table, "XXXX", 4);
+    printf("wrong first bytes: %d\n", lineTableLookup(table, size, 0));
+    memset(&empty, 0, sizeof(empty));
+    memcpy(empty.magic, LINE_TABLE_MAGIC, 4);
+    printf("no rows: %d\n", lineTableLookup(&empty, sizeof(empty), 0));
+
+    return 0;
+}
+
+static void printRun(uint32_t first, uint32_t last, int line)
+/* Prints the run of addresses from first to last, which are on line
+   * line (-1 for none).
+   */
+{
+    if (line == -1)
+        printf("%08x-%08x  no line\n", (unsigned int)first, (unsigned int)last + 3);
+    else
+        printf("%08x-%08x  line %d\n", (unsigned int)first, (unsigned int)last + 3, line);
+}
@@ -0,0 +1,145 @@
+/*
+ * This file defines the functions that support tracing (see trace.h):
+ *      trace_set:      turns tracing on for a list of categories
+ *      trace_write:    adds a message to the trace buffer
+ *      trace_flush:    writes the trace buffer to stderr
+ *
+ * The messages are collected in a buffer, rather than written one at a
+ * time, so that tracing every line of a large file does not slow the
+ * assembler down more than it has to.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+/* Define the global TRACE_LEVEL array; tracing is off by default. */
+unsigned char TRACE_LEVEL[TRACE_NBR_CATEGORIES] = {0};
+
+/* The category names, in the order of TraceCategory. */
+static const char * CATEGORY_NAMES[TRACE_NBR_CATEGORIES] =
+    { "lexer", "labels", "encoder", "optimizer" };
+
+/* The highest level of tracing. */
+static const long MAX_LEVEL = 3;
+
+/* Define the internal trace buffer. */
+#define TRACE_BUFSIZ 65536
+static char traceBuffer[TRACE_BUFSIZ];
+static size_t traceLength = 0;
+static int flushAtExit = 0;     /* has trace_flush been registered? */
+
+/**
+ * int trace_set(const char * list)
+ *
+ * Turns tracing on for the categories in list, which are separated by
+ * commas, each optionally followed by a colon and a level (1 if there
+ * is none).  The category "all" stands for every category.  If tracing
+ * is not compiled in, a valid list only prints a warning, since there
+ * would be nothing to see.
+ *
+ * Returns 1 if the list is valid; 0 otherwise.
+ */
+int trace_set(const char * list)
+{
+    while ( *list != '\0' )
+    {
+        const char * name = list;
+        size_t nameLength = strcspn(list, ":,");
+        long level = 1;
+        int found = 0;
+        int i;
+
+        list += nameLength;
+        if ( *list == ':' )
+        {
+            char * end;
+            level = strtol(list + 1, &end, 10);
+            if ( end == list + 1 || level < 0 || level > MAX_LEVEL )
+                return 0;
+            list = end;
+        }
+        if ( *list == ',' )
+            list++;
+        else if ( *list != '\0' )
+            return 0;
+
+        /* Turn tracing on for the category (or for all of them). */
+        for ( i = 0; i < TRACE_NBR_CATEGORIES; i++ )
+        {
+            if ( (nameLength == 3 && strncmp(name, "all", 3) == 0) ||
+                 (strlen(CATEGORY_NAMES[i]) == nameLength &&
+                  strncmp(name, CATEGORY_NAMES[i], nameLength) == 0) )
+            {
+                TRACE_LEVEL[i] = (unsigned char) level;
+                found = 1;
+            }
+        }
+        if ( ! found )
+            return 0;
+    }
+
+#ifndef ENABLE_TRACE
+    (void) fprintf(stderr, "Warning: tracing not compiled in; rebuild with make TRACE=1.\n");
+#endif
+    return 1;
+}
+
+/**
+ * void trace_write(TraceCategory category, const char * restrict_format, ...)
+ *
+ * Adds a message, preceded by the name of its category, to the trace
+ * buffer, first writing out the buffer if the message doesn't fit.
+ * A message that doesn't fit in an empty buffer is cut short.
+ *
+ * Parameters:
+ *  The category, followed by parameters modeled on those to printf.
+ */
+void trace_write(TraceCategory category, const char * restrict_format, ...)
+{
+    char message[BUFSIZ];
+    int length;
+    va_list ap;
+
+    /* Write out whatever is left in the buffer when the program exits
+     * (including when printError exits).
+     */
+    if ( ! flushAtExit )
+    {
+        flushAtExit = 1;
+        (void) atexit(trace_flush);
+    }
+
+    length = snprintf(message, sizeof(message), "[%s] ", CATEGORY_NAMES[category]);
+    va_start(ap, restrict_format);
+    length += vsnprintf(message + length, sizeof(message) - length, restrict_format, ap);
+    va_end(ap);
+    if ( length >= (int) sizeof(message) )
+        length = sizeof(message) - 1;
+
+    if ( traceLength + length > TRACE_BUFSIZ )
+        trace_flush();
+    memcpy(traceBuffer + traceLength, message, length);
+    traceLength += length;
+}
+
+/**
+ * void trace_flush(void)
+ *
+ * Writes the messages in the trace buffer to stderr, and empties it.
+ */
+void trace_flush(void)
+{
+    if ( traceLength > 0 )
+    {
+        (void) fwrite(traceBuffer, 1, traceLength, stderr);
+        traceLength = 0;
+    }
+    (void) fflush(stderr);
+}
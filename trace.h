@@ -0,0 +1,63 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+/*
+ * TRACE prints a tracing message for one part (category) of the
+ *      assembler, if tracing has been turned on for that category at the
+ *      given level or higher.  Its arguments are a category, a level,
+ *      and then a format and other arguments exactly like printf.  E.g.,
+ *          TRACE(TRACE_LEXER, 2, "first token is %s.\n", tokBegin);
+ *      Level 1 is for a few messages per file, level 2 for one per line
+ *      or instruction, and level 3 for anything more detailed.
+ *
+ *      Tracing is compiled in only if ENABLE_TRACE is defined (make
+ *      TRACE=1).  Otherwise TRACE compiles to nothing, so it costs
+ *      nothing in the loops that process every line.  When it is
+ *      compiled in, a TRACE whose category is off costs one comparison.
+ *
+ *      The messages go to stderr, through a buffer that is flushed when
+ *      it is full and when the program exits.  The buffer and the levels
+ *      are shared by all threads, so tracing is for the command line,
+ *      not for programs that assemble in several threads (see
+ *      libassembler.h).
+ *
+ * TRACE_LEVEL holds the level to which tracing is turned on for each
+ *      category (0 for off).
+ *
+ * trace_set turns tracing on from a list of categories with optional
+ *      levels, e.g., "lexer:2,labels" (level 1 if none is given) or
+ *      "all:3".  It returns 1 if the list is valid; 0 otherwise.
+ *
+ * trace_write prints a message (use TRACE rather than calling it).
+ *
+ * trace_flush writes out the messages in the buffer.
+ */
+
+typedef enum
+{
+    TRACE_LEXER,        /* reading and tokenizing lines (pass1) */
+    TRACE_LABELS,       /* defining and looking up labels */
+    TRACE_ENCODER,      /* translating instructions (pass2) */
+    TRACE_OPTIMIZER,    /* peephole optimizer and delay slot filling */
+    TRACE_NBR_CATEGORIES
+} TraceCategory;
+
+extern unsigned char TRACE_LEVEL[TRACE_NBR_CATEGORIES];
+
+int  trace_set(const char * list);
+void trace_write(TraceCategory category, const char * restrict_format, ...);
+void trace_flush(void);
+
+#ifdef ENABLE_TRACE
+#define TRACE(category, level, ...) \
+    do { if ( TRACE_LEVEL[category] >= (level) ) \
+             trace_write((category), __VA_ARGS__); } while (0)
+#else
+/* The arguments are still checked by the compiler, but no code is
+ * generated for them.
+ */
+#define TRACE(category, level, ...) \
+    do { if ( 0 ) trace_write((category), __VA_ARGS__); } while (0)
+#endif
+
+#endif
@@ -0,0 +1,567 @@
+/*
+ * This file contains the translation of the machine code of a program
+ * into C (--emit=c; see translate.h).  The words of the text segment
+ * are decoded one at a time, and each becomes a C statement in main,
+ * under a label if something jumps to it.  A branch or jump becomes a
+ * goto, with the statement for the instruction in its delay slot in
+ * front of it (the delay slot is also translated where it is, for the
+ * path that doesn't jump).  The data segment becomes an array of words
+ * that are stored into memory before the program starts.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <stdarg.h>
+
+#include "translate.h"
+
+/* The fields of an instruction. */
+#define OPCODE(w) ((w) >> 26)
+#define RS(w) (((w) >> 21) & 31)
+#define RT(w) (((w) >> 16) & 31)
+#define RD(w) (((w) >> 11) & 31)
+#define SHAMT(w) (((w) >> 6) & 31)
+#define FUNCT(w) ((w) & 63)
+#define UIMM(w) ((w) & 0xffff)
+#define SIMM(w) ((uint32_t)(int32_t)(int16_t)((w) & 0xffff))
+
+/* The opcodes and funct numbers of the instructions the assembler
+ * makes (see getOpType in pass2.c).
+ */
+enum {OP_R = 0, OP_J = 2, OP_JAL = 3, OP_BEQ = 4, OP_BNE = 5, OP_ADDI = 8,
+      OP_ADDIU = 9, OP_SLTI = 10, OP_SLTIU = 11, OP_ANDI = 12, OP_ORI = 13,
+      OP_LUI = 15, OP_LW = 35, OP_SW = 43};
+enum {FN_SLL = 0, FN_SRL = 2, FN_JR = 8, FN_ADD = 32, FN_ADDU = 33, FN_SUB = 34,
+      FN_SUBU = 35, FN_AND = 36, FN_OR = 37, FN_NOR = 39, FN_SLT = 42, FN_SLTU = 43};
+
+/* Why a text address needs a C label. */
+#define TARGET_DIRECT 1   /* a branch or jump goes there, or the program
+                             starts there */
+#define TARGET_INDIRECT 2 /* jr may go there (it is in the dispatch table) */
+
+/* The state of a translation. */
+typedef struct
+{
+    FILE *fp;
+    long bytes;             /* bytes written so far */
+    MachineCode *code;
+    int nbrText;            /* nbr of words in the text segment */
+    unsigned char *targets; /* the TARGET_ flags of each of them */
+    int hasJr;              /* is there a jr (and so a dispatch table)? */
+} Translation;
+
+/* internal global variables (global to this file only)*/
+static const char *ERROR0 = "Error: cannot allocate space in memory.\n";
+
+/* The C names of the registers (without the $ of their MIPS names). */
+static const char *REG_NAMES[32] =
+    {"zero", "at", "v0", "v1", "a0", "a1", "a2", "a3",
+     "t0", "t1", "t2", "t3", "t4", "t5", "t6", "t7",
+     "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7",
+     "t8", "t9", "k0", "k1", "gp", "sp", "fp", "ra"};
+
+/* The memory, and the functions that the statements call. */
+static const char *RUNTIME =
+    "#include <stdint.h>\n"
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "\n"
+    "/* The memory holds the addresses from MEMORY_BASE up: the data segment\n"
+    " * (at DATA_BASE) and the stack, which grows down from the end.  Build\n"
+    " * with -DMEMORY_SIZE=n for more.\n"
+    " */\n"
+    "#define MEMORY_BASE 0x10000000u\n"
+    "#define DATA_BASE 0x%08xu\n"
+    "#ifndef MEMORY_SIZE\n"
+    "#define MEMORY_SIZE 0x400000u\n"
+    "#endif\n"
+    "\n"
+    "static uint8_t memory[MEMORY_SIZE];\n"
+    "\n"
+    "static inline void fault(const char *what, uint32_t address)\n"
+    "{\n"
+    "    fprintf(stderr, \"%%s 0x%%08x\\n\", what, (unsigned int)address);\n"
+    "    exit(2);\n"
+    "}\n"
+    "\n"
+    "static inline uint32_t load(uint32_t address)\n"
+    "{\n"
+    "    uint32_t i = address - MEMORY_BASE;\n"
+    "\n"
+    "    if ((address & 3) != 0 || i > MEMORY_SIZE - 4)\n"
+    "        fault(\"bad address in load:\", address);\n"
+    "    return (uint32_t)memory[i] << 24 | (uint32_t)memory[i + 1] << 16 |\n"
+    "           (uint32_t)memory[i + 2] << 8 | memory[i + 3];\n"
+    "}\n"
+    "\n"
+    "static inline void store(uint32_t address, uint32_t value)\n"
+    "{\n"
+    "    uint32_t i = address - MEMORY_BASE;\n"
+    "\n"
+    "    if ((address & 3) != 0 || i > MEMORY_SIZE - 4)\n"
+    "        fault(\"bad address in store:\", address);\n"
+    "    memory[i] = (uint8_t)(value >> 24);\n"
+    "    memory[i + 1] = (uint8_t)(value >> 16);\n"
+    "    memory[i + 2] = (uint8_t)(value >> 8);\n"
+    "    memory[i + 3] = (uint8_t)value;\n"
+    "}\n"
+    "\n"
+    "static inline uint32_t add(uint32_t a, uint32_t b)\n"
+    "{\n"
+    "    uint32_t sum = a + b;\n"
+    "\n"
+    "    if (((a ^ sum) & (b ^ sum)) >> 31)\n"
+    "        fault(\"arithmetic overflow, adding to\", a);\n"
+    "    return sum;\n"
+    "}\n"
+    "\n"
+    "static inline uint32_t sub(uint32_t a, uint32_t b)\n"
+    "{\n"
+    "    uint32_t difference = a - b;\n"
+    "\n"
+    "    if (((a ^ b) & (a ^ difference)) >> 31)\n"
+    "        fault(\"arithmetic overflow, subtracting from\", a);\n"
+    "    return difference;\n"
+    "}\n"
+    "\n";
+
+/* internal functions (visible to this file only)*/
+static void out(Translation *t, const char *format, ...);
+static void markTargets(Translation *t, LabelTable *table);
+static void markTarget(Translation *t, uint32_t address, int flag);
+static int isJump(uint32_t word);
+static uint32_t jumpTarget(uint32_t word, uint32_t address);
+static void writeData(Translation *t);
+static void writeWord(Translation *t, int i);
+static void writeGoto(Translation *t, uint32_t target, const char *indent);
+static void writeDispatch(Translation *t);
+static void writeHalt(Translation *t);
+static void statement(uint32_t word, char *stmt, size_t size);
+static void disassemble(uint32_t word, uint32_t address, char *text, size_t size);
+static const char *reg(int r);
+
+long translateToC(FILE *fp, MachineCode *code, LabelTable *table, const char *fileName)
+/* Writes to fp a C program that runs the machine code in code (the
+   * text segment, then the data segment), whose labels are in table,
+   * and which was assembled from fileName (NULL for the standard
+   * input).
+   * Returns the nbr of bytes written.
+   */
+{
+    Translation t;
+    int entry = findLabel(table, ENTRY_LABEL);
+    int i, r;
+
+    t.fp = fp;
+    t.bytes = 0;
+    t.code = code;
+    t.nbrText = code->textWords;
+    t.hasJr = 0;
+    if ((t.targets = memCalloc(MEM_OUTPUT, t.nbrText + 1, 1)) == NULL)
+    {
+        printError("%s", ERROR0);
+        return 0;
+    }
+
+    /* execution starts at main, if it is in the text segment */
+    if (entry < 0 || entry >= 4 * t.nbrText)
+        entry = 0;
+    markTargets(&t, table);
+    markTarget(&t, (uint32_t)entry, TARGET_DIRECT);
+
+    out(&t, "/*\n * %s, translated into C by the assembler (--emit=c).\n */\n\n",
+        fileName != NULL ? fileName : "The standard input");
+    out(&t, RUNTIME, (unsigned int)DATA_BASE);
+    writeData(&t);
+
+    /* The registers, set as when the program starts */
+    out(&t, "int main(void)\n{\n");
+    for (r = 1; r < 32; r++)
+        out(&t, "%s%s = 0%s", r % 8 == 1 ? "    uint32_t " : "", REG_NAMES[r],
+            r % 8 == 0 || r == 31 ? ";\n" : ", ");
+    if (t.hasJr)
+        out(&t, "    uint32_t pc; /* where jr goes */\n");
+    if (code->nbrWords > t.nbrText)
+        out(&t, "    size_t i;\n");
+    out(&t, "\n    gp = 0x10008000u;\n"
+            "    sp = MEMORY_BASE + MEMORY_SIZE;\n"
+            "    ra = 0x%08xu; /* the end of the text segment */\n", (unsigned int)(4 * t.nbrText));
+    if (code->nbrWords > t.nbrText)
+        out(&t, "    for (i = 0; i < sizeof(data) / sizeof(data[0]); i++)\n"
+                "        store(DATA_BASE + 4 * (uint32_t)i, data[i]);\n");
+    writeGoto(&t, (uint32_t)entry, "    ");
+    out(&t, "\n");
+
+    /* The text segment, and the end of it */
+    for (i = 0; i < t.nbrText; i++)
+        writeWord(&t, i);
+    out(&t, "    goto halt;\n\n");
+
+    if (t.hasJr)
+        writeDispatch(&t);
+    writeHalt(&t);
+
+    memFree(t.targets);
+    return t.bytes;
+}
+
+static void out(Translation *t, const char *format, ...)
+/* Postcondition: format, with the arguments after it (as for printf),
+   *      has been written to the output of t, and counted.
+   */
+{
+    va_list args;
+    int n;
+
+    va_start(args, format);
+    n = vfprintf(t->fp, format, args);
+    va_end(args);
+    if (n > 0)
+        t->bytes += n;
+}
+
+static void markTargets(Translation *t, LabelTable *table)
+/* Postcondition: each word of the text segment that a branch or jump
+   *      goes to, or (if there is a jr) that a register may hold the
+   *      address of, has its TARGET_ flags set.
+   */
+{
+    uint32_t *words = t->code->words;
+    int i;
+
+    for (i = 0; i < t->nbrText; i++)
+    {
+        if (OPCODE(words[i]) == OP_R && FUNCT(words[i]) == FN_JR)
+            t->hasJr = 1;
+        else if (isJump(words[i]))
+            markTarget(t, jumpTarget(words[i], 4 * i), TARGET_DIRECT);
+    }
+    if (!t->hasJr)
+        return;
+
+    /* jr returns after a jal, or goes to an address that la loaded */
+    for (i = 0; i < t->nbrText; i++)
+    {
+        if (OPCODE(words[i]) == OP_JAL)
+            markTarget(t, 4 * i + 8, TARGET_INDIRECT);
+    }
+    for (i = 0; i < table->nbrLabels; i++)
+    {
+        if (table->entries[i].address >= 0)
+            markTarget(t, (uint32_t)table->entries[i].address, TARGET_INDIRECT);
+    }
+}
+
+static void markTarget(Translation *t, uint32_t address, int flag)
+/* Postcondition: the word at address, if it is in the text segment
+   *      (or is its end), has flag set.
+   */
+{
+    if (address % 4 == 0 && address / 4 <= (uint32_t)t->nbrText)
+        t->targets[address / 4] |= flag;
+}
+
+static int isJump(uint32_t word)
+/* Returns 1 if word is a branch or jump (which has a delay slot); 0
+   *      otherwise.
+   */
+{
+    switch (OPCODE(word))
+    {
+    case OP_J:
+    case OP_JAL:
+    case OP_BEQ:
+    case OP_BNE:
+        return 1;
+    case OP_R:
+        return FUNCT(word) == FN_JR;
+    default:
+        return 0;
+    }
+}
+
+static uint32_t jumpTarget(uint32_t word, uint32_t address)
+/* Returns the address that the branch or jump word, at address, goes
+   *      to (it must not be a jr).
+   */
+{
+    if (OPCODE(word) == OP_J || OPCODE(word) == OP_JAL)
+        return ((address + 4) & 0xf0000000u) | (word & 0x03ffffffu) << 2;
+
+    return address + 4 + (SIMM(word) << 2);
+}
+
+static void writeData(Translation *t)
+/* Postcondition: the words of the data segment, if there are any, have
+   *      been written as the array data.
+   */
+{
+    int n = t->code->nbrWords - t->nbrText;
+    int i;
+
+    if (n <= 0)
+        return;
+
+    out(t, "#if MEMORY_SIZE < DATA_BASE - MEMORY_BASE + %du\n"
+           "#error \"MEMORY_SIZE is too small for the data segment\"\n"
+           "#endif\n\n", 4 * n);
+    out(t, "/* The data segment */\nstatic const uint32_t data[%d] = {", n);
+    for (i = 0; i < n; i++)
+        out(t, "%s0x%08xu%s", i % 6 == 0 ? "\n    " : " ",
+            (unsigned int)t->code->words[t->nbrText + i], i < n - 1 ? "," : "\n");
+    out(t, "};\n\n");
+}
+
+static void writeWord(Translation *t, int i)
+/* Postcondition: the statement for the word i of the text segment
+   *      (and, if it is a branch or jump, for its delay slot) has been
+   *      written, with a label if something jumps to it.
+   */
+{
+    uint32_t word = t->code->words[i];
+    uint32_t address = 4 * (uint32_t)i;
+    char text[64], stmt[128], delay[128];
+
+    if (t->targets[i])
+        out(t, "L_%08x:\n", (unsigned int)address);
+    disassemble(word, address, text, sizeof(text));
+    if (t->code->lineNums[i] > 0)
+        out(t, "    /* %08x  %-30s line %d */\n", (unsigned int)address, text, t->code->lineNums[i]);
+    else
+        out(t, "    /* %08x  %s */\n", (unsigned int)address, text);
+
+    if (!isJump(word))
+    {
+        statement(word, stmt, sizeof(stmt));
+        if (stmt[0] != '\0')
+            out(t, "    %s\n", stmt);
+        return;
+    }
+
+    /* The delay slot runs before the jump (a jump in it doesn't run) */
+    delay[0] = '\0';
+    if (i + 1 < t->nbrText && !isJump(t->code->words[i + 1]))
+        statement(t->code->words[i + 1], delay, sizeof(delay));
+
+    switch (OPCODE(word))
+    {
+    case OP_BEQ:
+    case OP_BNE:
+        out(t, "    if (%s %s %s)\n    {\n", reg(RS(word)), OPCODE(word) == OP_BEQ ? "==" : "!=",
+            reg(RT(word)));
+        if (delay[0] != '\0')
+            out(t, "        %s\n", delay);
+        writeGoto(t, jumpTarget(word, address), "        ");
+        out(t, "    }\n");
+        break;
+
+    case OP_JAL:
+        out(t, "    ra = 0x%08xu;\n", (unsigned int)(address + 8));
+        /* fall through */
+    case OP_J:
+        if (delay[0] != '\0')
+            out(t, "    %s\n", delay);
+        writeGoto(t, jumpTarget(word, address), "    ");
+        break;
+
+    default: /* jr */
+        out(t, "    pc = %s;\n", reg(RS(word)));
+        if (delay[0] != '\0')
+            out(t, "    %s\n", delay);
+        out(t, "    goto dispatch;\n");
+    }
+}
+
+static void writeGoto(Translation *t, uint32_t target, const char *indent)
+/* Postcondition: the statement that goes to target, indented by
+   *      indent, has been written.
+   */
+{
+    if (target == 4 * (uint32_t)t->nbrText)
+        out(t, "%sgoto halt;\n", indent);
+    else if (target % 4 == 0 && target / 4 < (uint32_t)t->nbrText)
+        out(t, "%sgoto L_%08x;\n", indent, (unsigned int)target);
+    else
+        out(t, "%sfault(\"jump to\", 0x%08xu);\n", indent, (unsigned int)target);
+}
+
+static void writeDispatch(Translation *t)
+/* Postcondition: the switch that jr goes through has been written. */
+{
+    int i;
+
+    out(t, "dispatch:\n    switch (pc)\n    {\n");
+    for (i = 0; i < t->nbrText; i++)
+    {
+        if (t->targets[i] & TARGET_INDIRECT)
+            out(t, "    case 0x%08xu: goto L_%08x;\n", (unsigned int)(4 * i), (unsigned int)(4 * i));
+    }
+    out(t, "    case 0x%08xu: goto halt;\n"
+           "    default: fault(\"jump to\", pc);\n"
+           "    }\n\n", (unsigned int)(4 * t->nbrText));
+}
+
+static void writeHalt(Translation *t)
+/* Postcondition: the end of main, which prints the registers that are
+   *      not 0, has been written.
+   */
+{
+    int r;
+
+    out(t, "halt:\n");
+    for (r = 1; r < 32; r++)
+        out(t, "    if (%s != 0)\n"
+               "        printf(\"$%s = 0x%%08x\\n\", (unsigned int)%s);\n",
+            REG_NAMES[r], REG_NAMES[r], REG_NAMES[r]);
+    out(t, "    return 0;\n}\n");
+}
+
+static void statement(uint32_t word, char *stmt, size_t size)
+/* Postcondition: stmt (which has room for size characters) holds the
+   *      C statement for word, which is not a branch or jump; it is ""
+   *      if word does nothing (e.g., nop).
+   */
+{
+    const char *rs = reg(RS(word)), *rt = reg(RT(word));
+    int dest = OPCODE(word) == OP_R ? RD(word) : RT(word);
+    unsigned int simm = (unsigned int)SIMM(word), uimm = (unsigned int)UIMM(word);
+    char value[96]; /* the value written to dest */
+    int checked = 0; /* can working it out stop the program? */
+
+    value[0] = stmt[0] = '\0';
+    if (OPCODE(word) == OP_R)
+    {
+        switch (FUNCT(word))
+        {
+        case FN_SLL:
+            snprintf(value, sizeof(value), "%s << %u", rt, SHAMT(word));
+            break;
+        case FN_SRL:
+            snprintf(value, sizeof(value), "%s >> %u", rt, SHAMT(word));
+            break;
+        case FN_ADD:
+        case FN_SUB:
+            snprintf(value, sizeof(value), "%s(%s, %s)", FUNCT(word) == FN_ADD ? "add" : "sub", rs, rt);
+            checked = 1;
+            break;
+        case FN_ADDU:
+            snprintf(value, sizeof(value), "%s + %s", rs, rt);
+            break;
+        case FN_SUBU:
+            snprintf(value, sizeof(value), "%s - %s", rs, rt);
+            break;
+        case FN_AND:
+            snprintf(value, sizeof(value), "%s & %s", rs, rt);
+            break;
+        case FN_OR:
+            snprintf(value, sizeof(value), "%s | %s", rs, rt);
+            break;
+        case FN_NOR:
+            snprintf(value, sizeof(value), "~(%s | %s)", rs, rt);
+            break;
+        case FN_SLT:
+            /* compare as signed by flipping the sign bits */
+            snprintf(value, sizeof(value), "(%s ^ 0x80000000u) < (%s ^ 0x80000000u)", rs, rt);
+            break;
+        case FN_SLTU:
+            snprintf(value, sizeof(value), "%s < %s", rs, rt);
+            break;
+        }
+    }
+    else
+    {
+        switch (OPCODE(word))
+        {
+        case OP_ADDI:
+            snprintf(value, sizeof(value), "add(%s, 0x%08xu)", rs, simm);
+            checked = 1;
+            break;
+        case OP_ADDIU:
+            snprintf(value, sizeof(value), "%s + 0x%08xu", rs, simm);
+            break;
+        case OP_SLTI:
+            snprintf(value, sizeof(value), "(%s ^ 0x80000000u) < 0x%08xu", rs, simm ^ 0x80000000u);
+            break;
+        case OP_SLTIU:
+            snprintf(value, sizeof(value), "%s < 0x%08xu", rs, simm);
+            break;
+        case OP_ANDI:
+            snprintf(value, sizeof(value), "%s & 0x%04xu", rs, uimm);
+            break;
+        case OP_ORI:
+            snprintf(value, sizeof(value), "%s | 0x%04xu", rs, uimm);
+            break;
+        case OP_LUI:
+            snprintf(value, sizeof(value), "0x%04x0000u", uimm);
+            break;
+        case OP_LW:
+            snprintf(value, sizeof(value), "load(%s + 0x%08xu)", rs, simm);
+            checked = 1;
+            break;
+        case OP_SW:
+            snprintf(stmt, size, "store(%s + 0x%08xu, %s);", rs, simm, rt);
+            return;
+        }
+    }
+
+    /* $zero is never written, but an overflow or a bad address still
+     * stops the program
+     */
+    if (value[0] == '\0')
+        snprintf(stmt, size, "fault(\"unknown instruction\", 0x%08xu);", (unsigned int)word);
+    else if (dest != 0)
+        snprintf(stmt, size, "%s = %s;", REG_NAMES[dest], value);
+    else if (checked)
+        snprintf(stmt, size, "(void)%s;", value);
+}
+
+static void disassemble(uint32_t word, uint32_t address, char *text, size_t size)
+/* Postcondition: text (which has room for size characters) holds word,
+   *      which is at address, in assembly language.
+   */
+{
+    static const char *R_NAMES[64] =
+        {[FN_SLL] = "sll", [FN_SRL] = "srl", [FN_JR] = "jr", [FN_ADD] = "add",
+         [FN_ADDU] = "addu", [FN_SUB] = "sub", [FN_SUBU] = "subu", [FN_AND] = "and",
+         [FN_OR] = "or", [FN_NOR] = "nor", [FN_SLT] = "slt", [FN_SLTU] = "sltu"};
+    static const char *I_NAMES[64] =
+        {[OP_J] = "j", [OP_JAL] = "jal", [OP_BEQ] = "beq", [OP_BNE] = "bne",
+         [OP_ADDI] = "addi", [OP_ADDIU] = "addiu", [OP_SLTI] = "slti",
+         [OP_SLTIU] = "sltiu", [OP_ANDI] = "andi", [OP_ORI] = "ori", [OP_LUI] = "lui",
+         [OP_LW] = "lw", [OP_SW] = "sw"};
+    const char *rs = REG_NAMES[RS(word)], *rt = REG_NAMES[RT(word)], *rd = REG_NAMES[RD(word)];
+    const char *name = OPCODE(word) == OP_R ? R_NAMES[FUNCT(word)] : I_NAMES[OPCODE(word)];
+
+    if (word == 0)
+        snprintf(text, size, "nop");
+    else if (name == NULL)
+        snprintf(text, size, ".word 0x%08x", (unsigned int)word);
+    else if (OPCODE(word) == OP_R && FUNCT(word) == FN_JR)
+        snprintf(text, size, "jr $%s", rs);
+    else if (OPCODE(word) == OP_R && (FUNCT(word) == FN_SLL || FUNCT(word) == FN_SRL))
+        snprintf(text, size, "%s $%s, $%s, %u", name, rd, rt, SHAMT(word));
+    else if (OPCODE(word) == OP_R)
+        snprintf(text, size, "%s $%s, $%s, $%s", name, rd, rs, rt);
+    else if (OPCODE(word) == OP_J || OPCODE(word) == OP_JAL)
+        snprintf(text, size, "%s 0x%08x", name, (unsigned int)jumpTarget(word, address));
+    else if (OPCODE(word) == OP_BEQ || OPCODE(word) == OP_BNE)
+        snprintf(text, size, "%s $%s, $%s, 0x%08x", name, rs, rt,
+                 (unsigned int)jumpTarget(word, address));
+    else if (OPCODE(word) == OP_LW || OPCODE(word) == OP_SW)
+        snprintf(text, size, "%s $%s, %d($%s)", name, rt, (int)(int16_t)UIMM(word), rs);
+    else if (OPCODE(word) == OP_LUI)
+        snprintf(text, size, "lui $%s, 0x%04x", rt, (unsigned int)UIMM(word));
+    else if (OPCODE(word) == OP_ANDI || OPCODE(word) == OP_ORI)
+        snprintf(text, size, "%s $%s, $%s, 0x%04x", name, rt, rs, (unsigned int)UIMM(word));
+    else
+        snprintf(text, size, "%s $%s, $%s, %d", name, rt, rs, (int)(int16_t)UIMM(word));
+}
+
+static const char *reg(int r)
+/* Returns the C expression for the value of register r. */
+{
+    return r == 0 ? "0u" : REG_NAMES[r];
+}
@@ -0,0 +1,47 @@
+/*
+ * Translate: the machine code of a program as C (--emit=c)
+ *
+ * This file provides the declarations for translating the machine code
+ * of a program into a C program that does what it does, so that it can
+ * be compiled by the host's C compiler and run at native speed rather
+ * than simulated.  The translation is made from the words of machine
+ * code (after the optimizer, delay slots, and relaxation), so it runs
+ * exactly what the assembler produced:
+ *      - the registers are local variables of main ($zero is the
+ *        constant 0), and the program starts at main (or the first
+ *        instruction) with $sp at the top of memory and $ra at the end
+ *        of the text segment;
+ *      - each address that a branch or jump goes to is a C label, and
+ *        the instruction in a delay slot is run before the jump;
+ *      - jr jumps through a dispatch table (a switch) of the addresses
+ *        a register can hold: the return addresses of the jal
+ *        instructions and the labels of the text segment;
+ *      - the memory is a byte array, in big-endian byte order, that
+ *        holds the data segment and the stack (see MEMORY_SIZE in the
+ *        C file);
+ *      - add, addi, and sub stop the program on an overflow, and so do
+ *        a load or store of a bad address and a jump to an address that
+ *        is not an instruction.
+ * The program halts when it jumps (or falls through) to the end of the
+ * text segment, and prints the registers that are not 0.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef TRANSLATE_H
+#define TRANSLATE_H
+
+#include "assembler.h"
+
+long translateToC(FILE *fp, MachineCode *code, LabelTable *table, const char *fileName);
+/* Writes to fp a C program that runs the machine code in code (the
+		 * text segment, then the data segment), whose labels are in
+		 * table, and which was assembled from fileName (NULL for the
+		 * standard input).
+		 * Returns the nbr of bytes written.
+		 */
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * This file contains unreachable-code elimination, an optional pass
+ * (--unreachable=report or --unreachable=strip) that builds the
+ * control-flow graph of the decoded program (see CFG.h) and finds the
+ * basic blocks that can't run: the ones that no path from the entry
+ * (main, or the first instruction), or from a label whose address is
+ * taken, leads to.  Each run of them is reported on stderr, e.g.,
+ *
+ *          Unreachable code on lines 12-30 (15 instructions).
+ *
+ * and, with strip, deleted, along with the labels in it (nothing that
+ * runs refers to them), so the code after it moves up.  A .align in
+ * deleted code is kept, so the code after it stays aligned.  Code that
+ * is only reached through a computed jump to an address that is not
+ * a label can't be told apart from dead code, so strip is not the
+ * default.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include "assembler.h"
+#include "optimize.h"
+
+/* internal functions (visible to this file only)*/
+static void report(int firstLine, int lastLine, int nbrInstrs);
+
+int removeUnreachable(Program *prog, LabelTable *table, int strip)
+/* Reports the code that can't run and, if strip is 1, deletes it and
+   * lays the program out again.
+   * Returns the number of instructions that can't run.
+   */
+{
+    CFG cfg;
+    int dead = 0;                   /* instructions that can't run */
+    int runFirst = 0, runLast = 0;  /* lines of the current run of them */
+    int runInstrs = 0;              /* nbr of instructions in the run */
+    int b, i;
+
+    if (!buildCFG(&cfg, prog, table))
+        return 0; /* error message already printed */
+    if (markReachable(&cfg, prog, table) <= 0)
+    {
+        cfgFree(&cfg);
+        return 0; /* nothing to remove, or error message already printed */
+    }
+
+    for (b = 0; b < cfg.nbrBlocks; b++)
+    {
+        BasicBlock *block = &cfg.blocks[b];
+        int blockInstrs = 0;
+
+        /* a block that can run ends the run of blocks that can't */
+        if (block->reachable)
+        {
+            if (runInstrs > 0)
+                report(runFirst, runLast, runInstrs);
+            runInstrs = 0;
+            continue;
+        }
+
+        for (i = block->first; i <= block->last; i++)
+        {
+            Instruction *instr = &prog->instrs[i];
+
+            if (instr->name == NULL)
+                continue;
+            if (runInstrs++ == 0)
+                runFirst = instr->lineNum;
+            runLast = instr->lineNum;
+            blockInstrs++;
+        }
+        dead += blockInstrs;
+
+        /* A block of labels alone is left, since the labels at the end
+         * of the program mark no instruction, so jumps to them make no
+         * edges.
+         */
+        if (strip && blockInstrs > 0)
+        {
+            for (i = block->first; i <= block->last; i++)
+            {
+                memFree(prog->instrs[i].label);
+                prog->instrs[i].label = NULL;
+                deleteInstruction(prog, i);
+            }
+        }
+    }
+    if (runInstrs > 0)
+        report(runFirst, runLast, runInstrs);
+    cfgFree(&cfg);
+
+    TRACE(TRACE_OPTIMIZER, 1, "unreachable code: %d instructions%s.\n",
+          dead, strip ? " removed" : "");
+    if (strip && dead > 0)
+        (void)layoutProgram(prog, table); /* error message already printed */
+    return dead;
+}
+
+static void report(int firstLine, int lastLine, int nbrInstrs)
+/* Reports a run of nbrInstrs instructions that can't run, from
+   * firstLine to lastLine, on stderr (after the name of the file, as
+   * in error messages).
+   */
+{
+    if (ERROR_PREFIX != NULL)
+        (void)fprintf(stderr, "%s: ", ERROR_PREFIX);
+    if (firstLine == lastLine)
+        (void)fprintf(stderr, "Unreachable code on %s (%d instruction%s).\n",
+                      lineName(firstLine), nbrInstrs, nbrInstrs == 1 ? "" : "s");
+    else if (mainLine(firstLine) == firstLine && mainLine(lastLine) == lastLine)
+        (void)fprintf(stderr, "Unreachable code on lines %d-%d (%d instructions).\n",
+                      firstLine, lastLine, nbrInstrs);
+    else
+        (void)fprintf(stderr, "Unreachable code from %s to %s (%d instructions).\n",
+                      lineName(firstLine), lineName(lastLine), nbrInstrs);
+}
@@ -0,0 +1,191 @@
+/*
+ * This file contains watch mode (--watch), in which the assembler
+ * assembles its input files again as soon as one of them, or a file
+ * they include, is saved.  It uses inotify, so it waits without using
+ * any CPU time between saves.
+ *
+ * The directories of the files are watched rather than the files
+ * themselves, since many editors save a file by writing a new one and
+ * renaming it over the old one, which would end a watch on the old
+ * file.  Only events for the watched names cause a rebuild (so writing
+ * the output into the same directory does not), and the events that
+ * come in a burst (e.g., create, write, rename) cause only one.  The
+ * included files are kept in memory between rebuilds and only read
+ * again if they have changed (see the include cache in Source.c).
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:  10/19/2026
+ *
+ */
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "assembler.h"
+#include "watch.h"
+
+/* The most files that can be watched. */
+#define MAX_WATCHED 256
+
+/* How long to wait for the rest of a burst of events, in milliseconds. */
+#define SETTLE_TIME 50
+
+/* The events that mean a file may have new contents. */
+#define EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE)
+
+/* The struct WatchedFile records the directory watch (wd) through which
+ * the changes to a file are seen, and the name of the file within it.
+ */
+typedef struct
+{
+    int wd;     /* watch descriptor of the directory */
+    char *name; /* the name of the file in the directory */
+} WatchedFile;
+
+/* internal global variables (global to this file only)*/
+static WatchedFile watched[MAX_WATCHED];
+static int nbrWatched = 0;
+
+/* internal functions (visible to this file only)*/
+static void watchAll(int fd, int nbrFiles);
+static void watchFile(int fd, const char *path);
+static int readEvents(int fd);
+static void buildAll(int nbrFiles, int (*build)(int index));
+
+int watchFiles(int nbrFiles, int (*build)(int index))
+/* Calls build for each input file, then again for all of them whenever
+   * one of them or a file they include is written.
+   * Returns 0 if the files can't be watched; otherwise does not return.
+   */
+{
+    int fd = inotify_init1(IN_CLOEXEC);
+
+    if (fd < 0)
+    {
+        printError("Error: cannot watch the input files.\n");
+        return 0;
+    }
+
+    buildAll(nbrFiles, build);
+    for (;;)
+    {
+        struct pollfd pfd;
+
+        /* the files included may be different after each build */
+        watchAll(fd, nbrFiles);
+
+        /* Wait for a change, then for the burst of events to end. */
+        if (!readEvents(fd))
+            continue;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        while (poll(&pfd, 1, SETTLE_TIME) > 0)
+            (void)readEvents(fd);
+
+        buildAll(nbrFiles, build);
+    }
+}
+
+static void watchAll(int fd, int nbrFiles)
+/* Postcondition: the input files and every file in the include cache
+   *      are being watched.
+   */
+{
+    char *path;
+    int i;
+
+    for (i = 0; i < nbrWatched; i++)
+        memFree(watched[i].name);
+    nbrWatched = 0;
+
+    for (i = 0; i < nbrFiles; i++)
+        watchFile(fd, OPTIONS.fileNames[i]);
+    for (i = 0; (path = includedFile(i)) != NULL; i++)
+        watchFile(fd, path);
+}
+
+static void watchFile(int fd, const char *path)
+/* Postcondition: the directory of the file at path is being watched
+   *      (if it wasn't already), and the file is in the watched list.
+   */
+{
+    const char *slash = strrchr(path, '/');
+    char *dir;
+    int wd;
+
+    if (nbrWatched == MAX_WATCHED)
+        return;
+
+    /* the directory is the part of the path up to the last '/' */
+    if (slash == NULL)
+        dir = memStrdup(MEM_OTHER, ".");
+    else if (slash == path)
+        dir = memStrdup(MEM_OTHER, "/");
+    else if ((dir = memAlloc(MEM_OTHER, slash - path + 1)) != NULL)
+        sprintf(dir, "%.*s", (int)(slash - path), path);
+    if (dir == NULL)
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return;
+    }
+
+    /* Adding a watch on a directory that is already watched returns
+     * the same watch descriptor.
+     */
+    wd = inotify_add_watch(fd, dir, EVENTS);
+    memFree(dir);
+    if (wd < 0)
+    {
+        printError("Error: cannot watch %s.\n", path);
+        return;
+    }
+
+    if ((watched[nbrWatched].name = memStrdup(MEM_OTHER, slash == NULL ? path : slash + 1)) == NULL)
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return;
+    }
+    watched[nbrWatched].wd = wd;
+    nbrWatched++;
+}
+
+static int readEvents(int fd)
+/* Reads the events waiting on fd (waiting for one if there are none).
+   * Returns 1 if any of them is for a watched file; 0 otherwise.
+   */
+{
+    union
+    {
+        struct inotify_event event; /* for the alignment */
+        char bytes[4096];
+    } buffer;
+    ssize_t length = read(fd, buffer.bytes, sizeof(buffer.bytes));
+    ssize_t offset;
+    int changed = 0;
+
+    for (offset = 0; offset < length;)
+    {
+        struct inotify_event *event = (struct inotify_event *)(buffer.bytes + offset);
+        int i;
+
+        for (i = 0; i < nbrWatched && event->len > 0; i++)
+        {
+            if (watched[i].wd == event->wd && strcmp(watched[i].name, event->name) == SAME)
+                changed = 1;
+        }
+        offset += sizeof(struct inotify_event) + event->len;
+    }
+
+    return changed;
+}
+
+static void buildAll(int nbrFiles, int (*build)(int index))
+/* Calls build for each input file. */
+{
+    int i;
+
+    for (i = 0; i < nbrFiles; i++)
+        (void)build(i);
+}
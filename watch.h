@@ -0,0 +1,26 @@
+/*
+ * Watch mode (--watch)
+ *
+ * This file provides the declaration for watch mode, in which the
+ * assembler keeps running and assembles its input files again each
+ * time one of them, or a file they include, is saved.
+ *
+ * Author: Maria Katrantzi
+ *
+ * Creation Date:	10/19/2026
+ *
+*/
+
+#ifndef WATCH_H
+#define WATCH_H
+
+int watchFiles(int nbrFiles, int (*build)(int index));
+/* Calls build for each of the nbrFiles input files (OPTIONS.fileNames),
+		 * then again for all of them whenever one of them or a file
+		 * they include (see includedFile) is written, created, or
+		 * replaced.  Does not return unless the files can't be
+		 * watched.
+		 * Returns 0 if the files can't be watched.
+		 */
+
+#endif